@@ -87,9 +87,8 @@ bool MiniView::view_button_cb(mdc::CanvasView *view, mdc::MouseButton btn, bool
         if (nrect.bottom() > bounds.bottom())
           nrect.pos.y = bounds.bottom() - nrect.height();
 
-        _viewport_figure->set_bounds(nrect);
+        _viewport_figure->set_bounds(nrect); // Calls viewport_dragged() via the bounds changed signal.
         _viewport_figure->set_needs_render();
-        viewport_dragged(rect);
       }
     }
   }
@@ -285,8 +284,10 @@ void MiniView::viewport_dragged(const Rect &orect) {
       nrect.pos.y = bounds.bottom() - nrect.height();
 
     if (nrect != rect) {
+      _skip_viewport_update = true;
       _viewport_figure->set_bounds(nrect);
       _viewport_figure->set_needs_render();
+      _skip_viewport_update = false;
     }
 
     if (_canvas_view) {
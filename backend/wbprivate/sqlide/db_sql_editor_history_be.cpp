@@ -21,7 +21,6 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
  */
 
-#include <fstream>
 #include <glib/gstdio.h>
 #include <stdlib.h>
 
@@ -30,13 +29,9 @@
 #include "db_sql_editor_history_be.h"
 #include "sqlide/recordset_data_storage.h"
 
-#include "base/threading.h"
 #include "base/string_utilities.h"
-#include "base/util_functions.h"
 #include "base/log.h"
 #include "base/file_utilities.h"
-#include "base/scope_exit_trigger.h"
-#include "base/xml_functions.h"
 
 #include "mforms/utilities.h"
 
@@ -47,11 +42,25 @@ using namespace grt;
 using namespace base;
 
 const char *SQL_HISTORY_DIR_NAME = "sql_history";
+static const char *SQL_HISTORY_STORE_NAME = "history.db";
+
+// Number of statements fetched from the store at once by the details model.
+static const std::size_t HISTORY_PAGE_SIZE = 200;
 
 DbSqlEditorHistory::DbSqlEditorHistory() : _current_entry_index(-1) {
+  std::string sql_history_dir = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
+  g_mkdir_with_parents(sql_history_dir.c_str(), 0700);
+  try {
+    _store.reset(new SqlHistoryStore(base::makePath(sql_history_dir, SQL_HISTORY_STORE_NAME)));
+    _store->import_legacy_files(sql_history_dir);
+  } catch (const std::exception &exc) {
+    // Keep a history for this session at least.
+    grt::GRT::get()->send_error(_("Can't open SQL history store"), exc.what());
+    _store.reset(new SqlHistoryStore(":memory:"));
+  }
+
   _entries_model = EntriesModel::create(this);
-  _details_model = DetailsModel::create();
-  _write_only_details_model = DetailsModel::create();
+  _details_model = DetailsModel::create(_store);
   load();
 }
 
@@ -68,24 +77,43 @@ void DbSqlEditorHistory::load() {
   _entries_model->load();
 }
 
-void DbSqlEditorHistory::add_entry(const std::list<std::string> &statements) {
-  size_t old_date_count = _details_model->count();
-  _entries_model->add_statements(statements);
+std::int64_t DbSqlEditorHistory::add_entry(const std::list<std::string> &statements, const std::string &schema) {
+  if (statements.empty())
+    return -1;
 
-  if (_entries_model->get_ui_usage()) {
+  std::tm timestamp = local_timestamp();
+  std::int64_t id = _store->append(timestamp, schema, statements);
+
+  // A search result stays as it is, new statements show up once the filter is cleared.
+  if (!_filter.empty())
+    return id;
+
+  if (_entries_model->insert_entry(format_time(timestamp, "%Y-%m-%d"))) {
+    // The new day goes to the top and moves the selected one down.
+    if (_current_entry_index >= 0)
+      ++_current_entry_index;
+    _entries_model->set_ui_usage(_current_entry_index == 0);
     _entries_model->refresh_ui();
-    if (old_date_count < _details_model->count())
+  } else if (_current_entry_index == 0) {
+    _details_model->entries_added(statements.size());
+    if (_entries_model->get_ui_usage())
       _details_model->refresh_ui();
   }
+
+  return id;
+}
+
+void DbSqlEditorHistory::set_entry_duration(std::int64_t id, double duration) {
+  _store->set_duration(id, duration);
+  if (_current_entry_index == 0)
+    _details_model->invalidate();
 }
 
 void DbSqlEditorHistory::current_entry(int index) {
   if (index < 0)
     _details_model->reset();
-  else {
-    update_timestamp(_entries_model->entry_date(index));
-    _details_model->load(_entries_model->entry_path(index));
-  }
+  else
+    _details_model->load(_entries_model->entry_day(index), _filter);
 
   _current_entry_index = index;
 
@@ -96,6 +124,16 @@ void DbSqlEditorHistory::current_entry(int index) {
   _details_model->refresh();
 }
 
+void DbSqlEditorHistory::set_filter(const std::string &filter) {
+  std::string value = base::trim(filter);
+  if (value == _filter)
+    return;
+
+  _filter = value;
+  _entries_model->load();
+  current_entry(_entries_model->row_count() > 0 ? 0 : -1);
+}
+
 std::string DbSqlEditorHistory::restore_sql_from_history(int entry_index, std::list<int> &detail_indexes) {
   std::string sql;
   if (entry_index >= 0) {
@@ -103,8 +141,8 @@ std::string DbSqlEditorHistory::restore_sql_from_history(int entry_index, std::l
     if (entry_index == _current_entry_index)
       details_model = _details_model;
     else {
-      details_model = DetailsModel::create();
-      details_model->load(_entries_model->entry_path(entry_index));
+      details_model = DetailsModel::create(_store);
+      details_model->load(_entries_model->entry_day(entry_index), _filter);
     }
     std::string statement;
     for (int row : detail_indexes) {
@@ -135,76 +173,25 @@ void DbSqlEditorHistory::EntriesModel::reset() {
 }
 
 void DbSqlEditorHistory::EntriesModel::load() {
-  std::string sql_history_dir = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
-  g_mkdir_with_parents(sql_history_dir.c_str(), 0700);
-  {
-    GError *error = NULL;
-    GDir *dir = g_dir_open(sql_history_dir.c_str(), 0, &error);
-    if (!dir) {
-      grt::GRT::get()->send_error(_("Can't open SQL history directory"),
-                                  (error ? error->message : sql_history_dir.c_str()));
-      return;
-    }
-    // files are not read in alpha-order, so we need to sort them before inserting
-    std::set<std::string> entries;
-    base::ScopeExitTrigger on_scope_exit(std::bind(&g_dir_close, dir));
-    while (const char *name_ = g_dir_read_name(dir)) {
-      // file name is expected in "YYYY-MM-DD" format
-      std::string name(name_);
-      if (name.size() != 10)
-        continue;
-      name[4] = '\0';
-      name[7] = '\0';
-      entries.insert(name);
-    }
-
-    for (std::set<std::string>::const_iterator name = entries.begin(); name != entries.end(); ++name) {
-      tm t;
-      memset(&t, 0, sizeof(t));
-      t.tm_year = base::atoi<int>(&(*name)[0], 0) - 1900;
-      t.tm_mon = base::atoi<int>(&(*name)[5], 0) - 1;
-      t.tm_mday = base::atoi<int>(&(*name)[8], 0);
-      if (t.tm_year != 0)
-        insert_entry(t);
-    }
-  }
+  std::vector<std::string> days = _owner->_store->days(_owner->_filter);
+
+  base::RecMutexLock data_mutex(_data_mutex);
+  _data.clear();
+  _data.reserve(days.size());
+  for (const std::string &day : days)
+    _data.push_back(day);
+  _row_count = days.size();
+  _data_frame_begin = 0;
+  _data_frame_end = _row_count;
 }
 
-void DbSqlEditorHistory::EntriesModel::add_statements(const std::list<std::string> &statements) {
-  if (statements.empty())
-    return;
-
-  std::tm timestamp = local_timestamp();
-  bool new_date = insert_entry(timestamp);
-
-  std::string time = format_time(timestamp, "%X");
-  std::list<std::string> timed_statements;
-
-  for (std::string statement : statements) {
-    timed_statements.push_back(time);
-    timed_statements.push_back(base::strip_text(statement));
-  }
-
-  if (new_date) {
-    refresh_ui();
-    _owner->current_entry((int)_row_count - 1);
-    _owner->update_timestamp(timestamp);
-  }
-
-  if (_ui_usage)
-    _owner->details_model()->add_entries(timed_statements);
-  else
-    _owner->write_only_details_model()->add_entries(timed_statements);
-}
-
-bool DbSqlEditorHistory::EntriesModel::insert_entry(const std::tm &t) {
+bool DbSqlEditorHistory::EntriesModel::insert_entry(const std::string &day) {
   std::string newest_date;
   if (_row_count > 0)
     get_field(NodeId(0), 0, newest_date);
-  std::string date = format_time(t, "%Y-%m-%d");
-  if (date != newest_date) {
+  if (day != newest_date) {
     base::RecMutexLock data_mutex(_data_mutex);
-    _data.insert(_data.begin(), date);
+    _data.insert(_data.begin(), day);
     ++_row_count;
     ++_data_frame_end;
     return true;
@@ -268,11 +255,17 @@ void DbSqlEditorHistory::EntriesModel::delete_entries(const std::vector<std::siz
   {
     std::vector<size_t> sorted_rows = rows;
     std::sort(sorted_rows.begin(), sorted_rows.end());
+    base::RecMutexLock data_mutex(_data_mutex);
     BOOST_REVERSE_FOREACH(size_t row, sorted_rows) {
+      _owner->_store->delete_day(entry_day(row));
+
+      // Files written by older versions are imported only once, but must not be left behind either.
+      std::string path = entry_path(row);
       try {
-        base::remove(entry_path(row));
+        if (base::file_exists(path))
+          base::remove(path);
       } catch (const std::exception &exc) {
-        logError("Error deleting log entry %s: %s\n", entry_path(row).c_str(), exc.what());
+        logError("Error deleting log entry %s: %s\n", path.c_str(), exc.what());
       }
       Cell row_begin = _data.begin() + row * _column_count;
       _data.erase(row_begin, row_begin + _column_count);
@@ -283,29 +276,20 @@ void DbSqlEditorHistory::EntriesModel::delete_entries(const std::vector<std::siz
   _owner->current_entry(-1);
 }
 
+std::string DbSqlEditorHistory::EntriesModel::entry_day(std::size_t index) {
+  std::string day;
+  get_field(index, 0, day);
+  return day;
+}
+
 std::string DbSqlEditorHistory::EntriesModel::entry_path(std::size_t index) {
-  std::string name;
-  get_field(index, 0, name);
   std::string storage_file_path = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
-  storage_file_path = base::makePath(storage_file_path, name);
+  storage_file_path = base::makePath(storage_file_path, entry_day(index));
   return storage_file_path;
 }
 
-std::tm DbSqlEditorHistory::EntriesModel::entry_date(std::size_t index) {
-  tm t;
-  std::string name;
-  get_field(index, 0, name);
-
-  memset(&t, 0, sizeof(t));
-  t.tm_year = base::atoi<int>(&name[0], 0) - 1900;
-  t.tm_mon = base::atoi<int>(&name[5], 0) - 1;
-  t.tm_mday = base::atoi<int>(&name[8], 0);
-
-  return t;
-}
-
 //--------------------------------------------------------------------------------------------------
-DbSqlEditorHistory::DetailsModel::DetailsModel() : VarGridModel() {
+DbSqlEditorHistory::DetailsModel::DetailsModel(std::shared_ptr<SqlHistoryStore> store) : VarGridModel(), _store(store) {
   reset();
 
   _context_menu.add_item(_("Copy Row To Clipboard"), "copy_row");
@@ -317,15 +301,15 @@ DbSqlEditorHistory::DetailsModel::DetailsModel() : VarGridModel() {
 void DbSqlEditorHistory::DetailsModel::reset() {
   VarGridModel::reset();
 
-  _last_loaded_row = -1;
-  _last_timestamp = std::string("");
-  _last_statement = std::string("");
-  _datestamp = local_timestamp();
+  _day.clear();
+  _filter.clear();
 
   _readonly = true;
 
   add_column("Time", std::string());
   add_column("SQL", std::string());
+  add_column("Schema", std::string());
+  add_column("Duration", std::string());
 
   std::shared_ptr<sqlite::connection> data_swap_db = this->data_swap_db();
   Recordset_data_storage::create_data_swap_tables(data_swap_db.get(), _column_names, _column_types);
@@ -333,170 +317,65 @@ void DbSqlEditorHistory::DetailsModel::reset() {
   refresh_ui();
 }
 
-void DbSqlEditorHistory::DetailsModel::load(const std::string &storage_file_path) {
-  if (base::file_exists(storage_file_path)) {
-    std::ifstream historyXml(storage_file_path);
-    if (historyXml.is_open()) {
-      std::string line;
-
-      // Skips the first line in the file as is the xml header
-      std::getline(historyXml, line);
-      _row_count = 0;
-
-      base::RecMutexLock data_mutex(_data_mutex);
-      _data.clear();
-      _data.reserve(_data.size() + _column_count);
-      while (historyXml.good()) {
-        std::getline(historyXml, line);
-
-        if (line.empty())
-          continue;
-
-        xmlDocPtr xmlDoc = base::xml::xmlParseFragment(line);
-        if (xmlDoc == nullptr) {
-          logError("Can't parse %s, of file: %s\n", line.c_str(), storage_file_path.c_str());
-          continue;
-        }
-
-        // In history we've got one element per line.
-        auto element = xmlDoc->children;
-        if (element->next !=
-            nullptr) // If there's something more, we log proper information and parse only that one element.
-          logError("History line contains too many elements %s, of file: %s\n", line.c_str(),
-                   storage_file_path.c_str());
-
-        std::string timestamp = base::xml::getProp(element, "timestamp");
-        std::string statement = base::xml::getContent(element);
-        // decides whether to use or not the existing data
-        if (timestamp != _last_timestamp.toString() && timestamp != "~")
-          _last_timestamp = timestamp;
-
-        if (statement != _last_statement.toString() && statement != "~")
-          _last_statement = statement;
-
-        _data.push_back(_last_statement);
-        _data.push_back(_last_timestamp);
-
-        _row_count++;
-
-        xmlFree(xmlDoc);
-      }
-
-      std::reverse(_data.begin(), _data.end());
-
-      _data_frame_end = _row_count;
-
-      _last_loaded_row = (int)_row_count - 1;
-    }
-  } else
-    logError("Can't open SQL history file %s\n", storage_file_path.c_str());
-}
-
-std::string DbSqlEditorHistory::DetailsModel::storage_file_path() const {
-  std::string storage_file_path = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
-  storage_file_path = base::makePath(storage_file_path, format_time(_datestamp, "%Y-%m-%d"));
-  return storage_file_path;
+/**
+ * Only counts the statements of the given day, the rows themselves are fetched when they are first accessed.
+ */
+void DbSqlEditorHistory::DetailsModel::load(const std::string &day, const std::string &filter) {
+  std::size_t count = _store->count(day, filter);
+
+  base::RecMutexLock data_mutex(_data_mutex);
+  _day = day;
+  _filter = filter;
+  _row_count = count;
+  invalidate();
 }
 
-void DbSqlEditorHistory::DetailsModel::save() {
-  std::string storage_file_path = this->storage_file_path();
-  std::ofstream ofs;
-  {
-    std::string storage_file_dir = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
-    if (g_mkdir_with_parents(storage_file_dir.c_str(), 0700) != -1) {
-      bool is_file_new = (g_file_test(storage_file_path.c_str(), G_FILE_TEST_EXISTS) == 0);
-      if (is_file_new || g_file_test(storage_file_path.c_str(), G_FILE_TEST_IS_REGULAR)) {
-        ofs.open(base::path_from_utf8(storage_file_path).c_str(), std::ios_base::app);
-        if (is_file_new)
-          ofs << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n";
-      }
-    }
-  }
-
-  if (!ofs.is_open() || !ofs) {
-    grt::GRT::get()->send_error("Can't write to SQL history file", storage_file_path);
+/**
+ * Called when statements were appended to the loaded day. They come first (newest on top), so all cached rows move.
+ */
+void DbSqlEditorHistory::DetailsModel::entries_added(std::size_t count) {
+  base::RecMutexLock data_mutex(_data_mutex);
+  if (_day.empty())
     return;
-  }
-
-  {
-
-    base::RecMutexLock data_mutex(_data_mutex);
-    std::reverse(_data.begin(), _data.end());
-    std::string last_saved_timestamp;
-    std::string last_saved_statement;
-    get_field(NodeId(_last_loaded_row), 1, last_saved_timestamp);
-    get_field(NodeId(_last_loaded_row), 0, last_saved_statement);
-
-    for (RowId row = _last_loaded_row + 1; row < _row_count; ++row) {
-      std::string time, sql;
-      get_field(NodeId((int)row), 1, time);
-      get_field(NodeId((int)row), 0, sql);
-
-      if (time == last_saved_timestamp)
-        time = "~";
-      else
-        last_saved_timestamp = time;
-
-      if (sql == last_saved_statement)
-        sql = "~";
-      else
-        last_saved_statement = sql;
-
-      std::string xml_time, xml_sql;
-      xml_time = base::xml::encodeEntities(time);
-      xml_sql = base::xml::encodeEntities(sql);
-      xml_sql = base::replaceString(xml_sql, "\n", "&#x0A;");
-      ofs << "<ENTRY timestamp=\'" << xml_time << "\'>" << xml_sql << "</ENTRY>\n";
-    }
-    _last_loaded_row = (int)_row_count - 1;
-    std::reverse(_data.begin(), _data.end());
-  }
-  ofs.flush();
+  _row_count += count;
+  invalidate();
 }
 
-void DbSqlEditorHistory::DetailsModel::add_entries(const std::list<std::string> &statements) {
-  if (statements.empty())
-    return;
-
-  {
-    base::RecMutexLock data_mutex(_data_mutex);
-
-    _data.reserve(_data.size() + _column_count);
-
-    try {
-      int index = 0;
-      for (auto rit = statements.rbegin(); rit != statements.rend(); rit++) {
-        if (index % 2) {
-          // decides whether to use or not the existing data
-          if (*rit != _last_timestamp.toString())
-            _last_timestamp = *rit;
+void DbSqlEditorHistory::DetailsModel::invalidate() {
+  base::RecMutexLock data_mutex(_data_mutex);
+  _data.clear();
+  _data_frame_begin = 0;
+  _data_frame_end = 0;
+}
 
-          _data.insert(_data.begin(), _last_timestamp);
-        } else {
-          if (*rit != _last_statement.toString())
-            _last_statement = *rit;
+VarGridModel::Cell DbSqlEditorHistory::DetailsModel::cell(RowId row, ColumnId column) {
+  if (row >= _row_count)
+    return _data.end();
 
-          _data.insert(_data.begin(), _last_statement);
-        }
-        index++;
-      }
+  if (row < _data_frame_begin || row >= _data_frame_end)
+    fetch_page(row);
 
-    } catch (...) {
-      _data.resize(_row_count * _column_count);
-      throw;
-    }
+  return _data.begin() + (row - _data_frame_begin) * _column_count + column;
+}
 
-    _row_count += statements.size() / 2;
-    _data_frame_end = _row_count;
+void DbSqlEditorHistory::DetailsModel::fetch_page(RowId row) {
+  RowId begin = row - row % HISTORY_PAGE_SIZE;
+  RowId end = std::min(begin + HISTORY_PAGE_SIZE, _row_count);
+  std::vector<SqlHistoryStore::Entry> entries = _store->fetch(_day, _filter, begin, end - begin);
+
+  _data.clear();
+  _data.reserve((end - begin) * _column_count);
+  for (const SqlHistoryStore::Entry &entry : entries) {
+    _data.push_back(entry.time);
+    _data.push_back(entry.statement);
+    _data.push_back(entry.schema);
+    _data.push_back(entry.duration < 0 ? std::string() : base::strfmt(_("%.3f sec"), entry.duration));
   }
 
-  save();
-
-  // refresh_ui();
-}
+  // Entries deleted in the meantime (by another editor) would otherwise leave the page short.
+  _data.resize((end - begin) * _column_count, std::string());
 
-void DbSqlEditorHistory::update_timestamp(std::tm timestamp) {
-  details_model()->datestamp(timestamp);
-  write_only_details_model()->datestamp(timestamp);
+  _data_frame_begin = begin;
+  _data_frame_end = end;
 }
 //--------------------------------------------------------------------------------------------------
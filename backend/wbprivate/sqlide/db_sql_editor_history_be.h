@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2008, 2018, Oracle and/or its affiliates. All rights reserved.
+ * Copyright (c) 2008, 2023, Oracle and/or its affiliates. All rights reserved.
  *
  * This program is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License, version 2.0,
@@ -26,6 +26,7 @@
 
 #include "workbench/wb_backend_public_interface.h"
 #include "sqlide/var_grid_model_be.h"
+#include "sqlide/sql_history_store.h"
 #include <time.h>
 #include "mforms/menu.h"
 
@@ -42,15 +43,24 @@ protected:
 
 public:
   void reset();
-  void add_entry(const std::list<std::string> &statements);
+  std::int64_t add_entry(const std::list<std::string> &statements, const std::string &schema = "");
+  void set_entry_duration(std::int64_t id, double duration);
   int current_entry() {
     return _current_entry_index;
   }
   void current_entry(int index);
   std::string restore_sql_from_history(int entry_index, std::list<int> &detail_indexes);
 
+  // Restricts both models to the entries matching the given text (full-text search). Empty to show everything.
+  void set_filter(const std::string &filter);
+  std::string filter() const {
+    return _filter;
+  }
+
 protected:
   int _current_entry_index;
+  std::string _filter;
+  std::shared_ptr<SqlHistoryStore> _store;
 
 public:
   void load();
@@ -64,15 +74,14 @@ public:
   public:
     friend class DbSqlEditorHistory;
     typedef std::shared_ptr<DetailsModel> Ref;
-    static Ref create() {
-      return Ref(new DetailsModel());
+    static Ref create(std::shared_ptr<SqlHistoryStore> store) {
+      return Ref(new DetailsModel(store));
     }
 
   protected:
-    DetailsModel();
+    DetailsModel(std::shared_ptr<SqlHistoryStore> store);
 
   public:
-    void add_entries(const std::list<std::string> &statements);
     virtual void refresh() {
       refresh_ui();
     }
@@ -82,27 +91,19 @@ public:
 
     virtual void reset();
 
-    void save();
-    void load(const std::string &storage_file_path);
+    void load(const std::string &day, const std::string &filter);
+    void entries_added(std::size_t count);
+    void invalidate();
 
   protected:
-    int _last_loaded_row; // required to skip duplication of existing entries when dumping contents
-
-  public:
-    std::tm datestamp() const {
-      return _datestamp;
-    }
-    void datestamp(const std::tm &val) {
-      _datestamp = val;
-    }
-
-  protected:
-    std::string storage_file_path() const;
-    std::tm _datestamp; // raw datestamp for locale independent storage file name
+    // Rows are fetched from the store one page at a time, when the grid asks for them.
+    virtual Cell cell(RowId row, ColumnId column);
+    void fetch_page(RowId row);
 
   private:
-    grt::StringRef _last_timestamp;
-    grt::StringRef _last_statement;
+    std::shared_ptr<SqlHistoryStore> _store;
+    std::string _day;
+    std::string _filter;
     mforms::Menu _context_menu;
   };
 
@@ -124,10 +125,8 @@ public:
 
     DbSqlEditorHistory *_owner;
 
-    void add_statements(const std::list<std::string> &statements);
-
   public:
-    bool insert_entry(const std::tm &t);
+    bool insert_entry(const std::string &day);
     void delete_all_entries();
     void delete_entries(const std::vector<std::size_t> &rows);
     void set_ui_usage(bool value) {
@@ -137,8 +136,8 @@ public:
       return _ui_usage;
     }
 
+    std::string entry_day(std::size_t index);
     std::string entry_path(std::size_t index);
-    std::tm entry_date(std::size_t index);
 
     virtual void reset();
     void load();
@@ -154,16 +153,10 @@ public:
   DetailsModel::Ref details_model() {
     return _details_model;
   }
-  DetailsModel::Ref write_only_details_model() {
-    return _write_only_details_model;
-  }
 
 protected:
   EntriesModel::Ref _entries_model;
   DetailsModel::Ref _details_model;
-  DetailsModel::Ref _write_only_details_model;
-
-  void update_timestamp(std::tm timestamp);
 };
 
 #endif /* _DB_SQL_EDITOR_HISTORY_BE_H_ */
@@ -206,6 +206,12 @@ void SpatialDrawBox::render(bool reproject) {
 
   _ctx_cache->set_line_width(0);
 
+  // The part of the layers that ends up on the surface, so features outside of it can be skipped.
+  double x1 = 0, y1 = 0, x2 = width, y2 = height;
+  _ctx_cache->device_to_user(&x1, &y1);
+  _ctx_cache->device_to_user(&x2, &y2);
+  base::Rect visible_rect(std::min(x1, x2), std::min(y1, y2), fabs(x2 - x1), fabs(y2 - y1));
+
   if (reproject && !_background_layer->hidden())
     _background_layer->render(_spatial_reprojector);
 
@@ -220,7 +226,7 @@ void SpatialDrawBox::render(bool reproject) {
     if (!(*it)->hidden()) {
       if (reproject)
         (*it)->render(_spatial_reprojector);
-      (*it)->repaint(*_ctx_cache, _zoom_level, base::Rect());
+      (*it)->repaint(*_ctx_cache, _zoom_level, visible_rect);
     }
   }
 
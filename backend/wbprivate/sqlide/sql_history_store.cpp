@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <fstream>
+
+#include <sqlite/connection.hpp>
+#include <sqlite/execute.hpp>
+#include <sqlite/query.hpp>
+
+#include "base/log.h"
+#include "base/file_utilities.h"
+#include "base/string_utilities.h"
+#include "base/boost_smart_ptr_helpers.h"
+#include "base/xml_functions.h"
+#include "sqlide/sqlide_generics.h"
+
+#include "sql_history_store.h"
+
+DEFAULT_LOG_DOMAIN("sqlide-history")
+
+// Bumped when the legacy per-day files have been imported.
+static const int HISTORY_STORE_VERSION = 1;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool table_exists(sqlite::connection &connection, const std::string &name) {
+  sqlite::query q(connection, "select count(*) from sqlite_master where name = ?");
+  q.bind(1, name);
+  if (q.emit()) {
+    std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+    return res->get_int(0) > 0;
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Turns the search text into an FTS query: every word is quoted (so operators and punctuation typed by the user have
+ * no special meaning) and matched as prefix.
+ */
+static std::string fulltext_expression(const std::string &filter) {
+  std::string expression;
+  for (const std::string &word : base::split_by_set(filter, " \t\r\n")) {
+    if (word.empty())
+      continue;
+    if (!expression.empty())
+      expression += " ";
+    expression += "\"" + base::replaceString(word, "\"", "\"\"") + "\"*";
+  }
+  return expression;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static std::string like_pattern(const std::string &filter) {
+  std::string pattern = "%";
+  for (char c : base::trim(filter)) {
+    if (c == '%' || c == '_' || c == '\\')
+      pattern += '\\';
+    pattern += c;
+  }
+  return pattern + "%";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SqlHistoryStore::SqlHistoryStore(const std::string &path) : _fulltext(false) {
+  _connection.reset(new sqlite::connection(path));
+  sqlite::execute(*_connection, "pragma temp_store = memory", true);
+  sqlite::execute(*_connection, "pragma synchronous = normal", true);
+
+  // Several SQL editors can write to the store at the same time.
+  sqlite::execute(*_connection, "pragma busy_timeout = 2000", true);
+
+  logDebug2("Using SQL history store %s\n", path.c_str());
+  init_db();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SqlHistoryStore::~SqlHistoryStore() {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::init_db() {
+  sqlite::execute(*_connection,
+                  "create table if not exists history (id integer primary key autoincrement, day text not null, "
+                  "time text not null, timestamp integer, schema text, duration real, statement text not null)",
+                  true);
+  sqlite::execute(*_connection, "create index if not exists history_day on history (day, id)", true);
+
+  // The full-text index is an external content table, so statements are not stored twice. Not every SQLite build
+  // comes with FTS5, in which case searching falls back to a plain pattern match.
+  try {
+    bool had_index = table_exists(*_connection, "history_fts");
+    sqlite::execute(*_connection,
+                    "create virtual table if not exists history_fts using fts5(statement, schema, content = 'history', "
+                    "content_rowid = 'id')",
+                    true);
+    sqlite::execute(*_connection,
+                    "create trigger if not exists history_insert after insert on history begin "
+                    "insert into history_fts (rowid, statement, schema) values (new.id, new.statement, new.schema); end",
+                    true);
+    sqlite::execute(*_connection,
+                    "create trigger if not exists history_delete after delete on history begin "
+                    "insert into history_fts (history_fts, rowid, statement, schema) "
+                    "values ('delete', old.id, old.statement, old.schema); end",
+                    true);
+    if (!had_index)
+      sqlite::execute(*_connection, "insert into history_fts (history_fts) values ('rebuild')", true);
+    _fulltext = true;
+  } catch (std::exception &exc) {
+    logWarning("Full-text index for the SQL history not available, using plain search: %s\n", exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the condition restricting history rows to those matching the filter, with a single placeholder for
+ * the value stored in argument. Returns an empty string if there's nothing to filter.
+ */
+std::string SqlHistoryStore::filter_condition(const std::string &filter, std::string &argument) const {
+  if (_fulltext) {
+    argument = fulltext_expression(filter);
+    if (argument.empty())
+      return "";
+    return "id in (select rowid from history_fts where history_fts match ?)";
+  }
+
+  if (base::trim(filter).empty())
+    return "";
+  argument = like_pattern(filter);
+  return "statement like ? escape '\\'";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::int64_t SqlHistoryStore::append(const std::tm &timestamp, const std::string &schema,
+                                     const std::list<std::string> &statements) {
+  if (statements.empty())
+    return -1;
+
+  std::tm local_time = timestamp;
+  std::int64_t seconds = (std::int64_t)mktime(&local_time);
+  std::string day = format_time(timestamp, "%Y-%m-%d");
+  std::string time = format_time(timestamp, "%X");
+
+  base::RecMutexLock lock(_mutex);
+  try {
+    sqlide::Sqlite_transaction_guarder transaction(_connection.get());
+    sqlite::query q(*_connection,
+                    "insert into history (day, time, timestamp, schema, statement) values (?, ?, ?, ?, ?)");
+    for (const std::string &statement : statements) {
+      q.bind(1, day);
+      q.bind(2, time);
+      q.bind(3, seconds);
+      if (schema.empty())
+        q.bind(4);
+      else
+        q.bind(4, schema);
+      q.bind(5, base::strip_text(statement));
+      q.emit();
+      q.clear();
+    }
+
+    sqlite::query id_query(*_connection, "select last_insert_rowid()");
+    if (id_query.emit()) {
+      std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(id_query.get_result()));
+      return res->get_int64(0);
+    }
+  } catch (std::exception &exc) {
+    logError("Error storing SQL history entries: %s\n", exc.what());
+  }
+  return -1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::set_duration(std::int64_t id, double duration) {
+  if (id < 0)
+    return;
+
+  base::RecMutexLock lock(_mutex);
+  try {
+    sqlite::query q(*_connection, "update history set duration = ? where id = ?");
+    q.bind(1, duration);
+    q.bind(2, id);
+    q.emit();
+  } catch (std::exception &exc) {
+    logError("Error storing SQL history duration: %s\n", exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<std::string> SqlHistoryStore::days(const std::string &filter) {
+  std::vector<std::string> result;
+  std::string argument;
+  std::string condition = filter_condition(filter, argument);
+
+  base::RecMutexLock lock(_mutex);
+  try {
+    sqlite::query q(*_connection, "select distinct day from history" +
+                                    (condition.empty() ? std::string() : " where " + condition) + " order by day desc");
+    if (!condition.empty())
+      q.bind(1, argument);
+    if (q.emit()) {
+      std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+      do {
+        result.push_back(res->get_string(0));
+      } while (res->next_row());
+    }
+  } catch (std::exception &exc) {
+    logError("Error reading SQL history days: %s\n", exc.what());
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::size_t SqlHistoryStore::count(const std::string &day, const std::string &filter) {
+  std::string argument;
+  std::string condition = filter_condition(filter, argument);
+
+  base::RecMutexLock lock(_mutex);
+  try {
+    sqlite::query q(*_connection,
+                    "select count(*) from history where day = ?" + (condition.empty() ? "" : " and " + condition));
+    q.bind(1, day);
+    if (!condition.empty())
+      q.bind(2, argument);
+    if (q.emit()) {
+      std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+      return (std::size_t)res->get_int64(0);
+    }
+  } catch (std::exception &exc) {
+    logError("Error counting SQL history entries for %s: %s\n", day.c_str(), exc.what());
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns a page of the entries of the given day, newest first.
+ */
+std::vector<SqlHistoryStore::Entry> SqlHistoryStore::fetch(const std::string &day, const std::string &filter,
+                                                           std::size_t offset, std::size_t limit) {
+  std::vector<Entry> entries;
+  std::string argument;
+  std::string condition = filter_condition(filter, argument);
+
+  base::RecMutexLock lock(_mutex);
+  try {
+    sqlite::query q(*_connection,
+                    "select id, time, ifnull(schema, ''), ifnull(duration, -1), statement from history where day = ?" +
+                      (condition.empty() ? "" : " and " + condition) + " order by id desc limit ? offset ?");
+    int index = 1;
+    q.bind(index++, day);
+    if (!condition.empty())
+      q.bind(index++, argument);
+    q.bind(index++, (std::int64_t)limit);
+    q.bind(index++, (std::int64_t)offset);
+    if (q.emit()) {
+      entries.reserve(limit);
+      std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+      do {
+        Entry entry;
+        entry.id = res->get_int64(0);
+        entry.time = res->get_string(1);
+        entry.schema = res->get_string(2);
+        entry.duration = res->get_double(3);
+        entry.statement = res->get_string(4);
+        entries.push_back(entry);
+      } while (res->next_row());
+    }
+  } catch (std::exception &exc) {
+    logError("Error reading SQL history entries for %s: %s\n", day.c_str(), exc.what());
+  }
+  return entries;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::delete_day(const std::string &day) {
+  base::RecMutexLock lock(_mutex);
+  try {
+    sqlite::query q(*_connection, "delete from history where day = ?");
+    q.bind(1, day);
+    q.emit();
+  } catch (std::exception &exc) {
+    logError("Error deleting SQL history entries for %s: %s\n", day.c_str(), exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::size_t SqlHistoryStore::import_legacy_files(const std::string &dir) {
+  std::size_t imported = 0;
+
+  base::RecMutexLock lock(_mutex);
+  try {
+    // The immediate transaction also keeps other editors from running the import at the same time.
+    sqlide::Sqlite_transaction_guarder transaction(_connection.get());
+    {
+      sqlite::query q(*_connection, "pragma user_version");
+      if (q.emit()) {
+        std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+        if (res->get_int(0) >= HISTORY_STORE_VERSION)
+          return 0;
+      }
+    }
+
+    // Older versions wrote one file per day, named YYYY-MM-DD. Sorting them keeps ids in chronological order.
+    std::list<std::string> files = base::scan_for_files_matching(base::makePath(dir, "\?\?\?\?-\?\?-\?\?"));
+    files.sort();
+    for (const std::string &file : files)
+      imported += import_legacy_file(file, base::basename(file));
+
+    sqlite::execute(*_connection, base::strfmt("pragma user_version = %i", HISTORY_STORE_VERSION), true);
+  } catch (std::exception &exc) {
+    logError("Error importing SQL history files from %s: %s\n", dir.c_str(), exc.what());
+    return 0;
+  }
+
+  if (imported > 0)
+    logInfo("Imported %lu SQL history entries from %s\n", (unsigned long)imported, dir.c_str());
+  return imported;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Reads one of the old history files: an XML header followed by one <ENTRY timestamp='...'>sql</ENTRY> element
+ * per line, where "~" stands for the value of the previous line.
+ */
+std::size_t SqlHistoryStore::import_legacy_file(const std::string &path, const std::string &day) {
+  std::ifstream history_xml(base::path_from_utf8(path).c_str());
+  if (!history_xml.is_open()) {
+    logError("Can't open SQL history file %s\n", path.c_str());
+    return 0;
+  }
+
+  std::size_t imported = 0;
+  std::string line;
+  std::string last_timestamp;
+  std::string last_statement;
+
+  sqlite::query q(*_connection, "insert into history (day, time, statement) values (?, ?, ?)");
+
+  // Skip the XML header.
+  std::getline(history_xml, line);
+  while (std::getline(history_xml, line)) {
+    if (line.empty())
+      continue;
+
+    xmlDocPtr document = base::xml::xmlParseFragment(line);
+    if (document == nullptr || document->children == nullptr) {
+      logError("Can't parse %s, of file: %s\n", line.c_str(), path.c_str());
+      if (document != nullptr)
+        xmlFreeDoc(document);
+      continue;
+    }
+
+    xmlNodePtr element = document->children;
+    std::string timestamp = base::xml::getProp(element, "timestamp");
+    std::string statement = base::xml::getContent(element);
+    xmlFreeDoc(document);
+
+    if (timestamp != "~")
+      last_timestamp = timestamp;
+    if (statement != "~")
+      last_statement = statement;
+
+    q.bind(1, day);
+    q.bind(2, last_timestamp);
+    q.bind(3, last_statement);
+    q.emit();
+    q.clear();
+    ++imported;
+  }
+
+  return imported;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include "workbench/wb_backend_public_interface.h"
+#include "base/threading.h"
+
+#include <cstdint>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sqlite {
+  class connection;
+}
+
+/**
+ * Persistent store for the statements run in the SQL editor. Entries are only ever appended (apart from dropping
+ * whole days on user request) to a SQLite database, which keeps a full-text index over the statement text and the
+ * default schema. Callers page through a day instead of loading it as a whole.
+ */
+class MYSQLWBBACKEND_PUBLIC_FUNC SqlHistoryStore {
+public:
+  struct Entry {
+    std::int64_t id;
+    std::string time;
+    std::string schema;
+    double duration; // In seconds, negative if not known (yet).
+    std::string statement;
+  };
+
+  SqlHistoryStore(const std::string &path);
+  ~SqlHistoryStore();
+
+  // Returns the id of the last appended statement or -1 if nothing was stored.
+  std::int64_t append(const std::tm &timestamp, const std::string &schema, const std::list<std::string> &statements);
+  void set_duration(std::int64_t id, double duration);
+
+  // Days (YYYY-MM-DD) which have entries matching the filter, newest first. An empty filter matches everything.
+  std::vector<std::string> days(const std::string &filter);
+  std::size_t count(const std::string &day, const std::string &filter);
+  std::vector<Entry> fetch(const std::string &day, const std::string &filter, std::size_t offset, std::size_t limit);
+  void delete_day(const std::string &day);
+
+  // Imports the per-day XML files written by older versions. Only runs once per store.
+  std::size_t import_legacy_files(const std::string &dir);
+
+  bool has_fulltext_index() const {
+    return _fulltext;
+  }
+
+private:
+  std::unique_ptr<sqlite::connection> _connection;
+  base::RecMutex _mutex;
+  bool _fulltext;
+
+  void init_db();
+  std::string filter_condition(const std::string &filter, std::string &argument) const;
+  std::size_t import_legacy_file(const std::string &path, const std::string &day);
+};
@@ -39,6 +39,7 @@
 #include "sqlide/sql_script_run_wizard.h"
 
 #include "sqlide/column_width_cache.h"
+#include "sqlide/schema_meta_data_cache.h"
 
 #include "objimpl/db.query/db_query_Resultset.h"
 #include "objimpl/wrapper/mforms_ObjectReference_impl.h"
@@ -329,7 +330,11 @@ SqlEditorForm::~SqlEditorForm() {
     mforms::Utilities::forget_cached_password(_connection->hostIdentifier(),
                                               _connection->parameterValues().get_string("userName"));
 
+  if (_metadata_pool)
+    _metadata_pool->close();
+
   delete _column_width_cache;
+  delete _schema_meta_data_cache;
 
   // debug: ensure that close() was called when the tab is closed
   if (_toolbar != nullptr)
@@ -394,6 +399,18 @@ void SqlEditorForm::finish_startup() {
 
   _column_width_cache = new ColumnWidthCache(sanitize_file_name(get_session_name()), cache_dir);
 
+  if (bec::GRTManager::get()->get_app_option_int("DbSqlEditor:CodeCompletionCacheEnabled", 1) != 0) {
+    _schema_meta_data_cache = new SchemaMetaDataCache(sanitize_file_name(get_session_name()), cache_dir);
+
+    // Make the symbols from the last session available right away. They are replaced by live data once the schema
+    // tree has been loaded (see schemaListRefreshed() and schema_meta_data_refreshed()).
+    std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
+    if (_databaseSymbols.getSymbolsOfType<SchemaSymbol>().empty()) {
+      for (auto &schema : _schema_meta_data_cache->get_schemas())
+        loadCachedSchemaContent(_databaseSymbols.addNewSymbol<SchemaSymbol>(nullptr, schema));
+    }
+  }
+
   if (_usr_dbc_conn && !_usr_dbc_conn->active_schema.empty())
     _live_tree->on_active_schema_change(_usr_dbc_conn->active_schema);
   readStaticServerSymbols();
@@ -576,6 +593,11 @@ grt::StringRef SqlEditorForm::do_disconnect() {
       close_connection(_aux_dbc_conn);
       _aux_dbc_conn->ref.reset();
     }
+
+    if (_metadata_pool) {
+      _metadata_pool->close();
+      _metadata_pool.reset();
+    }
   }
 
   return grt::StringRef();
@@ -1116,6 +1138,13 @@ void SqlEditorForm::create_connection(sql::Dbc_connection_handler::Ref &dbc_conn
     }
   }
 
+  // Read once here, so that applying result set changes doesn't need an extra query for it.
+  {
+    std::string max_allowed_packet;
+    if (get_session_variable(dbc_conn->ref.get(), "max_allowed_packet", max_allowed_packet))
+      dbc_conn->max_allowed_packet = base::atoi<std::int64_t>(max_allowed_packet, 0);
+  }
+
   // Activate default schema, if it's empty, use last active
   if (dbc_conn->active_schema.empty()) {
     std::string default_schema = temp_connection->parameterValues().get_string("schema");
@@ -1143,6 +1172,42 @@ void SqlEditorForm::create_connection(sql::Dbc_connection_handler::Ref &dbc_conn
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Sets up the pool of read only connections used for meta data queries that may run in parallel (e.g. loading
+ * the content of several schemas in the schema tree). Connections are only opened when needed.
+ * A pool size of 0 disables the pool and everything goes through the aux connection.
+ */
+void SqlEditorForm::create_metadata_pool() {
+  if (_metadata_pool)
+    _metadata_pool->close();
+  _metadata_pool.reset();
+
+  long pool_size = bec::GRTManager::get()->get_app_option_int("DbSqlEditor:MetadataConnectionPoolSize", 3);
+  if (pool_size <= 0)
+    return;
+
+  _metadata_pool = sql::ConnectionPool::create(
+    "Meta data connections (" + _connection->name() + ")", (size_t)pool_size,
+    [this](sql::Dbc_connection_handler::Ref &conn) {
+      // Meta data queries always use qualified names. Setting a schema here keeps create_connection() from
+      // restoring the last default schema, which would also change the active schema in the UI.
+      if (conn->active_schema.empty())
+        conn->active_schema = "information_schema";
+
+      std::shared_ptr<SSHTunnel> tunnel = sql::DriverManager::getDriverManager()->getTunnel(_connection);
+      create_connection(conn, _connection, tunnel, _dbc_auth, true, false);
+
+      try {
+        std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
+        stmt->execute("SET SESSION TRANSACTION READ ONLY");
+      } catch (sql::SQLException &exc) {
+        logDebug("Could not make meta data connection read only: %s\n", exc.what());
+      }
+    });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 struct ConnectionErrorInfo {
   sql::AuthenticationError *auth_error;
   bool password_expired;
@@ -1364,6 +1429,7 @@ grt::StringRef SqlEditorForm::do_connect(std::shared_ptr<SSHTunnel> tunnel, sql:
     // open connections
     create_connection(_aux_dbc_conn, _connection, tunnel, auth, _aux_dbc_conn->autocommit_mode, false);
     create_connection(_usr_dbc_conn, _connection, tunnel, auth, _usr_dbc_conn->autocommit_mode, true);
+    create_metadata_pool();
     _serverIsOffline = false;
     cache_sql_mode();
 
@@ -1957,6 +2023,10 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
   if (bec::GRTManager::get()->get_app_option_int("SqlEditor:LimitRows") != 0)
     limit_rows = (int)bec::GRTManager::get()->get_app_option_int("SqlEditor:LimitRowsCount", 0);
 
+  // Opt-in: run SELECTs as forward-only prepared statements (streamed rows).
+  bool use_prepared_statements =
+    bec::GRTManager::get()->get_app_option_int("DbSqlEditor:ForwardOnlyPreparedExecution", 0) != 0;
+
   bec::GRTManager::get()->replace_status_text(_("Executing Query..."));
 
   std::shared_ptr<SqlEditorForm> self_ref = (self_ptr).lock();
@@ -1990,6 +2060,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
 
     bool ran_set_sql_mode = false;
     bool logging_queries;
+    std::int64_t parse_start = QueryTrace::now();
     std::vector<std::pair<std::size_t, std::size_t>> statement_ranges;
     sql_facade->splitSqlScript(sql->c_str(), sql->size(),
                                use_non_std_delimiter ? sql_specifics->non_std_sql_delimiter() : ";", statement_ranges);
@@ -2018,6 +2089,16 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
     for (auto &statement_range : statement_ranges) {
       logDebug3("Executing statement range: %lu, %lu...\n", statement_range.first, statement_range.second);
 
+      if (parse_start == 0)
+        parse_start = QueryTrace::now();
+
+      // Statements which get executed store their timeline in the trace log, no matter how processing ends.
+      QueryTrace trace;
+      base::ScopeExitTrigger store_trace([&]() {
+        if (!trace.empty())
+          _query_trace_log.add(trace);
+      });
+
       statement = sql->substr(statement_range.first, statement_range.second);
       std::list<std::string> sub_statements;
       sql_facade->splitSqlScript(statement, sub_statements);
@@ -2038,10 +2119,11 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
         std::string schema_name;
         std::string table_name;
 
+        std::int64_t history_id = -1;
         if (logging_queries) {
           std::list<std::string> statements;
           statements.push_back(statement);
-          _history->add_entry(statements);
+          history_id = _history->add_entry(statements, _usr_dbc_conn->active_schema);
         }
 
         Recordset_cdbc_storage::Ref data_storage;
@@ -2051,6 +2133,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
           data_storage = Recordset_cdbc_storage::create();
           data_storage->set_gather_field_info(true);
           data_storage->rdbms(rdbms());
+          data_storage->max_allowed_packet((size_t)_usr_dbc_conn->max_allowed_packet);
           data_storage->setUserConnectionGetter(
             std::bind(&SqlEditorForm::getUserConnection, this, std::placeholders::_1, std::placeholders::_2));
           data_storage->setAuxConnectionGetter(
@@ -2071,6 +2154,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
           }
 
           data_storage->sql_query(statement);
+          data_storage->use_prepared_statement(use_prepared_statements);
 
           {
             bool do_limit = !dont_add_limit_clause && limit_rows > 0;
@@ -2090,6 +2174,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
           long long updated_rows_count = -1;
           Timer statement_exec_timer(false);
           Timer statement_fetch_timer(false);
+          std::shared_ptr<sql::PreparedStatement> prepared_statement;
           std::shared_ptr<sql::Statement> dbc_statement(_usr_dbc_conn->ref->createStatement());
           bool is_result_set_first = false;
 
@@ -2098,15 +2183,34 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
               _("Query execution has been stopped, the connection to the DB server was not restarted, any open "
                 "transaction remains open"));
 
+          trace = QueryTrace(_query_trace_log.next_id(), statement);
+          trace.add_span(QueryTrace::Parse, parse_start, QueryTrace::now());
+          parse_start = 0;
+
           try {
             {
               base::ScopeExitTrigger schedule_statement_exec_timer_stop(std::bind(&Timer::stop, &statement_exec_timer));
+              std::int64_t exec_start = QueryTrace::now();
+              base::ScopeExitTrigger add_exec_trace(
+                [&]() { trace.add_span(QueryTrace::Send, exec_start, QueryTrace::now()); });
               statement_exec_timer.run();
-              is_result_set_first = dbc_statement->execute(statement);
+
+              // Preparing is a round trip to the server as well, so it counts as part of the execution.
+              if (data_storage && data_storage->use_prepared_statement())
+                prepared_statement =
+                  Recordset_cdbc_storage::prepare_forward_only_query(_usr_dbc_conn->ref.get(), statement);
+              if (prepared_statement) {
+                dbc_statement = prepared_statement;
+                is_result_set_first = prepared_statement->execute();
+              } else
+                is_result_set_first = dbc_statement->execute(statement);
             }
             logDebug3("Query executed successfully\n");
 
-            updated_rows_count = dbc_statement->getUpdateCount();
+            // The connector doesn't implement getUpdateCount() for prepared statements. Those only run SELECTs, which
+            // affect no rows, so the count stays unknown for them.
+            if (!prepared_statement)
+              updated_rows_count = dbc_statement->getUpdateCount();
 
             // XXX: coalesce all the special queries here and act on them *after* all queries have run.
             // Especially the drop command is redirected twice to idle tasks, kicking so in totally asynchronously
@@ -2145,6 +2249,8 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
                             statement_exec_timer.duration_formatted());
             statement_failed = true;
           }
+          _history->set_entry_duration(history_id, statement_exec_timer.duration());
+
           if (statement_failed) {
             if (_continueOnError)
               continue; // goto next statement
@@ -2203,7 +2309,8 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
                       add_log_message(DbSqlEditorLog::ErrorMsg,
                                       "No more results could be displayed. Operation canceled by user.", statement,
                                       "");
-                      dbc_statement->cancel();
+                      if (!prepared_statement) // Not implemented by the connector for prepared statements.
+                        dbc_statement->cancel();
                       dbc_statement->close();
                       return grt::StringRef("");
                     }
@@ -2224,6 +2331,9 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
                     base::ScopeExitTrigger schedule_statement_fetch_timer_stop(
                       std::bind(&Timer::stop, &statement_fetch_timer));
                     statement_fetch_timer.run();
+                    std::int64_t open_start = QueryTrace::now();
+                    base::ScopeExitTrigger add_open_trace(
+                      [&]() { trace.add_span(QueryTrace::ResultOpen, open_start, QueryTrace::now()); });
 
                     // need a separate exception catcher here, because sometimes a query error
                     // will only throw an exception after fetching starts, which causes the busy spinner
@@ -2272,6 +2382,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
                       data_storage = Recordset_cdbc_storage::create();
                       data_storage->set_gather_field_info(true);
                       data_storage->rdbms(rdbms());
+                      data_storage->max_allowed_packet((size_t)_usr_dbc_conn->max_allowed_packet);
                       data_storage->setUserConnectionGetter(std::bind(&SqlEditorForm::getUserConnection, this,
                                                                       std::placeholders::_1, std::placeholders::_2));
                       data_storage->setAuxConnectionGetter(std::bind(&SqlEditorForm::getAuxConnection, this,
@@ -2297,32 +2408,42 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
                       std::bind(&SqlEditorForm::apply_changes_to_recordset, this, Recordset::Ptr(rs));
                     rs->generator_query(statement);
 
-                    {
-                      if (query_ps_stats) {
-                        query_ps_statistics(_usr_dbc_conn->id, ps_stats);
-                        ps_stages = query_ps_stages(ps_stats["EVENT_ID"]);
-                        ps_waits = query_ps_waits(ps_stats["EVENT_ID"]);
-                        query_ps_stats = false;
-                      }
-                      RecordsetData *rdata = new RecordsetData();
-                      rdata->duration = statement_exec_timer.duration();
-                      rdata->ps_stat_error = query_ps_statement_events_error;
-                      rdata->ps_stat_info = ps_stats;
-                      rdata->ps_stage_info = ps_stages;
-                      rdata->ps_wait_info = ps_waits;
-                      rs->set_client_data(rdata);
-                    }
+                    RecordsetData *rdata = new RecordsetData();
+                    rdata->duration = statement_exec_timer.duration();
+                    rdata->ps_stat_error = query_ps_statement_events_error;
+                    rdata->trace_id = trace.id;
+                    rs->set_client_data(rdata);
 
                     rs->data_storage(data_storage);
                     rs->reset(true);
 
+                    // Streamed rows (prepared statements) are read in reset(), and the statement only ends on the
+                    // server after that. So the performance schema is queried only now.
+                    if (query_ps_stats) {
+                      query_ps_statistics(_usr_dbc_conn->id, ps_stats);
+                      ps_stages = query_ps_stages(ps_stats["EVENT_ID"]);
+                      ps_waits = query_ps_waits(ps_stats["EVENT_ID"]);
+                      query_ps_stats = false;
+
+                      // TIMER_WAIT is in picoseconds.
+                      if (ps_stats.find("TIMER_WAIT") != ps_stats.end())
+                        trace.split_server_time(ps_stats["TIMER_WAIT"] / 1000000);
+                    }
+                    rdata->ps_stat_info = ps_stats;
+                    rdata->ps_stage_info = ps_stages;
+                    rdata->ps_wait_info = ps_waits;
+                    data_storage->add_fetch_trace(trace);
+
                     if (data_storage->valid()) // query statement
                     {
                       if (result_list)
                         result_list->push_back(rs);
 
-                      if (editor)
+                      if (editor) {
+                        std::int64_t panel_start = QueryTrace::now();
                         editor->add_panel_for_recordset_from_main(rs);
+                        trace.add_span(QueryTrace::GridReady, panel_start, QueryTrace::now());
+                      }
 
                       std::string statement_res_msg = std::to_string(rs->row_count()) + _(" row(s) returned");
                       if (!last_statement_info->empty())
@@ -2338,7 +2459,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
                   ++total_result_count;
                   data_storage.reset();
                 }
-              } while ((more_results = dbc_statement->getMoreResults()));
+              } while ((more_results = !prepared_statement && dbc_statement->getMoreResults()));
             }
           }
 
@@ -2796,6 +2917,9 @@ void SqlEditorForm::apply_data_changes_commit(const std::string &sql_script_text
   int max_query_size_to_log = (int)bec::GRTManager::get()->get_app_option_int("DbSqlEditor:MaxQuerySizeToHistory", 0);
 
   Sql_script sql_script = sql_storage->sql_script_substitute();
+  // The single row statements of merged ones no longer match if the script was edited in the wizard.
+  if (sql_script_text != Recordset_sql_storage::statements_as_sql_script(sql_script.statements))
+    sql_script.merged_statements.clear();
   sql_script.statements.clear();
   SqlFacade::Ref sql_splitter = SqlFacade::instance_for_rdbms(rdbms());
   sql_splitter->splitSqlScript(sql_script_text, sql_script.statements);
@@ -2827,7 +2951,41 @@ void SqlEditorForm::schemaListRefreshed(std::vector<std::string> const &schemas)
   _databaseSymbols.clear(); // Doesn't clear the dependencies.
 
   for (auto schema : schemas) {
-    _databaseSymbols.addNewSymbol<SchemaSymbol>(nullptr, schema);
+    SchemaSymbol *schemaSymbol = _databaseSymbols.addNewSymbol<SchemaSymbol>(nullptr, schema);
+    if (_schema_meta_data_cache != nullptr)
+      loadCachedSchemaContent(schemaSymbol);
+  }
+
+  if (_schema_meta_data_cache != nullptr)
+    _schema_meta_data_cache->update_schema_list(schemas);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Fills the given schema symbol with what we stored in the schema meta data cache. Must be called with the
+ * symbols mutex locked.
+ */
+void SqlEditorForm::loadCachedSchemaContent(SchemaSymbol *schemaSymbol) {
+  for (auto &object : _schema_meta_data_cache->get_schema_objects(schemaSymbol->name)) {
+    ScopedSymbol *owner = nullptr;
+    switch (object.type) {
+      case SchemaMetaDataCache::Table:
+        owner = _databaseSymbols.addNewSymbol<TableSymbol>(schemaSymbol, object.name);
+        break;
+      case SchemaMetaDataCache::View:
+        owner = _databaseSymbols.addNewSymbol<ViewSymbol>(schemaSymbol, object.name);
+        break;
+      case SchemaMetaDataCache::Procedure:
+      case SchemaMetaDataCache::Function:
+        _databaseSymbols.addNewSymbol<StoredRoutineSymbol>(schemaSymbol, object.name, nullptr);
+        break;
+    }
+
+    if (owner != nullptr) {
+      for (auto &column : object.columns)
+        _databaseSymbols.addNewSymbol<ColumnSymbol>(owner, column, nullptr);
+    }
   }
 }
 
@@ -2886,70 +3044,167 @@ void SqlEditorForm::readStaticServerSymbols() {
 void SqlEditorForm::schema_meta_data_refreshed(const std::string &schema_name, base::StringListPtr tables,
                                                base::StringListPtr views, base::StringListPtr procedures,
                                                base::StringListPtr functions) {
-  std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
-  std::unique_ptr<sql::Statement> statement;
-  RecMutexLock usr_dbc_conn_mutex(ensure_valid_usr_connection());
-  if (_usr_dbc_conn->ref.get() != nullptr)
-    statement.reset(_usr_dbc_conn->ref->createStatement());
+  bool hasPerformanceSchema = false;
+  {
+    std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
+    auto schemaSymbols = _databaseSymbols.getSymbolsOfType<SchemaSymbol>();
+    hasPerformanceSchema = std::find_if(schemaSymbols.begin(), schemaSymbols.end(), [](auto symbol) -> bool {
+      return symbol->name == "performance_schema";
+    }) != schemaSymbols.end();
+  }
 
-  auto schemaSymbols = _databaseSymbols.getSymbolsOfType<SchemaSymbol>();
-  bool hasPerformanceSchema = std::find_if(schemaSymbols.begin(), schemaSymbols.end(), [](auto symbol) -> bool {
-    return symbol->name == "performance_schema";
-  }) != schemaSymbols.end();
+  std::map<std::string, SchemaMetaDataCache::Object> cachedObjects;
+  if (_schema_meta_data_cache != nullptr) {
+    for (auto &object : _schema_meta_data_cache->get_schema_objects(schema_name))
+      cachedObjects[object.name] = object;
+  }
 
-  for (SchemaSymbol *schemaSymbol : schemaSymbols) {
-    if (schemaSymbol->name == schema_name) {
-      schemaSymbol->clear();
-      for (auto table : *tables) {
-        TableSymbol *tableSymbol = _databaseSymbols.addNewSymbol<TableSymbol>(schemaSymbol, table);
+  // All server queries are done first, so the symbol table is only locked while it gets updated. They run on a
+  // meta data connection if there is one, otherwise on the aux connection, but never on the user connection.
+  SchemaMetaDataCache::ObjectList objects;
+  std::vector<std::string> userVariables;
+  size_t reusedCount = 0;
+  bool complete = false;
 
-        // Fetch column info for each table.
-        if (statement != nullptr) {
-          std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(
-            std::string(base::sqlstring("SHOW FULL COLUMNS FROM !.!", 0) << schema_name << table)));
+  sql::ConnectionPool::Lease lease;
+  if (_metadata_pool) {
+    try {
+      lease = _metadata_pool->acquire();
+    } catch (std::exception &exc) {
+      logWarning("Could not get a meta data connection, falling back to the aux connection: %s\n", exc.what());
+    }
+  }
 
-          while (rs->next()) {
-            _databaseSymbols.addNewSymbol<ColumnSymbol>(tableSymbol, rs->getString(1), nullptr);
-          }
-        }
+  try {
+    sql::Dbc_connection_handler::Ref conn = lease.connection();
+    std::unique_ptr<RecMutexLock> aux_dbc_conn_mutex;
+    if (!conn)
+      aux_dbc_conn_mutex.reset(new RecMutexLock(ensure_valid_aux_connection(conn)));
+
+    std::unique_ptr<sql::Statement> statement;
+    if (conn && conn->ref.get() != nullptr)
+      statement.reset(conn->ref->createStatement());
+
+    // Column lists are only re-read for tables and views whose change stamp differs from what we have cached
+    // from an earlier refresh. The stamp is a hash over the column definitions in I_S.COLUMNS, which (unlike the
+    // times in I_S.TABLES) also changes for instant/in-place DDL and isn't subject to the statistics cache.
+    // Stamps are also read on the first fill, so the cached objects have them for the next refresh.
+    std::map<std::string, std::string> stamps;
+    if (statement != nullptr && _schema_meta_data_cache != nullptr) {
+      try {
+        std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(std::string(
+          base::sqlstring("SELECT TABLE_NAME, CONCAT(COUNT(*), '/', "
+                          "BIT_XOR(CRC32(CONCAT_WS(':', ORDINAL_POSITION, COLUMN_NAME, COLUMN_TYPE)))) "
+                          "FROM information_schema.COLUMNS WHERE TABLE_SCHEMA = ? GROUP BY TABLE_NAME", 0)
+          << schema_name)));
+        while (rs->next())
+          stamps[rs->getString(1)] = rs->getString(2);
+      } catch (sql::SQLException &e) {
+        logWarning("Could not read change stamps for schema %s, reloading all columns: %s\n", schema_name.c_str(),
+                   e.what());
+        stamps.clear();
       }
+    }
 
-      for (auto view : *views) {
-        ViewSymbol *viewSymbol = _databaseSymbols.addNewSymbol<ViewSymbol>(schemaSymbol, view);
+    auto addColumns = [&](std::string const &name, SchemaMetaDataCache::ObjectType type) {
+      SchemaMetaDataCache::Object object;
+      object.name = name;
+      object.type = type;
+      auto stamp = stamps.find(name);
+      if (stamp != stamps.end())
+        object.stamp = stamp->second;
+
+      auto cached = cachedObjects.find(name);
+      if (cached != cachedObjects.end() && cached->second.type == type && !object.stamp.empty() &&
+          cached->second.stamp == object.stamp) {
+        object.columns = cached->second.columns;
+        ++reusedCount;
+      } else if (statement != nullptr) {
+        std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(
+          std::string(base::sqlstring("SHOW FULL COLUMNS FROM !.!", 0) << schema_name << name)));
+
+        while (rs->next())
+          object.columns.push_back(rs->getString(1));
+      }
+      objects.push_back(object);
+    };
 
-        // Same for each view.
-        if (statement != nullptr) {
-          std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(
-            std::string(base::sqlstring("SHOW FULL COLUMNS FROM !.!", 0) << schema_name << view)));
+    for (auto table : *tables)
+      addColumns(table, SchemaMetaDataCache::Table);
 
-          while (rs->next()) {
-            _databaseSymbols.addNewSymbol<ColumnSymbol>(viewSymbol, rs->getString(1), nullptr);
-          }
-        }
-      }
+    for (auto view : *views)
+      addColumns(view, SchemaMetaDataCache::View);
 
-      for (auto procedure : *procedures) {
-        _databaseSymbols.addNewSymbol<StoredRoutineSymbol>(schemaSymbol, procedure, nullptr);
-      }
+    if (statement != nullptr) {
+      auto metaInfo = conn->ref->getMetaData();
+      if (hasPerformanceSchema && (metaInfo->getDatabaseMajorVersion() > 7
+          || (metaInfo->getDatabaseMajorVersion() == 5 && metaInfo->getDatabaseMinorVersion() > 6))) {
+        std::unique_ptr<sql::ResultSet> rs(
+          statement->executeQuery("SELECT VARIABLE_NAME FROM performance_schema.user_variables_by_thread")
+        );
 
-      for (auto function : *functions) {
-        _databaseSymbols.addNewSymbol<StoredRoutineSymbol>(schemaSymbol, function, nullptr);
+        while (rs->next())
+          userVariables.push_back("@" + rs->getString(1));
       }
+    }
+    complete = statement != nullptr;
+  } catch (sql::SQLException &e) {
+    lease.discard();
+    logWarning("Could not load the columns of schema %s: %s\n", schema_name.c_str(), e.what());
+  }
+  lease = sql::ConnectionPool::Lease();
+
+  // Objects we didn't get to because of an error are still listed, just without columns.
+  std::set<std::string> loaded;
+  for (auto &object : objects)
+    loaded.insert(object.name);
+  for (auto table : *tables)
+    if (loaded.count(table) == 0)
+      objects.push_back({ table, SchemaMetaDataCache::Table, "", {} });
+  for (auto view : *views)
+    if (loaded.count(view) == 0)
+      objects.push_back({ view, SchemaMetaDataCache::View, "", {} });
+
+  for (auto procedure : *procedures)
+    objects.push_back({ procedure, SchemaMetaDataCache::Procedure, "", {} });
+  for (auto function : *functions)
+    objects.push_back({ function, SchemaMetaDataCache::Function, "", {} });
 
-      if (statement != nullptr) {
-        auto metaInfo = _usr_dbc_conn->ref->getMetaData();
-        if (hasPerformanceSchema && (metaInfo->getDatabaseMajorVersion() > 7
-            || (metaInfo->getDatabaseMajorVersion() == 5 && metaInfo->getDatabaseMinorVersion() > 6))) {
-          std::unique_ptr<sql::ResultSet> rs(
-            statement->executeQuery("SELECT VARIABLE_NAME FROM performance_schema.user_variables_by_thread")
-          );
+  // Incomplete results are not cached. The next refresh would otherwise take the missing columns as up to date.
+  if (_schema_meta_data_cache != nullptr && complete) {
+    _schema_meta_data_cache->store_schema_objects(schema_name, objects);
+    logDebug2("Schema %s: column lists of %lu of %lu tables/views taken from cache\n", schema_name.c_str(),
+              (unsigned long)reusedCount, (unsigned long)(tables->size() + views->size()));
+  }
+
+  std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
+  for (SchemaSymbol *schemaSymbol : _databaseSymbols.getSymbolsOfType<SchemaSymbol>()) {
+    if (schemaSymbol->name == schema_name) {
+      schemaSymbol->clear();
 
-          while (rs->next()) {
-            _databaseSymbols.addNewSymbol<UserVariableSymbol>(nullptr, "@" + rs->getString(1), nullptr);
+      for (auto &object : objects) {
+        switch (object.type) {
+          case SchemaMetaDataCache::Table:
+          case SchemaMetaDataCache::View: {
+            ScopedSymbol *owner;
+            if (object.type == SchemaMetaDataCache::Table)
+              owner = _databaseSymbols.addNewSymbol<TableSymbol>(schemaSymbol, object.name);
+            else
+              owner = _databaseSymbols.addNewSymbol<ViewSymbol>(schemaSymbol, object.name);
+            for (auto &column : object.columns)
+              _databaseSymbols.addNewSymbol<ColumnSymbol>(owner, column, nullptr);
+            break;
           }
+
+          default:
+            _databaseSymbols.addNewSymbol<StoredRoutineSymbol>(schemaSymbol, object.name, nullptr);
+            break;
         }
       }
 
+      for (auto &variable : userVariables)
+        _databaseSymbols.addNewSymbol<UserVariableSymbol>(nullptr, variable, nullptr);
+
       return;
     }
   }
@@ -34,6 +34,7 @@
 #include "grtpp_notifications.h"
 
 #include "sqlide/recordset_be.h"
+#include "sqlide/query_trace.h"
 #include "sqlide/sql_editor_be.h"
 #include "sqlide/db_sql_editor_log.h"
 #include "sqlide/db_sql_editor_history_be.h"
@@ -64,6 +65,7 @@ namespace bec {
 class QuerySidePalette;
 class SqlEditorTreeController;
 class ColumnWidthCache;
+class SchemaMetaDataCache;
 class SqlEditorPanel;
 class SqlEditorResult;
 
@@ -109,6 +111,7 @@ public:
     std::map<std::string, std::int64_t> ps_stat_info;
     std::vector<PSStage> ps_stage_info;
     std::vector<PSWait> ps_wait_info;
+    std::size_t trace_id = 0; // Entry in the query trace log.
   };
 
 public:
@@ -319,6 +322,9 @@ private:
 
 public:
   base::RecMutexLock ensure_valid_aux_connection(sql::Dbc_connection_handler::Ref &conn, bool lockOnly = false);
+  sql::ConnectionPool::Ref metadata_connection_pool() {
+    return _metadata_pool;
+  }
   parsers::MySQLParserContext::Ref work_parser_context() {
     return _work_parser_context;
   };
@@ -340,6 +346,9 @@ public:
   ColumnWidthCache *column_width_cache() {
     return _column_width_cache;
   }
+  QueryTraceLog &query_trace_log() {
+    return _query_trace_log;
+  }
 
   bool exec_editor_sql(SqlEditorPanel *editor, bool sync, bool current_statement_only = false,
                        bool wrap_with_non_std_delimiter = false, bool dont_add_limit_clause = false,
@@ -563,13 +572,19 @@ private:
 
   ServerState _last_server_running_state = UnknownState;
 
+  sql::ConnectionPool::Ref _metadata_pool; // Read only connections for parallel meta data queries, if enabled.
+  void create_metadata_pool();
+
   ColumnWidthCache *_column_width_cache = nullptr;
+  QueryTraceLog _query_trace_log; // Timelines of the most recently executed statements.
+  SchemaMetaDataCache *_schema_meta_data_cache = nullptr; // Code completion symbols from previous sessions.
 
   parsers::SymbolTable _staticServerSymbols; // Charsets, collations, engines.
   parsers::SymbolTable _databaseSymbols; // All available db objects reachable via the current connection.
 
   void activate_command(const std::string &command);
   void readStaticServerSymbols();
+  void loadCachedSchemaContent(parsers::SchemaSymbol *schemaSymbol);
 
   // workaround for managed code windows
   struct PrivateMutex;
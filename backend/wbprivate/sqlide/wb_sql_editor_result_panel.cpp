@@ -59,6 +59,7 @@
 #include "mforms/button.h"
 #include "mforms/selector.h"
 #include "mforms/textentry.h"
+#include "mforms/filechooser.h"
 
 #include <algorithm>
 
@@ -1030,6 +1031,94 @@ static std::string render_waits(std::vector<SqlEditorForm::PSWait> &waits) {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Renders the trace of a statement as a waterfall: one bar per phase, positioned on a common time axis.
+ */
+static std::string render_timeline(const QueryTrace &trace) {
+  std::string path = mforms::Utilities::get_special_folder(mforms::ApplicationData) + "/timeline.png";
+
+  const double label_width = 250, bar_width = 540, row_height = 22;
+  int ncolors = sizeof(colors) / sizeof(ColorDefinitions);
+  std::int64_t start = trace.start_time();
+  double total = std::max<double>(1, (double)(trace.end_time() - start));
+
+  cairo_surface_t *surf =
+    cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 800, (int)(trace.spans.size() * row_height + 10));
+  cairo_t *cr = cairo_create(surf);
+
+  cairo_set_font_size(cr, 12);
+  cairo_set_line_width(cr, 1);
+
+  double y = 5;
+  for (auto &span : trace.spans) {
+    int color = (int)span.phase % ncolors;
+    double x = label_width + (span.start - start) * bar_width / total;
+    double w = std::max(1.0, span.duration * bar_width / total);
+
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_move_to(cr, 5, y + 15);
+    if (span.duration == 0)
+      cairo_show_text(cr, base::strfmt("%s @ %.3fms", QueryTrace::phase_name(span.phase),
+                                       (span.start - start) / 1000.0).c_str());
+    else
+      cairo_show_text(cr, base::strfmt("%s - %.3fms", QueryTrace::phase_name(span.phase), span.duration / 1000.0)
+                            .c_str());
+
+    cairo_set_source_rgb(cr, colors[color].r, colors[color].g, colors[color].b);
+    if (span.duration == 0) {
+      // Instant event, draw a diamond.
+      cairo_move_to(cr, x, y + 3);
+      cairo_line_to(cr, x + 6, y + 10);
+      cairo_line_to(cr, x, y + 17);
+      cairo_line_to(cr, x - 6, y + 10);
+      cairo_close_path(cr);
+    } else
+      cairo_rectangle(cr, x, y + 3, w, 14);
+    cairo_fill(cr);
+
+    y += row_height;
+  }
+
+  cairo_set_source_rgba(cr, 0, 0, 0, 0.3);
+  cairo_move_to(cr, label_width - 0.5, 0);
+  cairo_line_to(cr, label_width - 0.5, y + 5);
+  cairo_stroke(cr);
+
+  cairo_surface_write_to_png(surf, path.c_str());
+  cairo_destroy(cr);
+  cairo_surface_destroy(surf);
+
+  return path;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Saves the timelines of the recently executed statements in Chrome trace format.
+ */
+void SqlEditorResult::export_query_traces() {
+  std::vector<QueryTrace> traces = _owner->owner()->query_trace_log().traces();
+  if (traces.empty())
+    return;
+
+  mforms::FileChooser dlg(mforms::SaveFile);
+  dlg.set_title(_("Export Query Timeline"));
+  dlg.set_extensions("Chrome Trace Files (*.json)|*.json", "json");
+  if (!dlg.run_modal())
+    return;
+
+  std::string path = dlg.get_path();
+  std::string data = QueryTraceLog::to_chrome_trace(traces);
+  GError *error = NULL;
+  if (!g_file_set_contents(path.c_str(), data.data(), (gssize)data.size(), &error)) {
+    mforms::Utilities::show_error(_("Export Query Timeline"),
+                                  strfmt(_("Could not save to file '%s': %s"), path.c_str(), error->message), _("OK"));
+    g_error_free(error);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void SqlEditorResult::create_query_stats_panel() {
   RETURN_IF_FAIL_TO_RETAIN_WEAK_PTR(Recordset, _rset, rs) {
     SqlEditorForm::RecordsetData *rsdata = dynamic_cast<SqlEditorForm::RecordsetData *>(rs->client_data());
@@ -1038,7 +1127,7 @@ void SqlEditorResult::create_query_stats_panel() {
     _query_stats_panel = mforms::manage(new mforms::ScrollPanel());
     mforms::Table *table = mforms::manage(new mforms::Table());
     table->set_padding(20);
-    table->set_row_count(6);
+    table->set_row_count(8);
     table->set_column_count(2);
     table->set_row_spacing(4);
 
@@ -1049,6 +1138,14 @@ void SqlEditorResult::create_query_stats_panel() {
     item->set_text("Query Statistics");
     tbar->add_item(item);
 
+    item = mforms::manage(new mforms::ToolBarItem(mforms::ActionItem));
+    item->set_name("Export Timeline");
+    item->setInternalName("export_timeline");
+    item->set_icon(mforms::App::get()->get_resource_path("record_export.png"));
+    item->set_tooltip(_("Export the timelines of recently executed statements in Chrome trace format"));
+    item->signal_activated()->connect(std::bind(&SqlEditorResult::export_query_traces, this));
+    tbar->add_item(item);
+
     add_switch_toggle_toolbar_item(tbar);
 
     _query_stats_box->add(tbar, false, true);
@@ -1172,6 +1269,24 @@ void SqlEditorResult::create_query_stats_panel() {
       table->add(image, 0, 2, 5, 6, mforms::HFillFlag | mforms::VFillFlag);
     }
 
+    for (auto &trace : _owner->owner()->query_trace_log().traces()) {
+      if (trace.id != rsdata->trace_id || trace.empty())
+        continue;
+
+      double total = (trace.end_time() - trace.start_time()) / 1000.0;
+      mforms::Label *l =
+        mforms::manage(new mforms::Label(strfmt("Execution Timeline (measured at client side, total %.3fms)", total)));
+      l->set_text_align(mforms::MiddleCenter);
+      l->set_style(mforms::BoldStyle);
+      table->add(l, 0, 2, 6, 7, mforms::HFillFlag);
+
+      std::string file = render_timeline(trace);
+      mforms::ImageBox *image = mforms::manage(new mforms::ImageBox());
+      image->set_image(file);
+      table->add(image, 0, 2, 7, 8, mforms::HFillFlag | mforms::VFillFlag);
+      break;
+    }
+
     _query_stats_panel->add(table);
 
     _query_stats_box->add(_query_stats_panel, true, true);
@@ -154,6 +154,7 @@ private:
   void switcher_collapsed();
 
   void create_query_stats_panel();
+  void export_query_traces();
   void create_column_info_panel();
   void create_spatial_view_panel_if_needed();
 
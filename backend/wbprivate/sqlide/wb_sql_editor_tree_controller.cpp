@@ -21,6 +21,7 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
  */
 
+#include <algorithm>
 #include <regex>
 
 #include "grtpp_util.h"
@@ -460,18 +461,55 @@ bool SqlEditorTreeController::fetch_schema_contents(
   bool sync = !bec::GRTManager::get()->in_main_thread();
   logDebug3("Fetch schema contents for %s\n", schema_name.c_str());
 
-  live_schema_fetch_task->exec(sync, std::bind(&SqlEditorTreeController::do_fetch_live_schema_contents, this,
-                                               weak_ptr_from(this), schema_name, arrived_slot));
+  // Object details batch loaded before are outdated now.
+  discard_details_batch(schema_name);
+
+  GrtThreadedTask::Ref task = sync ? live_schema_fetch_task : schema_fetch_task();
+  task->exec(sync, std::bind(&SqlEditorTreeController::do_fetch_live_schema_contents, this, weak_ptr_from(this),
+                             schema_name, arrived_slot));
 
   return true;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Returns the task to run the next schema content fetch in. Without a meta data connection pool all fetches are
+ * serialized in the live schema fetch task (they share the aux connection anyway). With a pool we keep one worker per
+ * pooled connection, so expanding several schemas loads them in parallel.
+ */
+GrtThreadedTask::Ref SqlEditorTreeController::schema_fetch_task() {
+  sql::ConnectionPool::Ref pool = _owner->metadata_connection_pool();
+  if (!pool)
+    return live_schema_fetch_task;
+
+  for (auto &task : _schema_fetch_tasks) {
+    if (!task->is_busy())
+      return task;
+  }
+
+  if (_schema_fetch_tasks.size() < pool->max_size()) {
+    GrtThreadedTask::Ref task = GrtThreadedTask::create();
+    task->desc("Live Schema Fetch Task " + std::to_string(_schema_fetch_tasks.size() + 1));
+    task->send_task_res_msg(false);
+    task->msg_cb(std::bind(&SqlEditorForm::add_log_message, _owner, std::placeholders::_1, std::placeholders::_2,
+                           std::placeholders::_3, ""));
+    _schema_fetch_tasks.push_back(task);
+    return task;
+  }
+
+  // All workers busy, queue the request round robin.
+  return _schema_fetch_tasks[_next_schema_fetch_task++ % _schema_fetch_tasks.size()];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void SqlEditorTreeController::refresh_live_object_in_overview(wb::LiveSchemaTree::ObjectType type,
                                                               const std::string schema_name,
                                                               const std::string old_obj_name,
                                                               const std::string new_obj_name) {
+  discard_details_batch(schema_name);
+
   try {
     // update schema tree even if no object was added/dropped, to clear details attribute which contents might to be
     // changed
@@ -492,35 +530,52 @@ grt::StringRef SqlEditorTreeController::do_fetch_live_schema_contents(
   std::weak_ptr<SqlEditorTreeController> self_ptr, const std::string &schema_name,
   wb::LiveSchemaTree::NewSchemaContentArrivedSlot arrived_slot) {
   RETVAL_IF_FAIL_TO_RETAIN_WEAK_PTR(SqlEditorTreeController, self_ptr, self, grt::StringRef(""))
+
   try {
     StringListPtr tables(new std::list<std::string>());
     StringListPtr views(new std::list<std::string>());
     StringListPtr procedures(new std::list<std::string>());
     StringListPtr functions(new std::list<std::string>());
 
-    MutexLock schema_contents_mutex(_schema_contents_mutex);
-    if (!arrived_slot)
-      return grt::StringRef("");
-
+    // Use a pooled connection if available. That allows several schemas to load at the same time.
+    // The lease is only held for the queries below, schema_meta_data_refreshed() gets its own connection.
     {
-      sql::Dbc_connection_handler::Ref conn;
-      RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
-      std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      sql::ConnectionPool::Lease lease;
+      sql::ConnectionPool::Ref pool = _owner->metadata_connection_pool();
+      if (pool) {
+        try {
+          lease = pool->acquire();
+        } catch (std::exception &exc) {
+          logWarning("Could not get a meta data connection, falling back to the aux connection: %s\n", exc.what());
+        }
+      }
 
-      {
+      std::unique_ptr<MutexLock> schema_contents_mutex;
+      if (!lease.connection())
+        schema_contents_mutex.reset(new MutexLock(_schema_contents_mutex));
+      if (!arrived_slot)
+        return grt::StringRef("");
+
+      try {
+        sql::Dbc_connection_handler::Ref conn = lease.connection();
+        std::unique_ptr<RecMutexLock> aux_dbc_conn_mutex;
+        if (!conn)
+          aux_dbc_conn_mutex.reset(new RecMutexLock(_owner->ensure_valid_aux_connection(conn)));
         std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
-        std::unique_ptr<sql::ResultSet> rs(
-          stmt->executeQuery(std::string(sqlstring("SHOW FULL TABLES FROM !", 0) << schema_name)));
-        while (rs->next()) {
-          std::string name = rs->getString(1);
-          std::string type = rs->getString(2);
 
-          if (type == "VIEW")
-            views->push_back(name);
-          else
-            tables->push_back(name);
+        {
+          std::unique_ptr<sql::ResultSet> rs(
+            stmt->executeQuery(std::string(sqlstring("SHOW FULL TABLES FROM !", 0) << schema_name)));
+          while (rs->next()) {
+            std::string name = rs->getString(1);
+            std::string type = rs->getString(2);
+
+            if (type == "VIEW")
+              views->push_back(name);
+            else
+              tables->push_back(name);
+          }
         }
-      }
         {
           std::unique_ptr<sql::ResultSet> rs(
             stmt->executeQuery(std::string(sqlstring("SHOW PROCEDURE STATUS WHERE Db=?", 0) << schema_name)));
@@ -538,6 +593,10 @@ grt::StringRef SqlEditorTreeController::do_fetch_live_schema_contents(
             functions->push_back(name);
           }
         }
+      } catch (const sql::SQLException &) {
+        lease.discard();
+        throw;
+      }
     }
 
     if (arrived_slot) {
@@ -649,6 +708,290 @@ grt::StringRef SqlEditorTreeController::do_fetch_data_for_filter(
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Returns the details batch for the given schema if the data for the given flag (one of the LiveSchemaTree *_DATA
+ * values) was loaded by load_details_batch(). Returns nullptr if the schema has to be handled object by object.
+ * Must be called with _details_batch_mutex locked.
+ */
+SqlEditorTreeController::SchemaDetailsBatch *SqlEditorTreeController::get_details_batch(const std::string &schema_name,
+                                                                                        short flag) {
+  auto batch = _details_batches.find(schema_name);
+  if (batch == _details_batches.end() || batch->second.disabled || (batch->second.loaded_mask & flag) == 0)
+    return nullptr;
+  return &batch->second;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Makes sure the data for the given flag is loaded into the details batch of the schema. The queries run without
+ * _details_batch_mutex being held, so the UI isn't blocked by them when it discards a batch. If the batch is discarded
+ * meanwhile the result is dropped.
+ */
+void SqlEditorTreeController::load_details_batch(const std::string &schema_name, short flag) {
+  SchemaDetailsBatch loaded;
+  size_t generation;
+  {
+    MutexLock lock(_details_batch_mutex);
+    SchemaDetailsBatch &batch = _details_batches[schema_name];
+    if (batch.disabled || (batch.loaded_mask & flag) != 0)
+      return;
+    loaded.memory_size = batch.memory_size;
+    generation = _details_batch_generation;
+  }
+
+  size_t initial_size = loaded.memory_size;
+  try {
+    read_details_batch(schema_name, flag, loaded);
+  } catch (const sql::SQLException &exc) {
+    logWarning("Error batch loading object details for schema '%s', falling back to single object queries: %s\n",
+               schema_name.c_str(), exc.what());
+    loaded.disabled = true;
+  }
+
+  MutexLock lock(_details_batch_mutex);
+  auto entry = _details_batches.find(schema_name);
+  if (generation != _details_batch_generation || entry == _details_batches.end())
+    return;
+
+  SchemaDetailsBatch &batch = entry->second;
+  if (batch.disabled || (batch.loaded_mask & flag) != 0)
+    return;
+
+  if (!loaded.disabled) {
+    switch (flag) {
+      case LiveSchemaTree::COLUMN_DATA:
+        batch.columns.swap(loaded.columns);
+        break;
+      case LiveSchemaTree::INDEX_DATA:
+        batch.indexes.swap(loaded.indexes);
+        break;
+      case LiveSchemaTree::TRIGGER_DATA:
+        batch.triggers.swap(loaded.triggers);
+        break;
+      case LiveSchemaTree::FK_DATA:
+        batch.foreign_keys.swap(loaded.foreign_keys);
+        break;
+    }
+    batch.loaded_mask |= flag;
+    batch.memory_size += loaded.memory_size - initial_size;
+
+    size_t memory_limit =
+      (size_t)bec::GRTManager::get()->get_app_option_int("DbSqlEditor:SchemaTreeBatchMemoryLimit", 16) * 1024 * 1024;
+    if (memory_limit > 0 && batch.memory_size > memory_limit) {
+      logInfo("Object details for schema '%s' exceed the batch memory limit, loading them per object\n",
+              schema_name.c_str());
+      loaded.disabled = true;
+    }
+  }
+
+  if (loaded.disabled) {
+    batch.disabled = true;
+    batch.columns.clear();
+    batch.indexes.clear();
+    batch.triggers.clear();
+    batch.foreign_keys.clear();
+    batch.memory_size = 0;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlEditorTreeController::read_details_batch(const std::string &schema_name, short flag,
+                                                 SchemaDetailsBatch &batch) {
+  size_t memory_limit =
+    (size_t)bec::GRTManager::get()->get_app_option_int("DbSqlEditor:SchemaTreeBatchMemoryLimit", 16) * 1024 * 1024;
+
+  sql::Dbc_connection_handler::Ref conn;
+  RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
+  std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
+
+  logDebug3("Batch loading object details (%i) for schema %s\n", flag, schema_name.c_str());
+
+  // Rough estimate of what an entry costs, to enforce the per schema memory limit.
+  auto account = [&](size_t size) {
+    batch.memory_size += size + 64;
+    if (memory_limit > 0 && batch.memory_size > memory_limit) {
+      logInfo("Object details for schema '%s' exceed the batch memory limit, loading them per object\n",
+              schema_name.c_str());
+      batch.disabled = true;
+    }
+    return !batch.disabled;
+  };
+
+  switch (flag) {
+    case LiveSchemaTree::COLUMN_DATA: {
+      std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(std::string(
+        base::sqlstring("SELECT TABLE_NAME, COLUMN_NAME, COLUMN_TYPE, COLLATION_NAME, IS_NULLABLE, COLUMN_KEY, "
+                        "COLUMN_DEFAULT, EXTRA FROM information_schema.COLUMNS WHERE TABLE_SCHEMA = ? "
+                        "ORDER BY TABLE_NAME, ORDINAL_POSITION",
+                        0)
+        << schema_name)));
+
+      while (rs->next()) {
+        LiveSchemaTree::ColumnData column;
+        column.name = rs->getString(2);
+
+        std::string type = rs->getString(3);
+        std::string nullable = rs->getString(5);
+        std::string key = rs->getString(6);
+        base::replaceStringInplace(type, "unsigned", "UN");
+        if (rs->getString(8) == "auto_increment")
+          type += " AI";
+
+        column.type = type;
+        column.charset_collation = rs->isNull(4) ? "" : rs->getString(4);
+        column.is_pk = key == "PRI";
+        column.is_id = (column.is_pk || (nullable == "NO" && key == "UNI"));
+        column.is_idx = key != "";
+        column.default_value = rs->getString(7);
+
+        if (!account(column.name.size() + column.type.size() + column.default_value.size()))
+          return;
+        batch.columns[rs->getString(1)].push_back({ column.name, column });
+      }
+      break;
+    }
+
+    case LiveSchemaTree::INDEX_DATA: {
+      bool supportVisibility =
+        _owner->rdbms_version().is_valid() && is_supported_mysql_version_at_least(_owner->rdbms_version(), 8, 0, 0);
+
+      // No ORDER BY: the rows come in index definition order, like from SHOW INDEX (which loads a single table).
+      // Sorting by index name would change the order in which the indexes are listed.
+      std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(std::string(
+        base::sqlstring(supportVisibility
+                          ? "SELECT TABLE_NAME, NON_UNIQUE, INDEX_NAME, COLUMN_NAME, INDEX_TYPE, IS_VISIBLE "
+                            "FROM information_schema.STATISTICS WHERE TABLE_SCHEMA = ?"
+                          : "SELECT TABLE_NAME, NON_UNIQUE, INDEX_NAME, COLUMN_NAME, INDEX_TYPE "
+                            "FROM information_schema.STATISTICS WHERE TABLE_SCHEMA = ?",
+                        0)
+        << schema_name)));
+
+      while (rs->next()) {
+        auto &indexes = batch.indexes[rs->getString(1)];
+        std::string name = rs->getString(3);
+
+        // Group the columns per index, keeping the server order of both indexes and columns.
+        auto index = std::find_if(indexes.begin(), indexes.end(),
+                                  [&name](const std::pair<std::string, LiveSchemaTree::IndexData> &entry) {
+                                    return entry.first == name;
+                                  });
+        if (index == indexes.end()) {
+          LiveSchemaTree::IndexData index_data;
+          index_data.type = wb::LiveSchemaTree::internalize_token(rs->getString(5));
+          index_data.unique = (rs->getInt(2) == 0);
+          if (supportVisibility)
+            index_data.visible = rs->getString(6) == "YES";
+          indexes.push_back({ name, index_data });
+          index = indexes.end() - 1;
+        }
+
+        std::string column = rs->getString(4);
+        if (!account(name.size() + column.size()))
+          return;
+        index->second.columns.push_back(column);
+      }
+      break;
+    }
+
+    case LiveSchemaTree::TRIGGER_DATA: {
+      std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(std::string(
+        base::sqlstring("SELECT EVENT_OBJECT_TABLE, TRIGGER_NAME, EVENT_MANIPULATION, ACTION_TIMING "
+                        "FROM information_schema.TRIGGERS WHERE EVENT_OBJECT_SCHEMA = ? "
+                        "ORDER BY EVENT_OBJECT_TABLE, TRIGGER_NAME",
+                        0)
+        << schema_name)));
+
+      while (rs->next()) {
+        LiveSchemaTree::TriggerData trigger_data;
+        std::string name = rs->getString(2);
+        trigger_data.event_manipulation = wb::LiveSchemaTree::internalize_token(rs->getString(3));
+        trigger_data.timing = wb::LiveSchemaTree::internalize_token(rs->getString(4));
+
+        if (!account(name.size()))
+          return;
+        batch.triggers[rs->getString(1)].push_back({ name, trigger_data });
+      }
+      break;
+    }
+
+    case LiveSchemaTree::FK_DATA: {
+      std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(std::string(
+        base::sqlstring("SELECT rc.TABLE_NAME, rc.CONSTRAINT_NAME, rc.UNIQUE_CONSTRAINT_SCHEMA, "
+                        "rc.REFERENCED_TABLE_NAME, rc.UPDATE_RULE, rc.DELETE_RULE, kcu.COLUMN_NAME, "
+                        "kcu.REFERENCED_COLUMN_NAME FROM information_schema.REFERENTIAL_CONSTRAINTS rc "
+                        "JOIN information_schema.KEY_COLUMN_USAGE kcu ON kcu.CONSTRAINT_SCHEMA = rc.CONSTRAINT_SCHEMA "
+                        "AND kcu.TABLE_NAME = rc.TABLE_NAME AND kcu.CONSTRAINT_NAME = rc.CONSTRAINT_NAME "
+                        "WHERE rc.CONSTRAINT_SCHEMA = ? "
+                        "ORDER BY rc.TABLE_NAME, rc.CONSTRAINT_NAME, kcu.ORDINAL_POSITION",
+                        0)
+        << schema_name)));
+
+      while (rs->next()) {
+        auto &foreign_keys = batch.foreign_keys[rs->getString(1)];
+        std::string name = rs->getString(2);
+        std::string from_col = rs->getString(7);
+        std::string to_col = rs->getString(8);
+
+        if (foreign_keys.empty() || foreign_keys.back().first != name) {
+          LiveSchemaTree::FKData fk_data;
+          std::string ref_schema = rs->getString(3);
+          fk_data.referenced_table = ref_schema == schema_name ? rs->getString(4) : ref_schema + "." + rs->getString(4);
+          fk_data.update_rule = wb::LiveSchemaTree::internalize_token(rs->getString(5));
+          fk_data.delete_rule = wb::LiveSchemaTree::internalize_token(rs->getString(6));
+          fk_data.from_cols = from_col;
+          fk_data.to_cols = to_col;
+          foreign_keys.push_back({ name, fk_data });
+        } else {
+          foreign_keys.back().second.from_cols.append(", ").append(from_col);
+          foreign_keys.back().second.to_cols.append(", ").append(to_col);
+        }
+
+        if (!account(name.size() + from_col.size() + to_col.size()))
+          return;
+      }
+      break;
+    }
+  }
+
+  batch.loaded_mask |= flag;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlEditorTreeController::discard_details_batch(const std::string &schema_name) {
+  MutexLock lock(_details_batch_mutex);
+  ++_details_batch_generation;
+  if (schema_name.empty())
+    _details_batches.clear();
+  else
+    _details_batches.erase(schema_name);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Copies the batch loaded details of one object into the structures used to fill the tree.
+ * Returns false if the batch has no entry for that object and require_entry is set.
+ */
+template <class T>
+static bool copy_batched_details(const std::map<std::string, std::vector<std::pair<std::string, T> > > &source,
+                                 const std::string &obj_name, std::list<std::string> &names,
+                                 std::map<std::string, T> &data, bool require_entry) {
+  auto entry = source.find(obj_name);
+  if (entry == source.end())
+    return !require_entry;
+
+  for (auto &item : entry->second) {
+    names.push_back(item.first);
+    data[item.first] = item.second;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void SqlEditorTreeController::fetch_column_data(const std::string &schema_name, const std::string &obj_name,
                                                 wb::LiveSchemaTree::ObjectType type,
                                                 const wb::LiveSchemaTree::NodeChildrenUpdaterSlot &updater_slot) {
@@ -666,41 +1009,52 @@ void SqlEditorTreeController::fetch_column_data(const std::string &schema_name,
   logDebug3("Fetching column data for %s.%s\n", schema_name.c_str(), obj_name.c_str());
 
   try {
-    sql::Dbc_connection_handler::Ref conn;
+    bool batched = false;
+    load_details_batch(schema_name, LiveSchemaTree::COLUMN_DATA);
+    {
+      MutexLock lock(_details_batch_mutex);
+      if (SchemaDetailsBatch *batch = get_details_batch(schema_name, LiveSchemaTree::COLUMN_DATA))
+        batched = copy_batched_details(batch->columns, obj_name, *columns, column_data, true);
+    }
 
-    RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
+    // Objects missing in the batch (e.g. broken views) are queried directly, which also gives us the error.
+    if (!batched) {
+      sql::Dbc_connection_handler::Ref conn;
 
-    std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
-    std::unique_ptr<sql::ResultSet> rs(
-      stmt->executeQuery(std::string(base::sqlstring("SHOW FULL COLUMNS FROM !.!", 0) << schema_name << obj_name)));
+      RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
 
-    while (rs->next()) {
-      LiveSchemaTree::ColumnData col_node(type);
-      std::string column_name = rs->getString(1);
+      std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      std::unique_ptr<sql::ResultSet> rs(
+        stmt->executeQuery(std::string(base::sqlstring("SHOW FULL COLUMNS FROM !.!", 0) << schema_name << obj_name)));
+
+      while (rs->next()) {
+        LiveSchemaTree::ColumnData col_node(type);
+        std::string column_name = rs->getString(1);
 
-      columns->push_back(column_name);
+        columns->push_back(column_name);
 
-      std::string type = rs->getString(2);
-      std::string collation = rs->isNull(3) ? "" : rs->getString(3);
-      std::string nullable = rs->getString(4);
-      std::string key = rs->getString(5);
-      std::string default_value = rs->getString(6);
-      std::string extra = rs->getString(7);
+        std::string type = rs->getString(2);
+        std::string collation = rs->isNull(3) ? "" : rs->getString(3);
+        std::string nullable = rs->getString(4);
+        std::string key = rs->getString(5);
+        std::string default_value = rs->getString(6);
+        std::string extra = rs->getString(7);
 
-      base::replaceStringInplace(type, "unsigned", "UN");
+        base::replaceStringInplace(type, "unsigned", "UN");
 
-      if (extra == "auto_increment")
-        type += " AI";
+        if (extra == "auto_increment")
+          type += " AI";
 
-      col_node.name = column_name;
-      col_node.type = type;
-      col_node.charset_collation = collation;
-      col_node.is_pk = key == "PRI";
-      col_node.is_id = (col_node.is_pk || (nullable == "NO" && key == "UNI"));
-      col_node.is_idx = key != "";
-      col_node.default_value = default_value;
+        col_node.name = column_name;
+        col_node.type = type;
+        col_node.charset_collation = collation;
+        col_node.is_pk = key == "PRI";
+        col_node.is_id = (col_node.is_pk || (nullable == "NO" && key == "UNI"));
+        col_node.is_idx = key != "";
+        col_node.default_value = default_value;
 
-      column_data[column_name] = col_node;
+        column_data[column_name] = col_node;
+      }
     }
 
     // If information was found, creates the TreeNode structure for it
@@ -769,23 +1123,33 @@ void SqlEditorTreeController::fetch_trigger_data(const std::string &schema_name,
   std::map<std::string, LiveSchemaTree::TriggerData> trigger_data_dict;
 
   try {
-    sql::Dbc_connection_handler::Ref conn;
+    bool batched = false;
+    load_details_batch(schema_name, LiveSchemaTree::TRIGGER_DATA);
+    {
+      MutexLock lock(_details_batch_mutex);
+      if (SchemaDetailsBatch *batch = get_details_batch(schema_name, LiveSchemaTree::TRIGGER_DATA))
+        batched = copy_batched_details(batch->triggers, obj_name, *triggers, trigger_data_dict, false);
+    }
 
-    RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
+    if (!batched) {
+      sql::Dbc_connection_handler::Ref conn;
 
-    std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
-    std::unique_ptr<sql::ResultSet> rs(
-      stmt->executeQuery(std::string(base::sqlstring("SHOW TRIGGERS FROM ! LIKE ?", 0) << schema_name << obj_name)));
+      RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
 
-    while (rs->next()) {
-      wb::LiveSchemaTree::TriggerData trigger_node;
+      std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      std::unique_ptr<sql::ResultSet> rs(
+        stmt->executeQuery(std::string(base::sqlstring("SHOW TRIGGERS FROM ! LIKE ?", 0) << schema_name << obj_name)));
 
-      std::string name = rs->getString(1);
-      trigger_node.event_manipulation = wb::LiveSchemaTree::internalize_token(rs->getString(2));
-      trigger_node.timing = wb::LiveSchemaTree::internalize_token(rs->getString(5));
+      while (rs->next()) {
+        wb::LiveSchemaTree::TriggerData trigger_node;
+
+        std::string name = rs->getString(1);
+        trigger_node.event_manipulation = wb::LiveSchemaTree::internalize_token(rs->getString(2));
+        trigger_node.timing = wb::LiveSchemaTree::internalize_token(rs->getString(5));
 
-      triggers->push_back(name);
-      trigger_data_dict[name] = trigger_node;
+        triggers->push_back(name);
+        trigger_data_dict[name] = trigger_node;
+      }
     }
 
     // If information was found, creates the TreeNode structure for it
@@ -827,36 +1191,46 @@ void SqlEditorTreeController::fetch_index_data(const std::string &schema_name, c
   std::map<std::string, LiveSchemaTree::IndexData> index_data_dict;
 
   try {
-    sql::Dbc_connection_handler::Ref conn;
+    bool batched = false;
+    load_details_batch(schema_name, LiveSchemaTree::INDEX_DATA);
+    {
+      MutexLock lock(_details_batch_mutex);
+      if (SchemaDetailsBatch *batch = get_details_batch(schema_name, LiveSchemaTree::INDEX_DATA))
+        batched = copy_batched_details(batch->indexes, obj_name, *indexes, index_data_dict, false);
+    }
 
-    RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
+    if (!batched) {
+      sql::Dbc_connection_handler::Ref conn;
 
-    std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
-    std::unique_ptr<sql::ResultSet> rs(
-      stmt->executeQuery(std::string(base::sqlstring("SHOW INDEXES FROM !.!", 0) << schema_name << obj_name)));
+      RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
 
-    bool supportVisibility = _owner->rdbms_version().is_valid() && is_supported_mysql_version_at_least(_owner->rdbms_version(), 8, 0, 0);
+      std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      std::unique_ptr<sql::ResultSet> rs(
+        stmt->executeQuery(std::string(base::sqlstring("SHOW INDEXES FROM !.!", 0) << schema_name << obj_name)));
 
-    while (rs->next()) {
-      LiveSchemaTree::IndexData index_data;
+      bool supportVisibility = _owner->rdbms_version().is_valid() && is_supported_mysql_version_at_least(_owner->rdbms_version(), 8, 0, 0);
+
+      while (rs->next()) {
+        LiveSchemaTree::IndexData index_data;
 
-      std::string name = rs->getString(3);
+        std::string name = rs->getString(3);
 
-      // Inserts the index to the list
-      if (!index_data_dict.count(name)) {
-        indexes->push_back(name);
+        // Inserts the index to the list
+        if (!index_data_dict.count(name)) {
+          indexes->push_back(name);
 
-        index_data.type = wb::LiveSchemaTree::internalize_token(rs->getString(11));
-        index_data.unique = (rs->getInt(2) == 0);
-        if (supportVisibility) {
-          index_data.visible = rs->getString(14) == "YES";
+          index_data.type = wb::LiveSchemaTree::internalize_token(rs->getString(11));
+          index_data.unique = (rs->getInt(2) == 0);
+          if (supportVisibility) {
+            index_data.visible = rs->getString(14) == "YES";
+          }
+
+          index_data_dict[name] = index_data;
         }
 
-        index_data_dict[name] = index_data;
+        // Adds the column
+        index_data_dict[name].columns.push_back(rs->getString(5));
       }
-
-      // Adds the column
-      index_data_dict[name].columns.push_back(rs->getString(5));
     }
 
     // Searches for the target node...
@@ -893,16 +1267,26 @@ void SqlEditorTreeController::fetch_foreign_key_data(const std::string &schema_n
   StringListPtr foreign_keys(new std::list<std::string>());
   std::map<std::string, LiveSchemaTree::FKData> fk_data_dict;
 
-  sql::Dbc_connection_handler::Ref conn;
-
-  RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
-
   try {
-    std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
-    std::unique_ptr<sql::ResultSet> rs(
-      stmt->executeQuery(std::string(base::sqlstring("SHOW CREATE TABLE !.!", 0) << schema_name << obj_name)));
+    bool batched = false;
+    load_details_batch(schema_name, LiveSchemaTree::FK_DATA);
+    {
+      MutexLock lock(_details_batch_mutex);
+      if (SchemaDetailsBatch *batch = get_details_batch(schema_name, LiveSchemaTree::FK_DATA))
+        batched = copy_batched_details(batch->foreign_keys, obj_name, *foreign_keys, fk_data_dict, false);
+    }
 
-    while (rs->next()) {
+    sql::Dbc_connection_handler::Ref conn;
+    std::unique_ptr<RecMutexLock> aux_dbc_conn_mutex;
+    std::unique_ptr<sql::Statement> stmt;
+    std::unique_ptr<sql::ResultSet> rs;
+    if (!batched) {
+      aux_dbc_conn_mutex.reset(new RecMutexLock(_owner->ensure_valid_aux_connection(conn)));
+      stmt.reset(conn->ref->createStatement());
+      rs.reset(stmt->executeQuery(std::string(base::sqlstring("SHOW CREATE TABLE !.!", 0) << schema_name << obj_name)));
+    }
+
+    while (rs && rs->next()) {
       std::string statement = rs->getString(2);
 
       size_t def_start = statement.find("(");
@@ -2414,6 +2798,7 @@ grt::StringRef SqlEditorTreeController::do_refresh_schema_tree_safe(SqlEditorFor
     return grt::StringRef("");
 
   _is_refreshing_schema_tree = true;
+  discard_details_batch("");
   StringListPtr schema_list(new std::list<std::string>());
 
   std::vector<std::string> schemaList = fetch_schema_list();
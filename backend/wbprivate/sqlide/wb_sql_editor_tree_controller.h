@@ -87,6 +87,8 @@ private:
   wb::LiveSchemaTree _filtered_schema_tree;
   base::Mutex _schema_contents_mutex;
   GrtThreadedTask::Ref live_schema_fetch_task;
+  std::vector<GrtThreadedTask::Ref> _schema_fetch_tasks; // Parallel workers, used with the meta data connection pool.
+  size_t _next_schema_fetch_task = 0;
   GrtThreadedTask::Ref live_schemata_refresh_task;
   bool _is_refreshing_schema_tree;
 
@@ -128,6 +130,7 @@ public:
                                     std::string algorithm, std::string lock);
 
 private:
+  GrtThreadedTask::Ref schema_fetch_task();
   grt::StringRef do_fetch_live_schema_contents(std::weak_ptr<SqlEditorTreeController> self_ptr,
                                                const std::string &schema_name,
                                                wb::LiveSchemaTree::NewSchemaContentArrivedSlot arrived_slot);
@@ -145,6 +148,29 @@ private:
                               wb::LiveSchemaTree::ObjectType type,
                               const wb::LiveSchemaTree::NodeChildrenUpdaterSlot &updater_slot);
 
+  // Column, index, trigger and foreign key data for all tables and views of a schema, read with one set based
+  // INFORMATION_SCHEMA query per kind instead of one SHOW statement per object. Kept until the schema is refreshed.
+  struct SchemaDetailsBatch {
+    template <class T>
+    using ObjectDetails = std::map<std::string, std::vector<std::pair<std::string, T> > >;
+
+    short loaded_mask = 0;
+    bool disabled = false; // Too big for the memory limit or not readable. Objects are then loaded one by one.
+    size_t memory_size = 0;
+    ObjectDetails<wb::LiveSchemaTree::ColumnData> columns;
+    ObjectDetails<wb::LiveSchemaTree::IndexData> indexes;
+    ObjectDetails<wb::LiveSchemaTree::TriggerData> triggers;
+    ObjectDetails<wb::LiveSchemaTree::FKData> foreign_keys;
+  };
+  base::Mutex _details_batch_mutex;
+  std::map<std::string, SchemaDetailsBatch> _details_batches;
+  size_t _details_batch_generation = 0; // Incremented whenever batches are discarded.
+
+  SchemaDetailsBatch *get_details_batch(const std::string &schema_name, short flag);
+  void load_details_batch(const std::string &schema_name, short flag);
+  void read_details_batch(const std::string &schema_name, short flag, SchemaDetailsBatch &batch);
+  void discard_details_batch(const std::string &schema_name);
+
   grt::StringRef do_fetch_data_for_filter(std::weak_ptr<SqlEditorTreeController> self_ptr,
                                           const std::string &schema_filter, const std::string &object_filter,
                                           wb::LiveSchemaTree::NewSchemaContentArrivedSlot arrived_slot);
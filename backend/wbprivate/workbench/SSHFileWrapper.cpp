@@ -25,10 +25,18 @@
 #include "SSHFileWrapper.h"
 #include "base/log.h"
 
+#include <algorithm>
+
 DEFAULT_LOG_DOMAIN("SSHFileWrapper")
 
+// Size of the read-ahead buffer and of the blocks read backwards when looking for the last lines of a file.
+static const std::size_t ReadAheadSize = 64 * 1024;
+
+// Servers don't return more than this in a single reply anyway.
+static const std::size_t MaxReadSize = 255 * 1024;
+
 ssh::SSHFileWrapper::SSHFileWrapper(std::shared_ptr<ssh::SSHSession> session, std::shared_ptr<SSHSftp> ftp, const std::string &path, const std::size_t maxFileLimit)
-    : _session(session), _sftp(ftp), _maxFileLimit(maxFileLimit), _path(path) {
+    : _session(session), _sftp(ftp), _maxFileLimit(maxFileLimit), _path(path), _bufferStart(0), _bufferPos(0) {
   _file = _sftp->open(path);
   logDebug3("Open file: %s\n", _path.c_str());
 }
@@ -39,43 +47,87 @@ ssh::SSHFileWrapper::~SSHFileWrapper() {
   sftp_close(_file);
 }
 
+std::size_t ssh::SSHFileWrapper::fillBuffer(std::size_t minimum) {
+  // Drop what was consumed already, the remote position is always at the end of the buffer.
+  _bufferStart += _bufferPos;
+  _buffer.erase(0, _bufferPos);
+  _bufferPos = 0;
+
+  std::size_t size = _buffer.size();
+  _buffer.resize(size + std::min(std::max(minimum, ReadAheadSize), MaxReadSize));
+  ssize_t nBytes = sftp_read(_file, &_buffer[size], _buffer.size() - size);
+  if (nBytes < 0) {
+    _buffer.resize(size);
+    throw SSHSftpException(ssh_get_error(_file->sftp->session));
+  }
+  _buffer.resize(size + nBytes);
+
+  return nBytes;
+}
+
+void ssh::SSHFileWrapper::doSeek(uint64_t offset) {
+  if (offset >= _bufferStart && offset <= _bufferStart + _buffer.size()) {
+    _bufferPos = offset - _bufferStart;
+    return;
+  }
+
+  if (sftp_seek64(_file, offset) < 0)
+    throw SSHSftpException(ssh_get_error(_file->sftp->session));
+  _buffer.clear();
+  _bufferStart = offset;
+  _bufferPos = 0;
+}
+
+std::string ssh::SSHFileWrapper::doRead(std::size_t length) {
+  // A single sftp_read() may return less than requested, so keep reading until we have enough or hit the end.
+  std::string result;
+  while (result.size() < length) {
+    if (_bufferPos == _buffer.size() && fillBuffer(length - result.size()) == 0)
+      break;
+
+    std::size_t count = std::min(length - result.size(), _buffer.size() - _bufferPos);
+    result.append(_buffer, _bufferPos, count);
+    _bufferPos += count;
+  }
+
+  return result;
+}
+
+uint64_t ssh::SSHFileWrapper::fileSize() {
+  sftp_attributes info = sftp_fstat(_file);
+  if (info == nullptr)
+    throw SSHSftpException(ssh_get_error(_file->sftp->session));
+
+  uint64_t size = info->size;
+  sftp_attributes_free(info);
+  return size;
+}
+
 grt::StringRef ssh::SSHFileWrapper::getPath() {
   return _path;
 }
 
 grt::StringRef ssh::SSHFileWrapper::read(const size_t length) {
   auto lock = _session->lockSession();
-  std::vector<char> buffer;
-  logDebug3("Resizing read buffer: %zu\n", length);
-  buffer.resize(length);
-  ssize_t nBytes = sftp_read(_file, buffer.data(), buffer.size());
-  if (nBytes < 0)
-    throw SSHSftpException(ssh_get_error(_file->sftp->session));
-
-  std::string buff;
-  buff.append(buffer.data(), nBytes);
-
-  return buff;
+  logDebug3("Reading %zu bytes\n", length);
+  return doRead(length);
 }
 
 grt::StringRef ssh::SSHFileWrapper::readline() {
   auto lock = _session->lockSession();
   std::string buff;
-  size_t bytesCount = 0;
-  char buffer;
   while (true) {
-    ssize_t nBytes = sftp_read(_file, &buffer, 1);
-    if (nBytes == 0)
+    if (_bufferPos == _buffer.size() && fillBuffer(0) == 0)
       break;
-    else if (nBytes < 0) {
-      throw SSHSftpException(ssh_get_error(_file->sftp->session));
-    }
-    buff.append(nBytes, buffer);
-    bytesCount += nBytes;
-    if (buffer == '\n')
+
+    std::size_t eol = _buffer.find('\n', _bufferPos);
+    std::size_t end = eol == std::string::npos ? _buffer.size() : eol + 1;
+    buff.append(_buffer, _bufferPos, end - _bufferPos);
+    _bufferPos = end;
+    if (eol != std::string::npos)
       break;
 
-    if (bytesCount > _maxFileLimit) {
+    if (buff.size() > _maxFileLimit) {
       throw SSHSftpException("Max file limit exceeded\n.");
     }
   }
@@ -84,10 +136,66 @@ grt::StringRef ssh::SSHFileWrapper::readline() {
 
 grt::IntegerRef ssh::SSHFileWrapper::seek(const size_t offset) {
   auto lock = _session->lockSession();
-  return sftp_seek64(_file, offset);
+  doSeek(offset);
+  return 0;
+}
+
+grt::StringRef ssh::SSHFileWrapper::tailBytes(const size_t count) {
+  auto lock = _session->lockSession();
+  uint64_t size = fileSize();
+  uint64_t length = std::min<uint64_t>({ count, size, _maxFileLimit });
+  doSeek(size - length);
+  return doRead((std::size_t)length);
+}
+
+grt::StringRef ssh::SSHFileWrapper::tailLines(const size_t count) {
+  auto lock = _session->lockSession();
+  uint64_t size = fileSize();
+  if (count == 0 || size == 0) {
+    doSeek(size);
+    return "";
+  }
+
+  // Read backwards from the end in blocks until there are enough line breaks. A line break at the very end
+  // of the file terminates the last line and does not start a new one.
+  std::vector<std::string> blocks;
+  uint64_t start = size;
+  std::size_t lineBreaks = 0;
+  while (start > 0 && lineBreaks < count && size - start < _maxFileLimit) {
+    uint64_t blockStart = start > ReadAheadSize ? start - ReadAheadSize : 0;
+    doSeek(blockStart);
+    std::string block = doRead((std::size_t)(start - blockStart));
+    if (block.size() != start - blockStart)
+      throw SSHSftpException("File shrunk while reading it.");
+
+    lineBreaks += std::count(block.begin(), block.end(), '\n');
+    if (start == size && block.back() == '\n')
+      --lineBreaks;
+    blocks.push_back(std::move(block));
+    start = blockStart;
+  }
+
+  std::string data;
+  for (auto block = blocks.rbegin(); block != blocks.rend(); ++block)
+    data += *block;
+
+  std::size_t end = data.back() == '\n' ? data.size() - 1 : data.size();
+  std::size_t lineStart = 0;
+  for (std::size_t found = 0; end > 0; --end) {
+    if (data[end - 1] == '\n' && ++found == count) {
+      lineStart = end;
+      break;
+    }
+  }
+
+  if (data.size() - lineStart > _maxFileLimit)
+    lineStart = data.size() - _maxFileLimit;
+
+  doSeek(size);
+  return data.substr(lineStart);
 }
 
 grt::IntegerRef ssh::SSHFileWrapper::tell() {
   auto lock = _session->lockSession();
-  return (std::size_t)sftp_tell64(_file);
+  return (std::size_t)(_bufferStart + _bufferPos);
 }
@@ -37,6 +37,17 @@ namespace ssh {
     sftp_file _file;
     std::size_t _maxFileLimit;
     std::string _path;
+
+    // Data read ahead of the current position, so reading lines doesn't cost a round trip per character.
+    // _bufferStart is the file offset of the first buffered byte, _bufferPos the current position in the buffer.
+    std::string _buffer;
+    uint64_t _bufferStart;
+    std::size_t _bufferPos;
+
+    std::size_t fillBuffer(std::size_t minimum);
+    void doSeek(uint64_t offset);
+    std::string doRead(std::size_t length);
+    uint64_t fileSize();
   public:
     SSHFileWrapper(std::shared_ptr<SSHSession> session, std::shared_ptr<SSHSftp> ftp, const std::string &path, const std::size_t maxFileLimit);
     virtual ~SSHFileWrapper();
@@ -44,6 +55,8 @@ namespace ssh {
     virtual grt::StringRef read(const size_t length);
     virtual grt::StringRef readline();
     virtual grt::IntegerRef seek(const size_t offset);
+    virtual grt::StringRef tailBytes(const size_t count);
+    virtual grt::StringRef tailLines(const size_t count);
     virtual grt::IntegerRef tell();
   };
 }  /* namespace ssh */
@@ -23,6 +23,7 @@
 
 #include "SSHSessionWrapper.h"
 #include "SSHFileWrapper.h"
+#include "SSHSessionPool.h"
 #include "base/log.h"
 #include <fcntl.h>
 #include <vector>
@@ -83,7 +84,11 @@ namespace ssh {
     auto timeoutLock = lockTimeout();
     // before we continue, we should close all opened files
     _sftp.reset();
-    _session->disconnect();
+
+    // The session may be shared with other connections to the same host, the pool disconnects it once nobody uses it
+    // anymore.
+    SSHSessionPool::get()->release(_session);
+    _session = SSHSession::createSession();
   }
 
   grt::IntegerRef SSHSessionWrapper::isConnected() {
@@ -91,13 +96,14 @@ namespace ssh {
   }
 
   grt::IntegerRef SSHSessionWrapper::connect() {
+    SSHSessionPool::get()->setIdleTimeout((int)bec::GRTManager::get()->get_app_option_int("SSH:sessionIdleTimeout", 120));
     bool resetPassword = false;
     while (true) {
       std::string service = fillupAuthInfo(_config, _credentials, resetPassword);
 
       logInfo("Opening new SSH connection to %s\n", _config.getServer().c_str());
 
-      auto retVal = _session->connect(_config, _credentials);
+      auto retVal = SSHSessionPool::get()->acquire(_config, _credentials, SSHSessionPool::Use::COMMANDS, _session);
       switch (std::get<0>(retVal)) {
         case ssh::SSHReturnType::CONNECTION_FAILURE: {
           std::string errorMsg = std::get<1>(retVal);
@@ -108,6 +114,8 @@ namespace ssh {
           logInfo("Succesfully made SSH connection\n");
           makeSessionPoll();
           _sftp = std::shared_ptr<ssh::SSHSftp>(new ssh::SSHSftp(_session, wb::WBContextUI::get()->get_wb()->get_wb_options().get_int("SSH:maxFileSize", 65535)));
+          _sftp->setTransferOptions(bec::GRTManager::get()->get_app_option_int("SSH:sftpRequests", 16),
+                                    bec::GRTManager::get()->get_app_option_int("SSH:sftpChunkSize", 65536));
           return 0;
         }
         case ssh::SSHReturnType::INVALID_AUTH_DATA: {
@@ -1422,15 +1422,19 @@ void WBContext::set_default_options(grt::DictRef options) {
   set_default(options, "DbSqlEditor:CodeCompletionEnabled", 1);
   set_default(options, "DbSqlEditor:AutoStartCodeCompletion", 1);
   set_default(options, "DbSqlEditor:CodeCompletionUpperCaseKeywords", 0);
+  set_default(options, "DbSqlEditor:CodeCompletionCacheEnabled", 1); // keep completion symbols between sessions
   set_default(options, "DbSqlEditor:ProgressStatusUpdateInterval", 500); // in ms
   set_default(options, "DbSqlEditor:KeepAliveInterval", 600);            // in seconds
   set_default(options, "DbSqlEditor:ReadTimeOut", 30);                  // in seconds
   set_default(options, "DbSqlEditor:ConnectionTimeOut", 60);             // in seconds
   set_default(options, "DbSqlEditor:MaxQuerySizeToHistory", 65536);
   set_default(options, "DbSqlEditor:ContinueOnError", 0); // continue running sql script bypassing failed statements
+  set_default(options, "DbSqlEditor:ForwardOnlyPreparedExecution", 0); // read SELECT results forward only
   set_default(options, "DbSqlEditor:AutocommitMode", 1);  // when enabled, each statement will be committed immediately
   set_default(options, "DbSqlEditor:IsDataChangesCommitWizardEnabled", 1);
   set_default(options, "DbSqlEditor:ShowSchemaTreeSchemaContents", 1);
+  set_default(options, "DbSqlEditor:SchemaTreeBatchMemoryLimit", 16); // in MB per schema, 0 = no limit
+  set_default(options, "DbSqlEditor:MetadataConnectionPoolSize", 3); // read only connections for meta data, 0 = none
   set_default(options, "DbSqlEditor:SafeUpdates", 1);
   set_default(options, "DbSqlEditor:ShowWarnings", 1);
   set_default(options, "DbSqlEditor:ReformatViewDDL", 1);
@@ -1503,6 +1507,8 @@ void WBContext::set_default_options(grt::DictRef options) {
   set_default(options, "workbench.model.NoteFigure:Color", "#FEFDED");
 
   set_default(options, "workbench.physical.Diagram:DrawLineCrossings", 0);
+  set_default(options, "workbench.physical.Diagram:DetailTitlesZoom", 50);
+  set_default(options, "workbench.physical.Diagram:DetailBlocksZoom", 25);
   set_default(options, "workbench.physical.ObjectFigure:Expanded", 1);
   set_default(options, "workbench.physical.TableFigure:ShowColumnTypes", 1);
   set_default(options, "workbench.physical.TableFigure:ShowColumnFlags", 0);
@@ -1580,6 +1586,9 @@ void WBContext::set_default_options(grt::DictRef options) {
   set_default(options, "SSH:BufferSize", 10240);
   set_default(options, "SSH:maxFileSize", 100*ONE_MB);  // Set limit to 100MB by default.
   set_default(options, "SSH:logSize", 100*ONE_MB);  // Set limit to 100MB by default.
+  set_default(options, "SSH:sftpRequests", 16);
+  set_default(options, "SSH:sftpChunkSize", 65536);
+  set_default(options, "SSH:sessionIdleTimeout", 120);
 
   set_default(options, "SSH:readWriteTimeout", 5);
   set_default(options, "SSH:commandTimeout", 1);
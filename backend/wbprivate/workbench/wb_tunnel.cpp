@@ -39,6 +39,7 @@
 
 #include "base/log.h"
 #include "SSHSession.h"
+#include "SSHSessionPool.h"
 #include "SSHSessionWrapper.h"
 
 DEFAULT_LOG_DOMAIN("SSH tunnel")
@@ -128,14 +129,18 @@ std::shared_ptr<SSHTunnel> TunnelManager::createTunnel(db_mgmt_ConnectionRef con
       bec::GRTManager::get()->replace_status_text("Existing SSH tunnel not found, opening new one...");
       logInfo("Existing SSH tunnel not found, opening new one\n");
 
-      auto session = ssh::SSHSession::createSession();
+      ssh::SSHSessionPool::get()->setIdleTimeout(
+        (int)bec::GRTManager::get()->get_app_option_int("SSH:sessionIdleTimeout", 120));
+
+      std::shared_ptr<ssh::SSHSession> session;
       while (true) {
         std::string service = ssh::SSHSessionWrapper::fillupAuthInfo(config, credentials, resetPassword);
 
         bec::GRTManager::get()->replace_status_text("Opening SSH tunnel to " + config.getServer() + "...");
         logInfo("Opening SSH tunnel to %s\n", config.getServer().c_str());
 
-        auto retVal = session->connect(config, credentials);
+        auto retVal =
+          ssh::SSHSessionPool::get()->acquire(config, credentials, ssh::SSHSessionPool::Use::TUNNEL, session);
         switch (std::get<0>(retVal)) {
           case ssh::SSHReturnType::CONNECTION_FAILURE: {
             std::string errorMsg = std::get<1>(retVal);
@@ -144,7 +149,7 @@ std::shared_ptr<SSHTunnel> TunnelManager::createTunnel(db_mgmt_ConnectionRef con
             throw std::runtime_error(std::string("Cannot open SSH Tunnel: ").append(errorMsg.c_str()));
           }
           case ssh::SSHReturnType::CONNECTED: {
-            retVal = _manager->createTunnel(session);
+            retVal = _manager->createTunnel(session, config);
             uint16_t port = std::get<1>(retVal);
             bec::GRTManager::get()->replace_status_text("SSH tunnel opened");
             logInfo("SSH tunnel opened on port: %d\n", (int )port);
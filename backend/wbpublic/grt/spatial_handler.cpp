@@ -23,8 +23,11 @@
 
 #include "spatial_handler.h"
 #include <algorithm>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
+#include <thread>
 #include "base/log.h"
 
 DEFAULT_LOG_DOMAIN("spatial");
@@ -727,43 +730,92 @@ bool spatial::Converter::from_proj_to_latlon(double &lat, double &lon) {
   return _proj_to_geo->Transform(1, &lat, &lon) != 0;
 }
 
-void spatial::Converter::transform_points(std::deque<ShapeContainer> &shapes_container) {
-  std::deque<ShapeContainer>::iterator it;
-  for (it = shapes_container.begin(); it != shapes_container.end() && !_interrupt; it++) {
-    std::deque<size_t> for_removal;
+OGRSpatialReference *spatial::Converter::target_srs() {
+  base::RecMutexLock mtx(_projection_protector);
+  return _target_srs;
+}
+
+// Coordinate transformations must not be used by more than one thread at a time, so each worker rendering
+// features in parallel gets its own. The caller has to free it with OCTDestroyCoordinateTransformation.
+OGRCoordinateTransformation *spatial::Converter::create_transformation() {
+  base::RecMutexLock mtx(_projection_protector);
+  return OGRCreateCoordinateTransformation(_source_srs, _target_srs);
+}
+
+// Converts geographic coordinates into the target projection, skipping points that can't be converted.
+// Without an explicit transformation the one of the converter is used.
+void spatial::Converter::project_points(std::deque<ShapeContainer> &shapes_container,
+                                        OGRCoordinateTransformation *transformation) {
+  std::unique_ptr<base::RecMutexLock> lock;
+  if (transformation == NULL) {
+    lock.reset(new base::RecMutexLock(_projection_protector));
+    transformation = _geo_to_proj;
+  }
+
+  for (std::deque<ShapeContainer>::iterator it = shapes_container.begin(); it != shapes_container.end() && !_interrupt;
+       it++) {
+    std::vector<base::Point> converted;
+    converted.reserve((*it).points.size());
     for (size_t i = 0; i < (*it).points.size() && !_interrupt; i++) {
-      if (!_geo_to_proj->Transform(1, &(*it).points[i].x, &(*it).points[i].y))
-        for_removal.push_back(i);
+      base::Point p = (*it).points[i];
+      if (transformation->Transform(1, &p.x, &p.y))
+        converted.push_back(p);
     }
 
-    if (_geo_to_proj->Transform(1, &(*it).bounding_box.bottom_right.x, &(*it).bounding_box.bottom_right.y) &&
-        _geo_to_proj->Transform(1, &(*it).bounding_box.top_left.x, &(*it).bounding_box.top_left.y)) {
-      int x, y;
-      from_projected((*it).bounding_box.bottom_right.x, (*it).bounding_box.bottom_right.y, x, y);
-      (*it).bounding_box.bottom_right.x = x;
-      (*it).bounding_box.bottom_right.y = y;
-      from_projected((*it).bounding_box.top_left.x, (*it).bounding_box.top_left.y, x, y);
-      (*it).bounding_box.top_left.x = x;
-      (*it).bounding_box.top_left.y = y;
-      (*it).bounding_box.converted = true;
+    if (converted.size() != (*it).points.size())
+      logDebug("%i points that could not be converted were skipped\n", (int)((*it).points.size() - converted.size()));
+    (*it).points.swap(converted);
+
+    if ((*it).points.empty())
+      continue;
+
+    // The box is taken from the converted points, since the corners of the geographic box don't necessarily
+    // enclose the shape anymore after projecting.
+    base::Point min = (*it).points[0], max = (*it).points[0];
+    for (std::vector<base::Point>::const_iterator p = (*it).points.begin(); p != (*it).points.end(); ++p) {
+      min.x = MIN(min.x, p->x);
+      min.y = MIN(min.y, p->y);
+      max.x = MAX(max.x, p->x);
+      max.y = MAX(max.y, p->y);
     }
+    (*it).bounding_box.top_left = base::Point(min.x, max.y);
+    (*it).bounding_box.bottom_right = base::Point(max.x, min.y);
+    (*it).bounding_box.converted = false;
+  }
+}
 
-    if (!for_removal.empty())
-      logDebug("%i points that could not be converted were skipped\n", (int)for_removal.size());
+// Maps projected coordinates to pixels. This is cheap compared to projecting, so it is redone for every change
+// of the visible area while the projected coordinates are kept.
+void spatial::Converter::projected_to_screen(std::deque<ShapeContainer> &shapes_container) {
+  double inv_projection[6];
+  {
+    base::RecMutexLock mtx(_projection_protector);
+    std::copy(_inv_projection, _inv_projection + 6, inv_projection);
+  }
 
-    std::deque<size_t>::reverse_iterator rit;
-    for (rit = for_removal.rbegin(); rit != for_removal.rend() && !_interrupt; rit++)
-      (*it).points.erase((*it).points.begin() + *rit);
+  for (std::deque<ShapeContainer>::iterator it = shapes_container.begin(); it != shapes_container.end() && !_interrupt;
+       it++) {
+    for (size_t i = 0; i < (*it).points.size(); i++) {
+      (*it).points[i].x = (int)(inv_projection[0] + inv_projection[1] * (*it).points[i].x);
+      (*it).points[i].y = (int)(inv_projection[3] + inv_projection[5] * (*it).points[i].y);
+    }
 
-    for (size_t i = 0; i < (*it).points.size() && !_interrupt; i++) {
-      int x, y;
-      from_projected((*it).points[i].x, (*it).points[i].y, x, y);
-      (*it).points[i].x = x;
-      (*it).points[i].y = y;
+    if (!(*it).points.empty()) {
+      Envelope &box = (*it).bounding_box;
+      box.top_left.x = (int)(inv_projection[0] + inv_projection[1] * box.top_left.x);
+      box.top_left.y = (int)(inv_projection[3] + inv_projection[5] * box.top_left.y);
+      box.bottom_right.x = (int)(inv_projection[0] + inv_projection[1] * box.bottom_right.x);
+      box.bottom_right.y = (int)(inv_projection[3] + inv_projection[5] * box.bottom_right.y);
+      box.converted = true;
     }
   }
 }
 
+void spatial::Converter::transform_points(std::deque<ShapeContainer> &shapes_container) {
+  project_points(shapes_container);
+  projected_to_screen(shapes_container);
+}
+
 void spatial::Converter::transform_envelope(spatial::Envelope &env) {
   if (!env.is_init()) {
     logError("Can't transform empty envelope.\n");
@@ -792,7 +844,55 @@ void spatial::Converter::interrupt() {
 
 using namespace spatial;
 
-Feature::Feature(Layer *layer, int row_id, const std::string &data, bool wkt = false) : _owner(layer), _row_id(row_id) {
+// Zoom levels from which on a simplified version of the shapes is painted, each until the zoom level is doubled.
+// Beyond the last band the full geometry is used.
+static const float simplify_zoom_bands[] = { 1.0f, 2.0f, 4.0f, 8.0f };
+static const size_t simplify_zoom_band_count = sizeof(simplify_zoom_bands) / sizeof(simplify_zoom_bands[0]);
+
+// Douglas-Peucker simplification of a polyline. The end points are always kept, so closed rings stay closed.
+static void simplify_points(const std::vector<base::Point> &points, double tolerance,
+                            std::vector<base::Point> &result) {
+  result.clear();
+  if (points.size() < 3) {
+    result = points;
+    return;
+  }
+
+  std::vector<bool> keep(points.size(), false);
+  keep.front() = keep.back() = true;
+
+  // Iterative instead of recursive, rings can have hundreds of thousands of points.
+  std::vector<std::pair<size_t, size_t> > ranges;
+  ranges.push_back(std::make_pair((size_t)0, points.size() - 1));
+  while (!ranges.empty()) {
+    std::pair<size_t, size_t> range = ranges.back();
+    ranges.pop_back();
+
+    double max_distance = 0;
+    size_t index = range.first;
+    for (size_t i = range.first + 1; i < range.second; ++i) {
+      double distance = distance_to_segment(points[range.first], points[range.second], points[i]);
+      if (distance > max_distance) {
+        max_distance = distance;
+        index = i;
+      }
+    }
+
+    if (max_distance > tolerance) {
+      keep[index] = true;
+      ranges.push_back(std::make_pair(range.first, index));
+      ranges.push_back(std::make_pair(index, range.second));
+    }
+  }
+
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (keep[i])
+      result.push_back(points[i]);
+  }
+}
+
+Feature::Feature(Layer *layer, int row_id, const std::string &data, bool wkt = false)
+  : _owner(layer), _row_id(row_id), _projected_srs(NULL) {
   if (wkt)
     _geometry.import_from_wkt(data);
   else
@@ -811,16 +911,70 @@ void Feature::get_envelope(spatial::Envelope &env, const bool &screen_coords) {
   env = _env_screen;
 }
 
-void Feature::render(Converter *converter) {
-  std::deque<ShapeContainer> tmp_shapes;
-  _geometry.get_points(tmp_shapes);
-  converter->transform_points(tmp_shapes);
+void Feature::render(Converter *converter, OGRCoordinateTransformation *transformation) {
+  // Projecting is by far the most expensive step, so it's only done again when the projection changed.
+  // Zooming into an area or resizing the view just needs new screen coordinates.
+  OGRSpatialReference *srs = converter->target_srs();
+  if (_projected_srs != srs) {
+    std::deque<ShapeContainer> tmp_shapes;
+    _geometry.get_points(tmp_shapes);
+    converter->project_points(tmp_shapes, transformation);
+    _projected.swap(tmp_shapes);
+    _projected_srs = srs;
+  }
+
+  std::deque<ShapeContainer> tmp_shapes = _projected;
+  converter->projected_to_screen(tmp_shapes);
+
   spatial::Envelope env;
-  _geometry.get_envelope(env);
-  converter->transform_envelope(env);
+  bool first = true;
+  for (std::deque<ShapeContainer>::const_iterator it = tmp_shapes.begin(); it != tmp_shapes.end(); it++) {
+    if (!(*it).bounding_box.converted)
+      continue;
+    if (first) {
+      env = (*it).bounding_box;
+      first = false;
+    } else {
+      env.top_left.x = MIN(env.top_left.x, (*it).bounding_box.top_left.x);
+      env.top_left.y = MIN(env.top_left.y, (*it).bounding_box.top_left.y);
+      env.bottom_right.x = MAX(env.bottom_right.x, (*it).bounding_box.bottom_right.x);
+      env.bottom_right.y = MAX(env.bottom_right.y, (*it).bounding_box.bottom_right.y);
+    }
+  }
   _env_screen = env;
 
-  _shapes = tmp_shapes;
+  _shapes.swap(tmp_shapes);
+  simplify();
+}
+
+// Precomputes a simplified version of the screen shapes for each zoom band, dropping the points which are
+// closer than about a pixel to the simplified outline at that zoom level.
+void Feature::simplify() {
+  _simplified.resize(simplify_zoom_band_count);
+  for (size_t band = 0; band < simplify_zoom_band_count; ++band) {
+    double tolerance = 0.5 / simplify_zoom_bands[band];
+    std::deque<ShapeContainer> &simplified = _simplified[band];
+    simplified.clear();
+    for (std::deque<ShapeContainer>::const_iterator it = _shapes.begin(); it != _shapes.end() && !_owner->_interrupt;
+         it++) {
+      simplified.push_back(ShapeContainer());
+      ShapeContainer &shape = simplified.back();
+      shape.type = (*it).type;
+      shape.bounding_box = (*it).bounding_box;
+      if ((*it).type == ShapePoint)
+        shape.points = (*it).points;
+      else
+        simplify_points((*it).points, tolerance, shape.points);
+    }
+  }
+}
+
+const std::deque<ShapeContainer> &Feature::shapes_for_scale(float scale) const {
+  for (size_t band = 0; band < _simplified.size(); ++band) {
+    if (scale < simplify_zoom_bands[band] * 2)
+      return _simplified[band];
+  }
+  return _shapes;
 }
 
 double Feature::distance(const base::Point &p, const double &allowed_distance) {
@@ -851,7 +1005,9 @@ void Feature::interrupt() {
 }
 
 void Feature::repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area, base::Color fill_color) {
-  for (std::deque<ShapeContainer>::iterator it = _shapes.begin(); it != _shapes.end() && !_owner->_interrupt; it++) {
+  const std::deque<ShapeContainer> &shapes = shapes_for_scale(scale);
+  for (std::deque<ShapeContainer>::const_iterator it = shapes.begin(); it != shapes.end() && !_owner->_interrupt;
+       it++) {
     if ((*it).points.empty()) {
       logError("%s is empty", shape_description(it->type).c_str());
       continue;
@@ -906,7 +1062,8 @@ static void extend_env(spatial::Envelope &env, const spatial::Envelope &env2) {
   env.bottom_right.y = MIN(env.bottom_right.y, env2.bottom_right.y);
 }
 
-Layer::Layer(int layer_id, base::Color color) : _layer_id(layer_id), _color(color), _show(false), _interrupt(false) {
+Layer::Layer(int layer_id, base::Color color)
+  : _layer_id(layer_id), _color(color), _rendered_features(0), _show(false), _interrupt(false) {
   _spatial_envelope.top_left.x = 180;
   _spatial_envelope.top_left.y = -90;
   _spatial_envelope.bottom_right.x = -180;
@@ -965,14 +1122,27 @@ void Layer::repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area)
   color.green *= 0.6;
   color.blue *= 0.6;
   cr.set_color(color);
-  for (std::deque<Feature *>::iterator it = _features.begin(); it != _features.end() && !_interrupt; ++it)
-    (*it)->repaint(cr, scale, clip_area, _fill_polygons ? _color : base::Color::invalid());
+  if (clip_area.width() > 0 && clip_area.height() > 0) {
+    // Only paint what's inside the visible area.
+    std::vector<Feature *> visible;
+    {
+      base::MutexLock lock(_index_mutex);
+      visible = _index.query(clip_area);
+    }
+    for (std::vector<Feature *>::iterator it = visible.begin(); it != visible.end() && !_interrupt; ++it)
+      (*it)->repaint(cr, scale, clip_area, _fill_polygons ? _color : base::Color::invalid());
+  } else {
+    for (std::deque<Feature *>::iterator it = _features.begin(); it != _features.end() && !_interrupt; ++it)
+      (*it)->repaint(cr, scale, clip_area, _fill_polygons ? _color : base::Color::invalid());
+  }
 
   cr.restore();
 }
 
 float Layer::query_render_progress() {
-  return _render_progress;
+  if (_features.empty())
+    return 1.0f;
+  return (float)_rendered_features / _features.size();
 }
 
 spatial::Envelope spatial::Layer::get_envelope() {
@@ -980,20 +1150,58 @@ spatial::Envelope spatial::Layer::get_envelope() {
 }
 
 void Layer::render(Converter *converter) {
-  _render_progress = 0.0;
-  float step = 1.0f / _features.size();
+  _rendered_features = 0;
+
+  // Features are independent of each other, so they are projected on all cores. Every worker needs its own
+  // coordinate transformation, which are created here as setting them up isn't thread safe.
+  size_t worker_count = MAX(std::thread::hardware_concurrency(), 1U);
+  worker_count = MIN(worker_count, _features.size() / 1000 + 1);
+
+  std::vector<OGRCoordinateTransformation *> transformations;
+  for (size_t i = 0; i < worker_count; ++i)
+    transformations.push_back(converter->create_transformation());
+
+  std::vector<std::future<void> > workers;
+  for (size_t i = 0; i < worker_count; ++i) {
+    workers.push_back(std::async(std::launch::async, [this, converter, &transformations, i, worker_count]() {
+      // Interleaved, so big and small features (usually sorted somehow in a result set) are spread evenly.
+      for (size_t f = i; f < _features.size() && !_interrupt; f += worker_count) {
+        _features[f]->render(converter, transformations[i]);
+        ++_rendered_features;
+      }
+    }));
+  }
+  for (std::vector<std::future<void> >::iterator it = workers.begin(); it != workers.end(); ++it)
+    it->get();
 
-  for (std::deque<spatial::Feature *>::iterator iter = _features.begin(); iter != _features.end() && !_interrupt;
-       ++iter) {
-    (*iter)->render(converter);
-    _render_progress += step;
+  for (std::vector<OGRCoordinateTransformation *>::iterator it = transformations.begin(); it != transformations.end();
+       ++it) {
+    if (*it != NULL)
+      OCTDestroyCoordinateTransformation(*it);
+  }
+
+  base::MutexLock lock(_index_mutex);
+  _index.clear();
+  for (std::deque<Feature *>::iterator it = _features.begin(); it != _features.end() && !_interrupt; ++it) {
+    spatial::Envelope env;
+    (*it)->get_envelope(env, true);
+    if (env.converted)
+      _index.insert(*it, base::Rect(env.top_left.x, env.top_left.y, env.bottom_right.x - env.top_left.x,
+                                    env.bottom_right.y - env.top_left.y));
   }
 }
 
 spatial::Feature *Layer::feature_closest(const base::Point &p, const double &allowed_distance) {
+  std::vector<Feature *> candidates;
+  {
+    base::MutexLock lock(_index_mutex);
+    candidates = _index.query(base::Rect(p.x - allowed_distance, p.y - allowed_distance, 2 * allowed_distance,
+                                         2 * allowed_distance));
+  }
+
   double rval = -1;
   spatial::Feature *f = NULL;
-  for (std::deque<spatial::Feature *>::iterator iter = _features.begin(); iter != _features.end() && !_interrupt;
+  for (std::vector<spatial::Feature *>::iterator iter = candidates.begin(); iter != candidates.end() && !_interrupt;
        ++iter) {
     double dist = (*iter)->distance(p, allowed_distance);
     if (dist < allowed_distance && dist != -1 && (dist < rval || rval == -1)) {
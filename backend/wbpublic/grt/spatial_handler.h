@@ -31,7 +31,10 @@
 #include <gdal_alg.h>
 #include <gdal.h>
 #include <deque>
+#include <vector>
+#include <atomic>
 #include "base/geometry.h"
+#include "base/threading.h"
 #include "wbpublic_public_interface.h"
 
 #include "mdc.h"
@@ -179,6 +182,10 @@ namespace spatial {
     bool from_latlon_to_proj(double &lat, double &lon);
     bool from_proj_to_latlon(double &lat, double &lon);
     static std::string dec_to_dms(double angle, AxisType axis, int precision);
+    OGRSpatialReference *target_srs();
+    OGRCoordinateTransformation *create_transformation();
+    void project_points(std::deque<ShapeContainer> &shapes_container, OGRCoordinateTransformation *transformation = NULL);
+    void projected_to_screen(std::deque<ShapeContainer> &shapes_container);
     void transform_points(std::deque<ShapeContainer> &shapes_container);
     void transform_envelope(spatial::Envelope &env);
     void interrupt();
@@ -190,16 +197,22 @@ namespace spatial {
     Layer *_owner;
     int _row_id;
     Importer _geometry;
+    std::deque<ShapeContainer> _projected; // Coordinates in _projected_srs, kept until the projection changes.
+    OGRSpatialReference *_projected_srs;
     std::deque<ShapeContainer> _shapes;
+    std::vector<std::deque<ShapeContainer> > _simplified; // One entry per zoom band, see Feature::simplify().
     spatial::Envelope _env_screen;
 
+    void simplify();
+    const std::deque<ShapeContainer> &shapes_for_scale(float scale) const;
+
   public:
     Feature(Layer *layer, int row_id, const std::string &data, bool wkt);
     ~Feature();
 
     void interrupt();
     void get_envelope(spatial::Envelope &env, const bool &screen_coords = false);
-    void render(spatial::Converter *converter);
+    void render(spatial::Converter *converter, OGRCoordinateTransformation *transformation = NULL);
     void repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area,
                  base::Color fill_color = base::Color::invalid());
 
@@ -217,10 +230,12 @@ namespace spatial {
 
   protected:
     std::deque<Feature *> _features;
+    mdc::RTree<Feature *> _index; // Screen envelopes of the rendered features.
+    base::Mutex _index_mutex;
 
     LayerId _layer_id;
     base::Color _color;
-    float _render_progress;
+    std::atomic<size_t> _rendered_features;
     bool _show;
     bool _interrupt;
     spatial::Envelope _spatial_envelope;
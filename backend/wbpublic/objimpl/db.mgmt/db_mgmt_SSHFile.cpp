@@ -85,6 +85,22 @@ grt::IntegerRef db_mgmt_SSHFile::seek(ssize_t offset) {
 
 //------------------------------------------------------------------------------------------------
 
+grt::StringRef db_mgmt_SSHFile::tailBytes(ssize_t count) {
+  if (_data)
+    return _data->tailBytes(count);
+  return "";
+}
+
+//------------------------------------------------------------------------------------------------
+
+grt::StringRef db_mgmt_SSHFile::tailLines(ssize_t count) {
+  if (_data)
+    return _data->tailLines(count);
+  return "";
+}
+
+//------------------------------------------------------------------------------------------------
+
 grt::IntegerRef db_mgmt_SSHFile::tell() {
   if (_data)
     return _data->tell();
@@ -30,5 +30,7 @@ public:
   virtual grt::StringRef read(const size_t length) = 0;
   virtual grt::StringRef readline() = 0;
   virtual grt::IntegerRef seek(const size_t offset) = 0;
+  virtual grt::StringRef tailBytes(const size_t count) = 0;
+  virtual grt::StringRef tailLines(const size_t count) = 0;
   virtual grt::IntegerRef tell() = 0;
 };
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "query_trace.h"
+
+#include "base/string_utilities.h"
+
+#include <algorithm>
+#include <chrono>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+QueryTrace::QueryTrace() : id(0) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+QueryTrace::QueryTrace(std::size_t id, const std::string &statement) : id(id), statement(statement) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::int64_t QueryTrace::now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const char *QueryTrace::phase_name(Phase phase) {
+  switch (phase) {
+    case Parse:
+      return "Parse";
+    case Send:
+      return "Network";
+    case ServerExecution:
+      return "Server Execution";
+    case ResultOpen:
+      return "Open Result Set";
+    case FirstRow:
+      return "First Row";
+    case Fetch:
+      return "Fetch";
+    case SwapInsert:
+      return "Swap DB Insert";
+    case GridReady:
+      return "Grid Ready";
+  }
+  return "Unknown";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void QueryTrace::add_span(Phase phase, std::int64_t start, std::int64_t end) {
+  spans.push_back({ phase, start, std::max<std::int64_t>(0, end - start) });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void QueryTrace::add_mark(Phase phase, std::int64_t when) {
+  spans.push_back({ phase, when, 0 });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void QueryTrace::split_server_time(std::int64_t server_time) {
+  for (auto span = spans.rbegin(); span != spans.rend(); ++span) {
+    if (span->phase == Send) {
+      server_time = std::min(std::max<std::int64_t>(0, server_time), span->duration);
+      span->duration -= server_time;
+      spans.push_back({ ServerExecution, span->start + span->duration, server_time });
+      return;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::int64_t QueryTrace::start_time() const {
+  if (spans.empty())
+    return 0;
+
+  std::int64_t result = spans.front().start;
+  for (auto &span : spans)
+    result = std::min(result, span.start);
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::int64_t QueryTrace::end_time() const {
+  std::int64_t result = 0;
+  for (auto &span : spans)
+    result = std::max(result, span.start + span.duration);
+  return result;
+}
+
+//----------------- QueryTraceLog --------------------------------------------------------------------------------------
+
+QueryTraceLog::QueryTraceLog(std::size_t capacity) : _capacity(std::max<std::size_t>(1, capacity)) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::size_t QueryTraceLog::next_id() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return ++_last_id;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void QueryTraceLog::add(const QueryTrace &trace) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_traces.size() == _capacity)
+    _traces.pop_front();
+  _traces.push_back(trace);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<QueryTrace> QueryTraceLog::traces() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return std::vector<QueryTrace>(_traces.begin(), _traces.end());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void QueryTraceLog::clear() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _traces.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Converts the given traces to the Chrome trace event format. Each statement gets its own (pseudo) thread row,
+ * named after the statement, with one complete event ("X") per phase and instant events ("i") for marks.
+ */
+std::string QueryTraceLog::to_chrome_trace(const std::vector<QueryTrace> &traces) {
+  std::string result = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  bool first = true;
+  auto add_event = [&](const std::string &event) {
+    result += first ? "\n  " : ",\n  ";
+    result += event;
+    first = false;
+  };
+
+  for (auto &trace : traces) {
+    std::string statement = trace.statement;
+    if (statement.size() > 200)
+      statement = statement.substr(0, 200) + "...";
+    statement = base::escape_json_string(statement);
+
+    add_event(base::strfmt(
+      "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %i, \"args\": {\"name\": \"#%i %s\"}}",
+      (int)trace.id, (int)trace.id, statement.c_str()));
+
+    for (auto &span : trace.spans) {
+      if (span.duration == 0 && span.phase == QueryTrace::FirstRow)
+        add_event(base::strfmt(
+          "{\"name\": \"%s\", \"cat\": \"sql\", \"ph\": \"i\", \"s\": \"t\", \"pid\": 1, \"tid\": %i, \"ts\": %lld}",
+          QueryTrace::phase_name(span.phase), (int)trace.id, (long long)span.start));
+      else
+        add_event(base::strfmt("{\"name\": \"%s\", \"cat\": \"sql\", \"ph\": \"X\", \"pid\": 1, \"tid\": %i, "
+                               "\"ts\": %lld, \"dur\": %lld, \"args\": {\"statement\": \"%s\"}}",
+                               QueryTrace::phase_name(span.phase), (int)trace.id, (long long)span.start,
+                               (long long)span.duration, statement.c_str()));
+    }
+  }
+  result += "\n]}\n";
+
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include "wbpublic_public_interface.h"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Timeline of a single statement run in the SQL editor, from splitting the script until the result grid is ready.
+ * Timestamps are microseconds of a monotonic clock (see now()), so they can only be compared with each other.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC QueryTrace {
+public:
+  enum Phase {
+    Parse,           // Client side splitting and parsing of the statement.
+    Send,            // Sending the statement + waiting for the server, minus the server execution time (if known).
+    ServerExecution, // Execution time as reported by the performance schema.
+    ResultOpen,      // Getting the result set from the statement (includes the transfer for buffered results).
+    FirstRow,        // Instant event: the first row is available on the client.
+    Fetch,           // Transferring the result set to the client.
+    SwapInsert,      // Copying rows into the local swap database of the recordset.
+    GridReady        // Creating the result panel.
+  };
+
+  struct Span {
+    Phase phase;
+    std::int64_t start;
+    std::int64_t duration; // 0 for instant events.
+  };
+
+  QueryTrace();
+  QueryTrace(std::size_t id, const std::string &statement);
+
+  static std::int64_t now();
+  static const char *phase_name(Phase phase);
+
+  void add_span(Phase phase, std::int64_t start, std::int64_t end);
+  void add_mark(Phase phase, std::int64_t when);
+
+  // Moves the given server side execution time (e.g. from the performance schema) out of the last Send span.
+  void split_server_time(std::int64_t server_time);
+
+  bool empty() const {
+    return spans.empty();
+  }
+  std::int64_t start_time() const;
+  std::int64_t end_time() const;
+
+  std::size_t id;
+  std::string statement;
+  std::vector<Span> spans;
+};
+
+/**
+ * Ring buffer of the most recent query traces, shared by all threads running queries for one SQL editor.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC QueryTraceLog {
+public:
+  QueryTraceLog(std::size_t capacity = 100);
+
+  std::size_t next_id();
+  void add(const QueryTrace &trace);
+  std::vector<QueryTrace> traces() const;
+  void clear();
+
+  std::size_t capacity() const {
+    return _capacity;
+  }
+
+  // Chrome trace event format (JSON), which can be loaded in chrome://tracing or Perfetto.
+  static std::string to_chrome_trace(const std::vector<QueryTrace> &traces);
+
+private:
+  mutable std::mutex _mutex;
+  std::deque<QueryTrace> _traces;
+  std::size_t _capacity;
+  std::size_t _last_id = 0;
+};
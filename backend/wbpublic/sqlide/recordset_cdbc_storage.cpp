@@ -29,6 +29,7 @@
 #include "grtsqlparser/sql_facade.h"
 #include "base/string_utilities.h"
 #include "base/sqlstring.h"
+#include "base/log.h"
 #include <sqlite/query.hpp>
 #include <algorithm>
 #include <ctype.h>
@@ -37,6 +38,8 @@ using namespace bec;
 using namespace grt;
 using namespace base;
 
+DEFAULT_LOG_DOMAIN("Recordset")
+
 Recordset_cdbc_storage::Recordset_cdbc_storage()
   : Recordset_sql_storage(), _reloadable(true), _gather_field_info(false) {
 }
@@ -239,6 +242,28 @@ size_t Recordset_cdbc_storage::determine_pkey_columns_alt(Recordset::Column_name
   return 0;
 }
 
+/**
+ * Prepares the given query for forward-only execution. Rows are then read from the server one by one as they arrive
+ * instead of being buffered completely on the client first. Values are still converted to strings for the swap db,
+ * like for the text protocol. The connector offers no way to open a server side cursor, so there is no prefetching.
+ *
+ * Returns an empty pointer if the statement cannot be prepared (e.g. it is not supported by the binary protocol), so
+ * callers can fall back to a plain statement.
+ */
+std::shared_ptr<sql::PreparedStatement> Recordset_cdbc_storage::prepare_forward_only_query(sql::Connection *connection,
+                                                                                           const std::string &query) {
+  std::shared_ptr<sql::PreparedStatement> stmt;
+  try {
+    stmt.reset(connection->prepareStatement(query));
+  } catch (sql::SQLException &e) {
+    logDebug("Cannot prepare query, using text protocol instead: %s\n", e.what());
+    return stmt;
+  }
+
+  stmt->setResultSetType(sql::ResultSet::TYPE_FORWARD_ONLY);
+  return stmt;
+}
+
 void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connection *data_swap_db) {
   sql::Dbc_connection_handler::Ref conn;
   base::RecMutexLock lock(
@@ -265,12 +290,20 @@ void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connec
   } else {
     if (!_reloadable)
       throw std::runtime_error("Recordset can't be reloaded, original statement must be reexecuted instead");
-    stmt.reset(conn->ref->createStatement());
-    // if (!_schema_name.empty()) //! default schema is to be set for connector
-    //  stmt->execute(strfmt("use `%s`", _schema_name.c_str()));
-    // stmt->setFetchSize(100); //! setFetchSize is not implemented. param value to be customized.
-    stmt->execute(sql_query);
-    rs.reset(stmt->getResultSet());
+    std::shared_ptr<sql::PreparedStatement> prepared;
+    if (_use_prepared_statement)
+      prepared = prepare_forward_only_query(conn->ref.get(), sql_query);
+    if (prepared) {
+      stmt = prepared;
+      rs.reset(prepared->executeQuery());
+    } else {
+      stmt.reset(conn->ref->createStatement());
+      // if (!_schema_name.empty()) //! default schema is to be set for connector
+      //  stmt->execute(strfmt("use `%s`", _schema_name.c_str()));
+      // stmt->setFetchSize(100); //! setFetchSize is not implemented. param value to be customized.
+      stmt->execute(sql_query);
+      rs.reset(stmt->getResultSet());
+    }
   }
 
   _valid = (NULL != rs.get());
@@ -440,8 +473,15 @@ void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connec
 
     std::list<std::shared_ptr<sqlite::command> > insert_commands =
       prepare_data_swap_record_add_statement(data_swap_db, column_names);
+    _fetch_start = QueryTrace::now();
+    _first_row = 0;
+    _fetch_end = 0;
+    _swap_insert_time = 0;
+
     // XXX this will fetch all records before displaying them, which will result in a huge unnecessary lag in the UI
     while (rs->next()) {
+      if (_first_row == 0)
+        _first_row = QueryTrace::now();
       for (ColumnId n = 0; editable_col_count > n; ++n) {
         if (rs->isNull((int)n + 1) || null_value_columns[n]) {
           row_values[n] = sqlite::null_t();
@@ -452,7 +492,10 @@ void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connec
       }
       for (ColumnId n = 0; rowid_col_count > n; ++n) // copy original value of pk field(s)
         row_values[editable_col_count + n] = row_values[_pkey_columns[n]];
+
+      std::int64_t insert_start = QueryTrace::now();
       add_data_swap_record(insert_commands, row_values);
+      _swap_insert_time += QueryTrace::now() - insert_start;
 
       if (conn->is_stop_query_requested)
         throw std::runtime_error(
@@ -461,6 +504,7 @@ void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connec
     }
 
     transaction_guarder.commit();
+    _fetch_end = QueryTrace::now();
   }
 
   // remap rowid columns to duplicated columns
@@ -468,6 +512,20 @@ void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connec
     _pkey_columns[rowid_col] = col;
 }
 
+/**
+ * Reading rows and inserting them into the swap db interleave, so the trace shows their accumulated times back to back.
+ */
+void Recordset_cdbc_storage::add_fetch_trace(QueryTrace &trace) const {
+  if (_fetch_end == 0)
+    return;
+
+  if (_first_row != 0)
+    trace.add_mark(QueryTrace::FirstRow, _first_row);
+  std::int64_t read_end = _fetch_end - _swap_insert_time;
+  trace.add_span(QueryTrace::Fetch, _fetch_start, read_end);
+  trace.add_span(QueryTrace::SwapInsert, read_end, _fetch_end);
+}
+
 void Recordset_cdbc_storage::do_fetch_blob_value(Recordset *recordset, sqlite::connection *data_swap_db, RowId rowid,
                                                  ColumnId column, sqlite::variant_t &blob_value) {
   sql::Dbc_connection_handler::Ref conn;
@@ -547,12 +605,52 @@ void Recordset_cdbc_storage::run_sql_script(const Sql_script &sql_script, bool s
   std::string msg;
   BlobVarToStream blob_var_to_stream;
   Sql_script::Statements_bindings::const_iterator sql_bindings = sql_script.statements_bindings.begin();
+  Sql_script::Merged_statements::const_iterator merged_statements = sql_script.merged_statements.begin();
+
+  // Only statements with bound blobs need to be prepared. All others go through a single plain statement, which
+  // avoids the extra prepare round trip per statement.
+  std::unique_ptr<sql::Statement> plain_stmt;
   std::unique_ptr<sql::PreparedStatement> stmt;
+  auto execute_plain = [&](const std::string &sql) {
+    if (!plain_stmt)
+      plain_stmt.reset(conn->ref->createStatement());
+    plain_stmt->executeUpdate(sql);
+  };
+  auto report_error = [&](const sql::SQLException &e, const std::string &sql) {
+    ++err_count;
+    msg = strfmt("%i: %s", e.getErrorCode(), e.what());
+    on_sql_script_run_error(e.getErrorCode(), msg, sql);
+  };
+  // Errors and statistics refer to single rows, also for statements merged from several of them.
+  auto execute_rows = [&](const Sql_script::Statements &rows) {
+    for (const std::string &row_sql : rows) {
+      try {
+        execute_plain(row_sql);
+      } catch (sql::SQLException &e) {
+        report_error(e, row_sql);
+      }
+      ++processed_statement_count;
+    }
+  };
+
   for (const std::string &sql : sql_script.statements) {
+    const Sql_script::Statements *rows = nullptr;
+    if (sql_script.merged_statements.end() != merged_statements && !merged_statements->empty())
+      rows = &*merged_statements;
+
     try {
-      stmt.reset(conn->ref->prepareStatement(sql));
-      std::list<std::shared_ptr<std::stringstream> > blob_streams;
-      if (sql_script.statements_bindings.end() != sql_bindings) {
+      if (sql_script.statements_bindings.end() == sql_bindings || sql_bindings->empty()) {
+        if (rows != nullptr && skip_transaction) {
+          // Without a transaction a failing multi-row statement may leave part of its rows applied (e.g. for
+          // non-transactional tables), so the rows are sent one by one.
+          execute_rows(*rows);
+        } else {
+          execute_plain(sql);
+          processed_statement_count += rows != nullptr ? (int)rows->size() : 1;
+        }
+      } else {
+        stmt.reset(conn->ref->prepareStatement(sql));
+        std::list<std::shared_ptr<std::stringstream> > blob_streams;
         int bind_var_index = 1;
         for (const sqlite::variant_t &bind_var : *sql_bindings) {
           if (sqlide::is_var_null(bind_var)) {
@@ -566,17 +664,24 @@ void Recordset_cdbc_storage::run_sql_script(const Sql_script &sql_script, bool s
           }
           ++bind_var_index;
         }
+        stmt->executeUpdate();
+        ++processed_statement_count;
       }
-      stmt->executeUpdate();
     } catch (sql::SQLException &e) {
-      ++err_count;
-      msg = strfmt("%i: %s", e.getErrorCode(), e.what());
-      on_sql_script_run_error(e.getErrorCode(), msg, sql);
+      // A failed statement is rolled back as a whole, retrying its rows one by one applies the good ones and
+      // reports each failing row with its own statement.
+      if (rows != nullptr)
+        execute_rows(*rows);
+      else {
+        report_error(e, sql);
+        ++processed_statement_count;
+      }
     }
-    ++processed_statement_count;
     progress_state += progress_state_inc;
     on_sql_script_run_progress(progress_state);
     ++sql_bindings;
+    if (sql_script.merged_statements.end() != merged_statements)
+      ++merged_statements;
   }
   if (err_count) {
     if (!skip_transaction)
@@ -591,6 +696,14 @@ void Recordset_cdbc_storage::run_sql_script(const Sql_script &sql_script, bool s
   }
 }
 
+size_t Recordset_cdbc_storage::max_batch_statement_size() {
+  if (_max_allowed_packet == 0)
+    return 0;
+
+  // Leave some room for the packet header and protocol overhead.
+  return std::max<size_t>(_max_allowed_packet, 16 * 1024) - 4 * 1024;
+}
+
 std::string Recordset_cdbc_storage::decorated_sql_query() {
   std::string sql_query;
   if (!_sql_query.empty())
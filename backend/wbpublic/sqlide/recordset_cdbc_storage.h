@@ -25,6 +25,7 @@
 
 #include "wbpublic_public_interface.h"
 #include "sqlide/recordset_sql_storage.h"
+#include "sqlide/query_trace.h"
 #include "cppdbc.h"
 
 class WBPUBLICBACKEND_PUBLIC_FUNC Recordset_cdbc_storage : public Recordset_sql_storage {
@@ -57,6 +58,7 @@ protected:
 
 protected:
   virtual void run_sql_script(const Sql_script &sql_script, bool skip_transaction);
+  virtual size_t max_batch_statement_size();
 
 public:
   std::string decorated_sql_query(); // adds limit clause if defined by options
@@ -84,6 +86,25 @@ public:
     _reloadable = val;
   }
 
+  // The server's max_allowed_packet, which limits statements merged from row changes. 0 disables merging.
+  void max_allowed_packet(size_t value) {
+    _max_allowed_packet = value;
+  }
+
+  // Fetch results through a forward-only prepared statement, streaming rows instead of buffering the entire result
+  // set on the client.
+  void use_prepared_statement(bool flag) {
+    _use_prepared_statement = flag;
+  }
+  bool use_prepared_statement() const {
+    return _use_prepared_statement;
+  }
+  static std::shared_ptr<sql::PreparedStatement> prepare_forward_only_query(sql::Connection *connection,
+                                                                           const std::string &query);
+
+  // Adds first row, fetch and swap db insert timings of the last unserialize run.
+  void add_fetch_trace(QueryTrace &trace) const;
+
   void set_gather_field_info(bool flag) {
     _gather_field_info = flag;
   }
@@ -100,6 +121,14 @@ private:
   std::vector<FieldInfo> _field_info;
   bool _reloadable; // whether can be reloaded using stored sql query
   bool _gather_field_info;
+  bool _use_prepared_statement = false;
+  size_t _max_allowed_packet = 0;
+
+  // QueryTrace::now() based timings of the last unserialize run.
+  std::int64_t _fetch_start = 0;
+  std::int64_t _first_row = 0;
+  std::int64_t _fetch_end = 0;
+  std::int64_t _swap_insert_time = 0;
 
   size_t determine_pkey_columns(Recordset::Column_names &column_names, Recordset::Column_types &column_types,
                                 Recordset::Column_types &real_column_types);
@@ -66,6 +66,20 @@ std::string PrimaryKeyPredicate::operator()(std::vector<std::shared_ptr<sqlite::
   return predicate;
 }
 
+std::string PrimaryKeyPredicate::single_value(std::vector<std::shared_ptr<sqlite::result> > &data_row_results) {
+  if (_pkey_columns->size() != 1)
+    return "";
+
+  ColumnId col = _pkey_columns->front();
+  size_t partition;
+  ColumnId partition_column = Recordset::translate_data_swap_db_column(col, &partition);
+  sqlite::variant_t v = data_row_results[partition]->get_variant((int)partition_column);
+  if (sqlide::is_var_null(v))
+    return "";
+
+  return boost::apply_visitor(*_qv, (*_column_types)[col], v);
+}
+
 //------------------------------------------------------------------------------
 
 class JsonTypeFinder : public boost::static_visitor<bool> {
@@ -369,6 +383,49 @@ void Recordset_sql_storage::generate_sql_script(const Recordset *recordset, sqli
   if (is_update_script) {
     PrimaryKeyPredicate pkey_pred(&real_column_types, &column_names, &_pkey_columns, &pk_qv);
 
+    // Consecutive inserts of the same columns and consecutive deletes by a single column primary key are merged into
+    // multi-row statements, which saves a round trip per row when applying many changes.
+    const size_t max_batch_size = max_batch_statement_size();
+    const size_t max_batch_rows = 1000;
+    std::string batch_head;
+    std::string batch_tail;
+    std::string batch_items;
+    Sql_script::Statements batch_row_statements;
+    size_t batch_rows = 0;
+
+    auto flush_batch = [&]() {
+      if (batch_rows == 0)
+        return;
+      if (batch_rows == 1) {
+        sql_script.statements.push_back(batch_row_statements.front());
+        sql_script.merged_statements.push_back(Sql_script::Statements());
+      } else {
+        // The single row statements are kept, so a failing batch can be retried row by row.
+        sql_script.statements.push_back(batch_head + batch_items + batch_tail);
+        sql_script.merged_statements.push_back(batch_row_statements);
+      }
+      sql_script.statements_bindings.push_back(Sql_script::Statement_bindings());
+      batch_row_statements.clear();
+      batch_rows = 0;
+    };
+
+    auto add_to_batch = [&](const std::string &head, const std::string &item, const std::string &tail,
+                            const std::string &sql) {
+      if (batch_rows > 0 &&
+          (head != batch_head || batch_rows >= max_batch_rows ||
+           batch_head.size() + batch_items.size() + item.size() + batch_tail.size() + 2 > max_batch_size))
+        flush_batch();
+
+      if (batch_rows == 0) {
+        batch_head = head;
+        batch_tail = tail;
+        batch_items = item;
+      } else
+        batch_items += ", " + item;
+      batch_row_statements.push_back(sql);
+      ++batch_rows;
+    };
+
     std::list<std::shared_ptr<sqlite::query> > data_row_queries(partition_count);
     Recordset::prepare_partition_queries(data_swap_db, "select * from `data%s` where id = ?", data_row_queries);
 
@@ -405,6 +462,7 @@ void Recordset_sql_storage::generate_sql_script(const Recordset *recordset, sqli
         RowId rowid = rs->get_int(1);
         std::string sql;
         Sql_script::Statement_bindings sql_bindings;
+        bool batched = false;
 
         switch (rs->get_int(2)) // action
         {
@@ -414,6 +472,14 @@ void Recordset_sql_storage::generate_sql_script(const Recordset *recordset, sqli
             bind_vars.push_back((int)rowid);
             if (Recordset::emit_partition_queries(data_swap_db, deleted_row_queries, deleted_row_results, bind_vars)) {
               sql = strfmt("DELETE FROM %s WHERE %s", full_table_name.c_str(), pkey_pred(deleted_row_results).c_str());
+
+              std::string pk_value = max_batch_size > 0 ? pkey_pred.single_value(deleted_row_results) : "";
+              if (!pk_value.empty()) {
+                add_to_batch(strfmt("DELETE FROM %s WHERE `%s` IN (", full_table_name.c_str(),
+                                    column_names[_pkey_columns.front()].c_str()),
+                             pk_value, ")", sql);
+                batched = true;
+              }
             }
           } break;
 
@@ -465,10 +531,18 @@ void Recordset_sql_storage::generate_sql_script(const Recordset *recordset, sqli
                 col_names.resize(col_names.size() - 2);
               if (!values.empty())
                 values.resize(values.size() - 2);
-              sql = strfmt("INSERT INTO %s (%s) VALUES (%s)",
-                           _omit_schema_qualifier ? (std::string("`") + table_name() + std::string("`")).c_str()
-                                                  : full_table_name.c_str(),
-                           col_names.c_str(), values.c_str());
+              std::string insert_head = strfmt(
+                "INSERT INTO %s (%s) VALUES ",
+                _omit_schema_qualifier ? (std::string("`") + table_name() + std::string("`")).c_str()
+                                       : full_table_name.c_str(),
+                col_names.c_str());
+              sql = insert_head + "(" + values + ")";
+
+              // Bound blobs travel with the statement, so those rows are sent on their own.
+              if (max_batch_size > 0 && sql_bindings.empty()) {
+                add_to_batch(insert_head, "(" + values + ")", "", sql);
+                batched = true;
+              }
             }
           } break;
 
@@ -515,9 +589,14 @@ void Recordset_sql_storage::generate_sql_script(const Recordset *recordset, sqli
           } break;
         }
 
-        sql_script.statements.push_back(sql);
-        sql_script.statements_bindings.push_back(sql_bindings);
+        if (!batched) {
+          flush_batch();
+          sql_script.statements.push_back(sql);
+          sql_script.statements_bindings.push_back(sql_bindings);
+          sql_script.merged_statements.push_back(Sql_script::Statements());
+        }
       } while (rs->next_row());
+      flush_batch();
     }
   } else {
     std::string col_names;
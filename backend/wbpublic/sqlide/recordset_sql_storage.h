@@ -35,11 +35,14 @@ public:
   typedef std::list<std::string> Statements;
   typedef std::list<sqlite::variant_t> Statement_bindings;
   typedef std::list<Statement_bindings> Statements_bindings;
+  typedef std::list<Statements> Merged_statements;
   Statements statements;
   Statements_bindings statements_bindings;
+  Merged_statements merged_statements; // Per statement the single row statements it was merged from, if any.
   void reset() {
     statements.clear();
     statements_bindings.clear();
+    merged_statements.clear();
   }
 };
 
@@ -74,6 +77,10 @@ protected:
   virtual void generate_inserts(const Recordset *recordset, sqlite::connection *data_swap_db, Sql_script &sql_script);
   virtual void run_sql_script(const Sql_script &sql_script, bool skip_commit) {
   }
+  // Upper limit in bytes for statements merged from several row changes by generate_sql_script, 0 disables merging.
+  virtual size_t max_batch_statement_size() {
+    return 0;
+  }
   virtual void init_variant_quoter(sqlide::QuoteVar &qv) const;
 
 public:
@@ -222,6 +229,8 @@ public:
   PrimaryKeyPredicate(const Recordset::Column_types *column_types, const Recordset::Column_names *column_names,
                       const std::vector<ColumnId> *pkey_columns, sqlide::QuoteVar *qv);
   std::string operator()(std::vector<std::shared_ptr<sqlite::result> > &data_row_results);
+  // Quoted value of a single column primary key, empty for composite keys or NULL values.
+  std::string single_value(std::vector<std::shared_ptr<sqlite::result> > &data_row_results);
 };
 
 #endif /* _RECORDSET_SQL_STORAGE_BE_H_ */
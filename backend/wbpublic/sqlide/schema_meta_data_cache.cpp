@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <sqlite/execute.hpp>
+#include <sqlite/query.hpp>
+#include <sqlite/database_exception.hpp>
+
+#include "base/string_utilities.h"
+#include "base/log.h"
+#include "base/file_utilities.h"
+#include "base/boost_smart_ptr_helpers.h"
+#include "grt/common.h"
+#include "sqlide_generics.h"
+
+#include "schema_meta_data_cache.h"
+
+DEFAULT_LOG_DOMAIN("schema_meta_cache");
+
+// Bump this whenever the table layout below changes. Cache files with a different version are rebuilt.
+static const int CACHE_FORMAT_VERSION = 1;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SchemaMetaDataCache::SchemaMetaDataCache(const std::string &connection_id, const std::string &cache_dir)
+  : _connection_id(connection_id) {
+  std::string path = base::makePath(cache_dir, connection_id) + ".schema_meta";
+  _sqconn = new sqlite::connection(path);
+  sqlite::execute(*_sqconn, "PRAGMA temp_store=MEMORY", true);
+  sqlite::execute(*_sqconn, "PRAGMA synchronous=NORMAL", true);
+
+  logDebug2("Using schema meta data cache file %s\n", path.c_str());
+
+  int version = 0;
+  try {
+    sqlite::query q(*_sqconn, "PRAGMA user_version");
+    if (q.emit()) {
+      std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+      version = res->get_int(0);
+    }
+  } catch (std::exception &exc) {
+    logError("Error reading schema meta data cache version: %s\n", exc.what());
+  }
+
+  if (version != CACHE_FORMAT_VERSION) {
+    logDebug3("Initializing cache\n");
+    init_db();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SchemaMetaDataCache::~SchemaMetaDataCache() {
+  delete _sqconn;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SchemaMetaDataCache::init_db() {
+  static const char *statements[] = {
+    "drop table if exists columns",
+    "drop table if exists objects",
+    "drop table if exists schemas",
+    "create table schemas (name varchar(64) primary key)",
+    "create table objects (schema_name varchar(64), name varchar(64), type int, stamp varchar(64), "
+    "primary key (schema_name, name, type))",
+    "create table columns (schema_name varchar(64), object_name varchar(64), position int, name varchar(64), "
+    "primary key (schema_name, object_name, position))",
+    nullptr
+  };
+
+  logInfo("Initializing schema meta data cache for %s\n", _connection_id.c_str());
+  for (const char **code = statements; *code != nullptr; ++code) {
+    try {
+      sqlite::execute(*_sqconn, *code, true);
+    } catch (std::exception &exc) {
+      logError("Error creating cache %s: %s\n", *code, exc.what());
+      return;
+    }
+  }
+  sqlite::execute(*_sqconn, base::strfmt("PRAGMA user_version = %i", CACHE_FORMAT_VERSION), true);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<std::string> SchemaMetaDataCache::get_schemas() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<std::string> schemas;
+  try {
+    sqlite::query q(*_sqconn, "select name from schemas order by name");
+    if (q.emit()) {
+      std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+      do {
+        schemas.push_back(res->get_string(0));
+      } while (res->next_row());
+    }
+  } catch (std::exception &exc) {
+    logError("Error reading schema list from cache: %s\n", exc.what());
+  }
+  return schemas;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Replaces the cached schema list. Content of schemas which no longer exist on the server is removed as well.
+ */
+void SchemaMetaDataCache::update_schema_list(const std::vector<std::string> &schemas) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  try {
+    sqlide::Sqlite_transaction_guarder transaction(_sqconn);
+    sqlite::execute(*_sqconn, "create temporary table if not exists live_schemas (name varchar(64) primary key)", true);
+    sqlite::execute(*_sqconn, "delete from live_schemas", true);
+    {
+      sqlite::query q(*_sqconn, "insert or ignore into live_schemas values (?)");
+      for (auto &schema : schemas) {
+        q.bind(1, schema);
+        q.emit();
+        q.clear();
+      }
+    }
+    sqlite::execute(*_sqconn, "delete from columns where schema_name not in (select name from live_schemas)", true);
+    sqlite::execute(*_sqconn, "delete from objects where schema_name not in (select name from live_schemas)", true);
+    sqlite::execute(*_sqconn, "delete from schemas", true);
+    sqlite::execute(*_sqconn, "insert into schemas select name from live_schemas", true);
+  } catch (std::exception &exc) {
+    logError("Error storing schema list to cache: %s\n", exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SchemaMetaDataCache::ObjectList SchemaMetaDataCache::get_schema_objects(const std::string &schema) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  ObjectList objects;
+  try {
+    std::map<std::string, Object *> columnOwners;
+    {
+      sqlite::query q(*_sqconn, "select name, type, stamp from objects where schema_name = ? order by type, name");
+      q.bind(1, schema);
+      if (q.emit()) {
+        std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+        do {
+          Object object;
+          object.name = res->get_string(0);
+          object.type = (ObjectType)res->get_int(1);
+          object.stamp = res->get_string(2);
+          objects.push_back(object);
+          if (object.type == Table || object.type == View)
+            columnOwners[object.name] = &objects.back();
+        } while (res->next_row());
+      }
+    }
+
+    sqlite::query q(*_sqconn, "select object_name, name from columns where schema_name = ? order by object_name, position");
+    q.bind(1, schema);
+    if (q.emit()) {
+      std::shared_ptr<sqlite::result> res(BoostHelper::convertPointer(q.get_result()));
+      do {
+        auto owner = columnOwners.find(res->get_string(0));
+        if (owner != columnOwners.end())
+          owner->second->columns.push_back(res->get_string(1));
+      } while (res->next_row());
+    }
+  } catch (std::exception &exc) {
+    logError("Error reading content of schema %s from cache: %s\n", schema.c_str(), exc.what());
+  }
+  return objects;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Replaces everything stored for the given schema by the given object list (in a single transaction).
+ */
+void SchemaMetaDataCache::store_schema_objects(const std::string &schema, const ObjectList &objects) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  try {
+    sqlide::Sqlite_transaction_guarder transaction(_sqconn);
+    {
+      sqlite::query q(*_sqconn, "delete from columns where schema_name = ?");
+      q.bind(1, schema);
+      q.emit();
+    }
+    {
+      sqlite::query q(*_sqconn, "delete from objects where schema_name = ?");
+      q.bind(1, schema);
+      q.emit();
+    }
+    {
+      sqlite::query q(*_sqconn, "insert or ignore into schemas values (?)");
+      q.bind(1, schema);
+      q.emit();
+    }
+
+    sqlite::query objectQuery(*_sqconn, "insert or replace into objects values (?, ?, ?, ?)");
+    sqlite::query columnQuery(*_sqconn, "insert or replace into columns values (?, ?, ?, ?)");
+    for (auto &object : objects) {
+      objectQuery.bind(1, schema);
+      objectQuery.bind(2, object.name);
+      objectQuery.bind(3, (int)object.type);
+      objectQuery.bind(4, object.stamp);
+      objectQuery.emit();
+      objectQuery.clear();
+
+      int position = 0;
+      for (auto &column : object.columns) {
+        columnQuery.bind(1, schema);
+        columnQuery.bind(2, object.name);
+        columnQuery.bind(3, position++);
+        columnQuery.bind(4, column);
+        columnQuery.emit();
+        columnQuery.clear();
+      }
+    }
+  } catch (std::exception &exc) {
+    logError("Error storing content of schema %s to cache: %s\n", schema.c_str(), exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
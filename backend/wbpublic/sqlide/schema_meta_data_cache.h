@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include <sqlite/connection.hpp>
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Local (per connection) store of the schema meta data used for code completion. It keeps the names of schemas,
+ * their tables, views, routines and table/view columns together with a change stamp per table and view, so that the
+ * symbol table can be filled instantly when a connection opens and only changed objects have to be re-read from the
+ * server.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC SchemaMetaDataCache {
+public:
+  enum ObjectType { Table = 0, View = 1, Procedure = 2, Function = 3 };
+
+  struct Object {
+    std::string name;
+    ObjectType type;
+    std::string stamp; // Column count and hash over the I_S.COLUMNS definitions (tables and views only).
+    std::vector<std::string> columns;
+  };
+  typedef std::list<Object> ObjectList;
+
+  SchemaMetaDataCache(const std::string &connection_id, const std::string &cache_dir);
+  virtual ~SchemaMetaDataCache();
+
+  std::vector<std::string> get_schemas();
+  void update_schema_list(const std::vector<std::string> &schemas);
+
+  ObjectList get_schema_objects(const std::string &schema);
+  void store_schema_objects(const std::string &schema, const ObjectList &objects);
+
+private:
+  std::string _connection_id;
+  sqlite::connection *_sqconn;
+  std::mutex _mutex;
+
+  void init_db();
+};
@@ -73,7 +73,9 @@ bool ConnectionLineLayouter::update_start_point() {
   if (_type == ZLine) {
     if (start_item) {
     }
-  } else if (start_item && dynamic_cast<mdc::BoxSideMagnet *>(_linfo.start_connector()->get_connected_magnet())) {
+  } else if (start_item && dynamic_cast<mdc::BoxSideMagnet *>(_linfo.start_connector()->get_connected_magnet()) &&
+             !routing_deferred()) {
+    // While dragging the connector stays on its side, the side is picked again once the drag is finished.
     double angle;
 
     angle =
@@ -91,7 +93,8 @@ bool ConnectionLineLayouter::update_end_point() {
   if (_type == ZLine) {
     if (end_item) {
     }
-  } else if (end_item && dynamic_cast<mdc::BoxSideMagnet *>(_linfo.end_connector()->get_connected_magnet())) {
+  } else if (end_item && dynamic_cast<mdc::BoxSideMagnet *>(_linfo.end_connector()->get_connected_magnet()) &&
+             !routing_deferred()) {
     double angle;
 
     angle =
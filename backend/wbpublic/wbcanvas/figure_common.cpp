@@ -328,6 +328,15 @@ void BaseFigure::unhighlight() {
   set_highlighted(false);
 }
 
+/**
+ * Fills the figure bounds with the given color. Used for the lowest level of detail and the mini view.
+ */
+void BaseFigure::draw_block(mdc::CairoCtx *cr, const Color &color) {
+  cr->set_color(color);
+  cr->rectangle(get_bounds());
+  cr->fill();
+}
+
 void BaseFigure::set_allow_manual_resizing(bool flag) {
   _manual_resizing = flag;
   invalidate_min_sizes();
@@ -67,6 +67,9 @@ namespace wbfig {
     }
 
     void set_color(const base::Color &color);
+    const base::Color &get_color() const {
+      return _back_color;
+    }
     void set_text_color(const base::Color &color);
     void set_font(const mdc::FontSpec &font);
     const mdc::FontSpec &get_font() {
@@ -198,6 +201,8 @@ namespace wbfig {
 
     virtual void set_allow_manual_resizing(bool flag);
 
+    void draw_block(mdc::CairoCtx *cr, const base::Color &color);
+
     boost::signals2::signal<void(base::Rect)> *signal_interactive_resize() {
       return &_signal_interactive_resize;
     }
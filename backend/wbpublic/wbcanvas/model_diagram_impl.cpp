@@ -264,6 +264,16 @@ void model_Diagram::ImplData::update_options(const std::string &key) {
     if (_canvas_view)
       _canvas_view->set_draws_line_hops(model->get_int_option("workbench.physical.Diagram:DrawLineCrossings", 1) == 1);
   }
+  if (key == "workbench.physical.Diagram:DetailTitlesZoom" || key == "workbench.physical.Diagram:DetailBlocksZoom" ||
+      key.empty()) {
+    // Zoom thresholds are stored in percent, below them only titles or plain blocks are drawn.
+    model_Model::ImplData *model = _self->owner()->get_data();
+    if (_canvas_view) {
+      double titles_zoom = model->get_int_option("workbench.physical.Diagram:DetailTitlesZoom", 50) / 100.0;
+      double blocks_zoom = model->get_int_option("workbench.physical.Diagram:DetailBlocksZoom", 25) / 100.0;
+      _canvas_view->set_detail_zoom_levels(titles_zoom, blocks_zoom);
+    }
+  }
 }
 
 void model_Diagram::ImplData::realize_contents() {
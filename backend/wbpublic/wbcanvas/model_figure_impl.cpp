@@ -321,11 +321,7 @@ void model_Figure::ImplData::unhighlight() {
 }
 
 void model_Figure::ImplData::render_mini(mdc::CairoCtx *cr) {
-  Rect rect = get_canvas_item()->get_bounds();
-
-  cr->set_color(Color::parse(*self()->_color));
-  cr->rectangle(rect);
-  cr->fill();
+  dynamic_cast<wbfig::BaseFigure *>(get_canvas_item())->draw_block(cr, Color::parse(*self()->_color));
 }
 
 void model_Figure::ImplData::unrealize() {
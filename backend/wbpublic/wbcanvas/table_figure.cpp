@@ -194,6 +194,56 @@ void Table::set_content_font(const mdc::FontSpec &font) {
   super::set_content_font(font);
 }
 
+/**
+ * Below the zoom thresholds set in the view only the title bar or a plain colored block is drawn, together with
+ * the selection or highlight ring.
+ */
+void Table::repaint(const Rect &clipArea, bool direct) {
+  mdc::CairoCtx *cr = get_view()->cairoctx();
+
+  switch (get_view()->get_detail_level()) {
+    case mdc::DetailBlocks:
+      cr->save();
+      draw_block(cr, _title.get_color());
+      draw_state(cr);
+      cr->restore();
+      reset_needs_render();
+      break;
+
+    case mdc::DetailTitles:
+      cr->save();
+      stroke_outline(cr);
+      cr->set_line_width(1.0);
+      cr->set_color(Color::white());
+      cr->fill_preserve();
+      cr->set_color(_border_color);
+      cr->stroke();
+      draw_state(cr);
+
+      cr->translate(get_position());
+      _title.render(cr);
+      cr->restore();
+      reset_needs_render();
+      break;
+
+    default:
+      super::repaint(clipArea, direct);
+      break;
+  }
+}
+
+/**
+ * The content cache isn't used at the reduced detail levels. Any pending change would otherwise keep
+ * _needs_render set, and set_needs_render() only queues a repaint when the flag goes from false to true.
+ * Drop the outdated cache instead, so it gets rebuilt once the full detail level is used again.
+ */
+void Table::reset_needs_render() {
+  if (_needs_render) {
+    invalidate_cache();
+    _needs_render = false;
+  }
+}
+
 void Table::set_show_flags(bool flag) {
   _show_flags = flag;
 }
@@ -158,6 +158,8 @@ namespace wbfig {
     virtual void set_max_columns_shown(int count) {
     }
 
+    virtual void repaint(const base::Rect &clipArea, bool direct);
+
   protected:
     mdc::RectangleFigure _background;
     boost::signals2::signal<void(int, bool)> _signal_index_crossed;
@@ -180,6 +182,8 @@ namespace wbfig {
 
     bool compare_connection_position(mdc::Connector *a, mdc::Connector *b, mdc::BoxSideMagnet::Side vertical);
 
+    void reset_needs_render();
+
     virtual bool get_expanded() {
       return true;
     }
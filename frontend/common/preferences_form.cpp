@@ -827,6 +827,13 @@ mforms::View *PreferencesForm::create_sqlide_page() {
     entry = otable->add_entry_option("DbSqlEditor:ConnectionTimeOut",
                                      _("DBMS connection timeout interval (in seconds):"), "Timout Interval",
                                      _("Maximum time to wait before a connection attempt is aborted."));
+
+    entry = otable->add_entry_option("DbSqlEditor:MetadataConnectionPoolSize",
+                                     _("Meta data connections:"), "Meta Data Connections",
+                                     _("Number of additional read only connections used to load schema contents in "
+                                       "parallel. Set to 0 to load them over the single auxiliary connection. "
+                                       "Changing this option requires a reconnection."));
+    entry->set_size(100, -1);
     box->add(otable, false, true);
   }
 
@@ -988,6 +995,15 @@ mforms::View *PreferencesForm::create_editor_page() {
             "code editor configuration file. With this swich they are always upper-cased instead."));
         subsettings_box->add(upper_case_check, false);
 
+        mforms::CheckBox *cache_check = new_checkbox_option("DbSqlEditor:CodeCompletionCacheEnabled");
+        cache_check->set_text(_("Cache schema meta data between sessions"));
+        cache_check->set_name("Cache Schema Meta Data");
+        cache_check->set_tooltip(
+          _("Stores the names of schemas, tables, columns and routines in a local file per connection, so that "
+            "code completion can offer them immediately after connecting. Only objects that changed on the server "
+            "are re-read. Takes effect for new connections."));
+        subsettings_box->add(cache_check, false);
+
         // Set initial enabled state of sub settings depending on whether code completion is enabled.
         std::string value;
         wb::WBContextUI::get()->get_wb_options_value(_model.is_valid() ? _model.id() : "",
@@ -1224,6 +1240,17 @@ mforms::View *PreferencesForm::create_query_page() {
       tbox->add(entry, false, false);
     }
 
+    {
+      mforms::CheckBox *check = new_checkbox_option("DbSqlEditor:ForwardOnlyPreparedExecution");
+      check->set_text(_("Run SELECT queries as forward-only prepared statements"));
+      check->set_name("Forward Only Prepared Execution");
+      check->set_tooltip(
+        _("Run single SELECT queries as prepared statements and read their rows forward only, one by one as the "
+          "server sends them, instead of buffering the complete result on the client first. This lowers memory use "
+          "for large results."));
+      vbox->add(check, false);
+    }
+
     {
       mforms::Box *tbox = mforms::manage(new mforms::Box(true));
       tbox->set_spacing(4);
@@ -1369,6 +1396,19 @@ mforms::View* PreferencesForm::createSSHPage()
           _("SSH Read/Write Timeout in seconds."));
       }
 
+      // SSH session reuse
+      {
+        mforms::TextEntry *entry = new_numeric_entry_option("SSH:sessionIdleTimeout", 0, 3600);
+        entry->set_max_length(5);
+        entry->set_size(50, -1);
+        entry->set_tooltip(_(
+          "Tunnels and remote administration to the same host and account share one SSH session.\n"
+          "Unused sessions are kept open this long to be reused, 0 closes them right away."));
+
+        timeouts_table->add_option(entry, _("SSH Session Idle Timeout:"), "SSH Session Idle Timeout",
+          _("Time in seconds an unused SSH session is kept open."));
+      }
+
       // SSH commandtimeout
       {
         mforms::TextEntry *entry = new_numeric_entry_option("SSH:commandTimeout", 0, 500);
@@ -1415,6 +1455,27 @@ mforms::View* PreferencesForm::createSSHPage()
           _("The maximum file that is allowed to be transfered by SSH."));
       }
 
+      // SFTP transfer pipelining
+      {
+        mforms::TextEntry *entry = new_numeric_entry_option("SSH:sftpRequests", 1, 256);
+        entry->set_max_length(3);
+        entry->set_size(50, -1);
+        entry->set_tooltip(_("Number of read requests kept in flight when downloading files"));
+
+        timeouts_table->add_option(entry, _("SFTP Requests in Flight:"), "SFTP Requests in Flight",
+          _("Number of outstanding read requests for SFTP downloads, 1 reads synchronously."));
+      }
+
+      {
+        mforms::TextEntry *entry = new_numeric_entry_option("SSH:sftpChunkSize", 1024, 255 * 1024);
+        entry->set_max_length(6);
+        entry->set_size(50, -1);
+        entry->set_tooltip(_("Size of each SFTP read or write request"));
+
+        timeouts_table->add_option(entry, _("SFTP Chunk Size:"), "SFTP Chunk Size",
+          _("SFTP transfer chunk size in bytes."));
+      }
+
       // SSH logsize
       {
         mforms::TextEntry *entry = new_numeric_entry_option("SSH:logSize", 0, 1024*ONE_MB);
@@ -1810,6 +1871,36 @@ mforms::View *PreferencesForm::create_diagram_page() {
         "updated"));
     vbox->add(check, false);
 
+    {
+      mforms::Box *hbox = mforms::manage(new mforms::Box(true));
+      mforms::TextEntry *entry = new_numeric_entry_option("workbench.physical.Diagram:DetailTitlesZoom", 0, 100);
+
+      hbox->set_spacing(4);
+      entry->set_max_length(3);
+      entry->set_size(50, -1);
+      entry->set_tooltip(_("Below this zoom level (in percent) table figures only show their title bar"));
+
+      hbox->add(new_label(_("Show Only Titles Below Zoom (%):"), "Titles Only Zoom", true), false, false);
+      hbox->add(entry, false);
+
+      vbox->add(hbox, false);
+    }
+
+    {
+      mforms::Box *hbox = mforms::manage(new mforms::Box(true));
+      mforms::TextEntry *entry = new_numeric_entry_option("workbench.physical.Diagram:DetailBlocksZoom", 0, 100);
+
+      hbox->set_spacing(4);
+      entry->set_max_length(3);
+      entry->set_size(50, -1);
+      entry->set_tooltip(_("Below this zoom level (in percent) table figures are drawn as plain colored blocks"));
+
+      hbox->add(new_label(_("Show Only Blocks Below Zoom (%):"), "Blocks Only Zoom", true), false, false);
+      hbox->add(entry, false);
+
+      vbox->add(hbox, false);
+    }
+
     box->add(frame, false);
   }
 
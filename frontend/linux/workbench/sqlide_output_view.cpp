@@ -89,6 +89,7 @@ QueryOutputView::QueryOutputView(const SqlEditorForm::Ref& be, DbSqlEditorView*
   : _be(be),
     _top_box(Gtk::ORIENTATION_VERTICAL),
     _action_output(be->log(), true, false),
+    _history_page(Gtk::ORIENTATION_VERTICAL),
     _history_box(Gtk::ORIENTATION_HORIZONTAL),
     _entries_grid(be->history()->entries_model(), true, false),
     _details_grid(be->history()->details_model(), true, false),
@@ -180,11 +181,20 @@ QueryOutputView::QueryOutputView(const SqlEditorForm::Ref& be, DbSqlEditorView*
   _history_box.pack1(_entries_swnd, Gtk::FILL);
   _entries_swnd.set_size_request(100, -1);
   _history_box.pack2(_details_swnd, Gtk::EXPAND);
-  _history_box.show_all();
+
+  _history_search.set_placeholder_text("Search history");
+  _history_search.set_icon_from_icon_name("edit-find", Gtk::ENTRY_ICON_PRIMARY);
+  _history_search.set_name("History Search");
+  copy_accessibility_name(_history_search);
+  _history_search.signal_changed().connect(sigc::mem_fun(this, &QueryOutputView::on_history_search_changed));
+
+  _history_page.pack_start(_history_search, false, true);
+  _history_page.pack_start(_history_box, true, true);
+  _history_page.show_all();
 
   _note.append_page(_action_swnd, sections[0]);
   _note.append_page(_text_swnd, sections[1]);
-  _note.append_page(_history_box, sections[2]);
+  _note.append_page(_history_page, sections[2]);
   _note.show_all();
 
   _note.set_show_tabs(false);
@@ -300,6 +310,13 @@ void QueryOutputView::on_history_entries_selection_changed() {
   }
 }
 
+//------------------------------------------------------------------------------
+void QueryOutputView::on_history_search_changed() {
+  _be->history()->set_filter(_history_search.get_text());
+  _entries_grid.refresh(false);
+  _details_grid.refresh(false);
+}
+
 //------------------------------------------------------------------------------
 void QueryOutputView::output_menu_will_show() {
   std::vector<int> sel_indices = _action_output.get_selected_rows();
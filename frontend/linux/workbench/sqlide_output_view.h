@@ -32,6 +32,7 @@
 #include <gtkmm/box.h>
 #include <gtkmm/notebook.h>
 #include <gtkmm/comboboxtext.h>
+#include <gtkmm/entry.h>
 #include <gtkmm/paned.h>
 #include <gtkmm/textview.h>
 
@@ -56,6 +57,7 @@ private:
   int on_history_entries_refresh();
   int on_history_details_refresh();
   void on_history_entries_selection_changed();
+  void on_history_search_changed();
   bool on_query_tooltip(int x, int y, bool keyboard_tooltip, const Glib::RefPtr<Gtk::Tooltip>& tooltip);
 
   void output_menu_will_show();
@@ -77,6 +79,8 @@ private:
   Gtk::ScrolledWindow _action_swnd;
 
   // History output
+  Gtk::Box _history_page;
+  Gtk::Entry _history_search;
   Gtk::Paned _history_box;
   Gtk::ScrolledWindow _entries_swnd;
   GridView _entries_grid;
@@ -391,6 +391,18 @@ public:
    * \return 
    */
   virtual grt::IntegerRef seek(ssize_t offset);
+  /**
+   * Method. read the last count bytes of the file and move the file's position to its end.
+   * \param count 
+   * \return 
+   */
+  virtual grt::StringRef tailBytes(ssize_t count);
+  /**
+   * Method. read the last count lines of the file and move the file's position to its end.
+   * \param count 
+   * \return 
+   */
+  virtual grt::StringRef tailLines(ssize_t count);
   /**
    * Method. return the file's current position.
    * \return 
@@ -421,6 +433,10 @@ private: // Wrapper methods for use by the grt.
 
   static grt::ValueRef call_seek(grt::internal::Object *self, const grt::BaseListRef &args){ return dynamic_cast<db_mgmt_SSHFile*>(self)->seek(grt::IntegerRef::cast_from(args[0])); }
 
+  static grt::ValueRef call_tailBytes(grt::internal::Object *self, const grt::BaseListRef &args){ return dynamic_cast<db_mgmt_SSHFile*>(self)->tailBytes(grt::IntegerRef::cast_from(args[0])); }
+
+  static grt::ValueRef call_tailLines(grt::internal::Object *self, const grt::BaseListRef &args){ return dynamic_cast<db_mgmt_SSHFile*>(self)->tailLines(grt::IntegerRef::cast_from(args[0])); }
+
   static grt::ValueRef call_tell(grt::internal::Object *self, const grt::BaseListRef &args){ return dynamic_cast<db_mgmt_SSHFile*>(self)->tell(); }
 
 public:
@@ -433,6 +449,8 @@ public:
     meta->bind_method("read", &db_mgmt_SSHFile::call_read);
     meta->bind_method("readline", &db_mgmt_SSHFile::call_readline);
     meta->bind_method("seek", &db_mgmt_SSHFile::call_seek);
+    meta->bind_method("tailBytes", &db_mgmt_SSHFile::call_tailBytes);
+    meta->bind_method("tailLines", &db_mgmt_SSHFile::call_tailLines);
     meta->bind_method("tell", &db_mgmt_SSHFile::call_tell);
   }
 };
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "connection_pool.h"
+
+#include "cppconn/exception.h"
+#include "base/log.h"
+#include "base/string_utilities.h"
+#include "base/util_functions.h"
+#include "grt.h"
+
+DEFAULT_LOG_DOMAIN("ConnectionPool")
+
+// Connections which were idle for longer than this (in seconds) are checked before being handed out again.
+static const double VALIDATION_IDLE_TIME = 30;
+
+namespace sql {
+
+  ConnectionPool::Lease::Lease(Ref pool, Dbc_connection_handler::Ref connection)
+    : _pool(pool), _connection(connection) {
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  ConnectionPool::Lease::Lease(Lease &&other)
+    : _pool(std::move(other._pool)), _connection(std::move(other._connection)), _reusable(other._reusable) {
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  ConnectionPool::Lease &ConnectionPool::Lease::operator=(Lease &&other) {
+    if (this != &other) {
+      release();
+      _pool = std::move(other._pool);
+      _connection = std::move(other._connection);
+      _reusable = other._reusable;
+    }
+    return *this;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  ConnectionPool::Lease::~Lease() {
+    release();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  void ConnectionPool::Lease::release() {
+    if (_pool && _connection)
+      _pool->release(_connection, _reusable);
+    _pool.reset();
+    _connection.reset();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  ConnectionPool::Ref ConnectionPool::create(const std::string &name, size_t max_size, ConnectSlot connect) {
+    return Ref(new ConnectionPool(name, max_size, connect));
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  ConnectionPool::ConnectionPool(const std::string &name, size_t max_size, ConnectSlot connect)
+    : _name(name), _max_size(std::max<size_t>(1, max_size)), _connect(connect) {
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  ConnectionPool::~ConnectionPool() {
+    close();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Returns a connection for exclusive use by the caller. Blocks while all connections of the pool are in use.
+   * Throws if the pool was closed or no connection could be opened.
+   */
+  ConnectionPool::Lease ConnectionPool::acquire() {
+    double start = base::timestamp();
+    Dbc_connection_handler::Ref connection;
+    bool validate = false;
+
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _available.wait(lock, [this]() { return _closed || !_idle.empty() || _open_count < _max_size; });
+      if (_closed)
+        throw grt::db_not_connected("Connection pool " + _name + " has been closed");
+
+      if (!_idle.empty()) {
+        connection = _idle.back().connection;
+        validate = start - _idle.back().since > VALIDATION_IDLE_TIME;
+        _idle.pop_back();
+      } else {
+        connection = std::make_shared<Dbc_connection_handler>();
+        connection->name = base::strfmt("%s #%i", _name.c_str(), (int)_open_count + 1);
+        ++_open_count;
+      }
+
+      ++_in_use;
+      ++_acquire_count;
+      _peak_in_use = std::max(_peak_in_use, _in_use);
+
+      double wait = base::timestamp() - start;
+      if (wait > 0.001) {
+        ++_wait_count;
+        _total_wait += wait;
+        _max_wait = std::max(_max_wait, wait);
+        logDebug2("%s: waited %.1f ms for a connection (%i of %i in use)\n", _name.c_str(), wait * 1000, (int)_in_use,
+                  (int)_max_size);
+      }
+    }
+
+    // Opening and checking connections can take a while, so do this without holding the lock.
+    try {
+      bool valid = connection->ref.get() != nullptr;
+      if (valid && validate) {
+        try {
+          valid = connection->ref->isValid();
+        } catch (std::exception &) {
+          valid = false;
+        }
+      }
+
+      if (!valid) {
+        logDebug2("%s: opening connection %s\n", _name.c_str(), connection->name.c_str());
+        _connect(connection);
+      }
+    } catch (...) {
+      release(connection, false);
+      throw;
+    }
+
+    return Lease(shared_from_this(), connection);
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  void ConnectionPool::release(Dbc_connection_handler::Ref connection, bool reusable) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      --_in_use;
+      if (!_closed && reusable && connection->ref.get() != nullptr) {
+        _idle.push_back({ connection, base::timestamp() });
+        connection.reset();
+      } else
+        --_open_count;
+    }
+    _available.notify_one();
+
+    if (connection)
+      close_connection(connection);
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Closes all idle connections and makes further acquire() calls fail. Connections in use are closed when
+   * they are returned.
+   */
+  void ConnectionPool::close() {
+    std::vector<IdleConnection> idle;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_closed)
+        return;
+      _closed = true;
+      _open_count -= _idle.size();
+      idle.swap(_idle);
+    }
+    _available.notify_all();
+
+    for (auto &entry : idle)
+      close_connection(entry.connection);
+
+    log_statistics();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  void ConnectionPool::log_statistics() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    logInfo("%s: %i requests, peak %i of %i connections in use, %i requests waited (avg %.1f ms, max %.1f ms)\n",
+            _name.c_str(), (int)_acquire_count, (int)_peak_in_use, (int)_max_size, (int)_wait_count,
+            _wait_count > 0 ? _total_wait * 1000 / _wait_count : 0.0, _max_wait * 1000);
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  void ConnectionPool::close_connection(Dbc_connection_handler::Ref &connection) {
+    if (connection->ref.get() != nullptr) {
+      try {
+        connection->ref->close();
+      } catch (sql::SQLException &) {
+        // Ignore errors for connections that are already gone.
+      }
+      connection->ref.reset();
+    }
+  }
+
+} // namespace sql
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#ifndef _CONNECTION_POOL_H_
+#define _CONNECTION_POOL_H_
+
+#include "cppdbc_public_interface.h"
+#include "driver_manager.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sql {
+
+  // A bounded set of connections to one server, handed out to one user at a time. Meant for (read only) meta data
+  // queries which can run in parallel, like loading the content of several schemas at once. Connections are opened
+  // on demand, up to the maximum size. Callers block in acquire() while all connections are in use.
+  class CPPDBC_PUBLIC_FUNC ConnectionPool : public std::enable_shared_from_this<ConnectionPool> {
+  public:
+    typedef std::shared_ptr<ConnectionPool> Ref;
+
+    // Called to open (or re-open) the connection of the given handler. Should throw on error.
+    typedef std::function<void(Dbc_connection_handler::Ref &)> ConnectSlot;
+
+    // Gives access to a pooled connection and returns it to the pool when going out of scope.
+    class CPPDBC_PUBLIC_FUNC Lease {
+    public:
+      Lease() {
+      }
+      Lease(Lease &&other);
+      Lease &operator=(Lease &&other);
+      ~Lease();
+
+      Lease(const Lease &) = delete;
+      Lease &operator=(const Lease &) = delete;
+
+      Dbc_connection_handler::Ref connection() const {
+        return _connection;
+      }
+      Dbc_connection_handler *operator->() const {
+        return _connection.get();
+      }
+
+      // Call when the connection reported an error. It is then closed instead of going back to the pool.
+      void discard() {
+        _reusable = false;
+      }
+
+    private:
+      friend class ConnectionPool;
+      Lease(Ref pool, Dbc_connection_handler::Ref connection);
+      void release();
+
+      Ref _pool;
+      Dbc_connection_handler::Ref _connection;
+      bool _reusable = true;
+    };
+
+    static Ref create(const std::string &name, size_t max_size, ConnectSlot connect);
+    ~ConnectionPool();
+
+    Lease acquire();
+    void close();
+
+    size_t max_size() const {
+      return _max_size;
+    }
+    void log_statistics();
+
+  private:
+    struct IdleConnection {
+      Dbc_connection_handler::Ref connection;
+      double since;
+    };
+
+    ConnectionPool(const std::string &name, size_t max_size, ConnectSlot connect);
+    void release(Dbc_connection_handler::Ref connection, bool reusable);
+    static void close_connection(Dbc_connection_handler::Ref &connection);
+
+    std::string _name;
+    size_t _max_size;
+    ConnectSlot _connect;
+
+    std::mutex _mutex;
+    std::condition_variable _available;
+    std::vector<IdleConnection> _idle;
+    size_t _open_count = 0;
+    size_t _in_use = 0;
+    bool _closed = false;
+
+    // Statistics, written to the log when the pool is closed.
+    size_t _acquire_count = 0;
+    size_t _wait_count = 0;
+    size_t _peak_in_use = 0;
+    double _total_wait = 0;
+    double _max_wait = 0;
+  };
+
+} // namespace sql
+
+#endif // _CONNECTION_POOL_H_
@@ -25,6 +25,7 @@
 #define _CPPDBC_H_
 
 #include "driver_manager.h"
+#include "connection_pool.h"
 #include "sql_batch_exec.h"
 
 #include <cppconn/connection.h>
@@ -184,7 +184,7 @@ namespace sql {
 
   class Dbc_connection_handler {
   public:
-    Dbc_connection_handler() : id(-1), autocommit_mode(true), is_stop_query_requested(false) {
+    Dbc_connection_handler() : id(-1), max_allowed_packet(0), autocommit_mode(true), is_stop_query_requested(false) {
     }
     typedef std::shared_ptr<Dbc_connection_handler> Ref;
     typedef ConnectionWrapper ConnectionRef;
@@ -193,6 +193,7 @@ namespace sql {
     std::int64_t id;
     std::string active_schema;
     std::string ssl_cipher;
+    std::int64_t max_allowed_packet; // Read when the connection is opened, 0 if unknown.
     bool autocommit_mode;
     bool is_stop_query_requested;
   };
@@ -83,6 +83,82 @@ static void findNode(TreeNodeRef parent, const std::string &text, JsonTreeBaseVi
 
 //--------------------------------------------------------------------------------------------------
 
+// Longest string shown in a tree or grid cell, the complete value stays in the document.
+static const size_t MaxStringPreviewLength = 1024;
+
+// Upper limit of matches collected by a single search, to keep memory bounded for very unspecific search texts.
+static const size_t MaxSearchHits = 10000;
+
+static std::string stringPreview(const char *text, size_t length) {
+  if (length <= MaxStringPreviewLength)
+    return std::string(text, length);
+
+  // Don't cut a multi byte UTF-8 sequence in half.
+  length = MaxStringPreviewLength;
+  while (length > 0 && (text[length] & 0xC0) == 0x80)
+    --length;
+  return std::string(text, length) + "...";
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static std::string stringPreview(const std::string &text) {
+  return stringPreview(text.c_str(), text.size());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Walks the document (instead of the tree nodes, which are only created on demand) and collects the path to
+ * every scalar value whose text contains the search text. Returns false if the search was cancelled.
+ */
+static bool findValues(Value &value, const std::string &text, JsonTreeBaseView::ValuePath &path,
+                       JsonTreeBaseView::ValuePathList &hits, const std::atomic<bool> &cancelled) {
+  if (cancelled || hits.size() >= MaxSearchHits)
+    return !cancelled;
+
+  path.push_back(&value);
+  bool match = false;
+  switch (value.GetType()) {
+    case kObjectType:
+      for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
+        if (!findValues(it->value, text, path, hits, cancelled))
+          return false;
+      }
+      break;
+    case kArrayType:
+      for (auto &item : value.GetArray()) {
+        if (!findValues(item, text, path, hits, cancelled))
+          return false;
+      }
+      break;
+    case kStringType:
+      match = base::contains_string(std::string(value.GetString(), value.GetStringLength()), text, false);
+      break;
+    case kNumberType:
+      if (value.IsDouble())
+        match = base::contains_string(std::to_string(value.GetDouble()), text, false);
+      else if (value.IsInt64())
+        match = base::contains_string(std::to_string(value.GetInt64()), text, false);
+      else if (value.IsUint64())
+        match = base::contains_string(std::to_string(value.GetUint64()), text, false);
+      break;
+    case kFalseType:
+    case kTrueType:
+      match = base::contains_string(value.GetBool() ? "true" : "false", text, false);
+      break;
+    default:
+      break;
+  }
+
+  if (match)
+    hits.push_back(path);
+  path.pop_back();
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 static std::string getParseErrorText(ParseErrorCode code) {
   std::string text = "No error.";
   switch (code) {
@@ -146,6 +222,32 @@ static std::string getParseErrorText(ParseErrorCode code) {
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * SAX handler which only checks the syntax (no DOM is built). Every token is accepted, unless the validation
+ * was cancelled, which makes the reader stop early.
+ */
+struct JsonValidationHandler : public BaseReaderHandler<UTF8<>, JsonValidationHandler> {
+  JsonValidationHandler(const std::atomic<bool> &cancelled) : _cancelled(cancelled) {
+  }
+
+  bool Default() {
+    return !_cancelled;
+  }
+
+  const std::atomic<bool> &_cancelled;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+static ParseResult validateJson(const std::string &text, const std::atomic<bool> &cancelled) {
+  Reader reader;
+  StringStream stream(text.c_str());
+  JsonValidationHandler handler(cancelled);
+  return reader.Parse(stream, handler);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 JsonInputDlg::JsonInputDlg(mforms::Form *owner, bool showTextEntry)
   : mforms::Form(owner, mforms::FormResizable),
     _textEditor(manage(new CodeEditor())),
@@ -351,7 +453,8 @@ void JsonBaseView::clear() {
 
 //--------------------------------------------------------------------------------------------------
 
-JsonTreeBaseView::JsonTreeBaseView(rapidjson::Document &doc) : JsonBaseView(doc), _useFilter(false), _searchIdx(0) {
+JsonTreeBaseView::JsonTreeBaseView(rapidjson::Document &doc)
+  : JsonBaseView(doc), _useFilter(false), _searchIdx(0), _rootValue(nullptr), _searchPending(false) {
   _contextMenu = mforms::manage(new mforms::ContextMenu());
   _contextMenu->signal_will_show()->connect(std::bind(&JsonTreeBaseView::prepareMenu, this));
 }
@@ -403,6 +506,7 @@ void JsonTreeBaseView::handleMenuCommand(const std::string &command) {
     return;
   }
   if (command == "delete_doc") {
+    cancelSearch();
     auto data = dynamic_cast<JsonValueNodeData *>(node->get_data());
     if (data != nullptr) {
       auto &jv = data->getData();
@@ -454,6 +558,7 @@ void JsonTreeBaseView::openInputJsonWindow(TreeNodeRef node, bool updateMode /*=
       dlg.setJson(jv);
     }
     if (dlg.run()) {
+      cancelSearch();
       Value value;
       value.CopyFrom(dlg.data(), _document.GetAllocator());
       auto objectName = dlg.objectName();
@@ -465,6 +570,7 @@ void JsonTreeBaseView::openInputJsonWindow(TreeNodeRef node, bool updateMode /*=
           }
           auto newNode = (updateMode) ? node : node->add_child();
           generateTree(objectName.empty() ? jv : jv[objectName], 0, newNode);
+          populateNode(newNode);
           newNode->set_string(0, objectName + "{" + std::to_string(jv.MemberCount()) + "}");
           newNode->set_tag(objectName);
           _dataChanged(false);
@@ -480,6 +586,7 @@ void JsonTreeBaseView::openInputJsonWindow(TreeNodeRef node, bool updateMode /*=
           }
           auto newNode = (updateMode) ? node : node->add_child();
           generateTree((updateMode) ? jv : *(jv.End()-1), 0, newNode);
+          populateNode(newNode);
           newNode->set_string(0, objectName + "[" + std::to_string(jv.Size()) + "]");
           _dataChanged(false);
           break;
@@ -494,13 +601,37 @@ void JsonTreeBaseView::openInputJsonWindow(TreeNodeRef node, bool updateMode /*=
 //--------------------------------------------------------------------------------------------------
 
 JsonTreeBaseView::~JsonTreeBaseView() {
+  cancelSearch();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Stops a running background search and waits for it. Must be called before the document is modified or released,
+ * since the search works directly on the document values.
+ */
+void JsonTreeBaseView::cancelSearch() {
+  if (_searchCancelled)
+    *_searchCancelled = true;
+  if (_searchTask.valid())
+    _searchTask.wait();
+  _searchCancelled.reset();
+  _searchPending = false;
+  _searchHits.clear();
+  _textToFind = "";
+  _searchIdx = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeBaseView::populateNode(TreeNodeRef /*node*/) {
+  // Views which create all nodes upfront have nothing to do here.
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void JsonTreeBaseView::generateStringInTree(rapidjson::Value &value, int columnId, TreeNodeRef node) {
-  auto text = value.GetString();
-  setStringData(columnId, node, text);
+  setStringData(columnId, node, stringPreview(value.GetString(), value.GetStringLength()));
   node->set_data(new JsonTreeBaseView::JsonValueNodeData(value));
   node->expand();
 }
@@ -562,9 +693,10 @@ void JsonTreeBaseView::reCreateTree(Value &value) {
   _treeView->clear();
   auto node = _treeView->root_node()->add_child();
   _treeView->BeginUpdate();
-  Value o(kObjectType);
-  o.CopyFrom(value, _document.GetAllocator());
+  _rootValue = &value;
   generateTree(value, 0, node);
+  populateNode(node);
+  node->expand();
   _treeView->EndUpdate();
 }
 
@@ -636,7 +768,9 @@ void JsonTreeBaseView::generateTree(rapidjson::Value &value, int columnId, TreeN
 void JsonTreeBaseView::setCellValue(mforms::TreeNodeRef node, int column, const std::string &value) {
   auto data = dynamic_cast<JsonValueNodeData *>(node->get_data());
   bool setData = false;
+  bool isString = false;
   if (data != nullptr) {
+    cancelSearch();
     std::stringstream buffer;
     double number = 0;
     auto &storedValue = data->getData();
@@ -661,37 +795,35 @@ void JsonTreeBaseView::setCellValue(mforms::TreeNodeRef node, int column, const
         storedValue = Value(value, _document.GetAllocator()).Move();
         setStringData(column, node, value);
         setData = true;
+        isString = true;
         break;
       default:
         break;
     }
   }
   if (setData) {
-    node->set_string(column, value);
+    if (!isString) // Strings were set as preview already.
+      node->set_string(column, value);
     _dataChanged(false);
   }
 }
 
 //--------------------------------------------------------------------------------------------------
 
-JsonTextView::JsonTextView(Document &doc)
-  : JsonBaseView(doc), _textEditor(manage(new CodeEditor())), _modified(false), _position(0) {
+JsonTextView::JsonTextView(Document &doc) : JsonBaseView(doc), _textEditor(manage(new CodeEditor())), _modified(false) {
   init();
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void JsonTextView::setText(const std::string &jsonText, bool validateJson /*= true*/) {
+  _assignedText = jsonText;
   _textEditor->set_value(jsonText.c_str());
-  if (validateJson)
-    validate();
   _text = jsonText;
-}
-
-//--------------------------------------------------------------------------------------------------
-
-const Value &JsonTextView::getJson() const {
-  return _json;
+  if (validateJson) {
+    _modified = true;
+    validateInBackground();
+  }
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -703,11 +835,13 @@ const std::string &JsonTextView::getText() const {
 //--------------------------------------------------------------------------------------------------
 
 JsonTextView::~JsonTextView() {
+  cancelValidation();
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void JsonTextView::clear() {
+  _assignedText.clear();
   _textEditor->set_value("");
 }
 
@@ -733,57 +867,103 @@ void JsonTextView::init() {
 
 //--------------------------------------------------------------------------------------------------
 
-void JsonTextView::editorContentChanged(Sci_Position position, Sci_Position length, Sci_Position numberOfLines,
-                                        bool inserted) {
+void JsonTextView::editorContentChanged(Sci_Position /*position*/, Sci_Position /*length*/,
+                                        Sci_Position /*numberOfLines*/, bool /*inserted*/) {
   if (_stopTextProcessing)
     _stopTextProcessing();
+  cancelValidation();
   _modified = true;
-  _position = position;
   _text = _textEditor->get_text(false);
   if (_startTextProcessing) {
     _startTextProcessing([this]() -> bool {
-      _dataChanged(true);
+      validateInBackground();
       return false;
     });
   } else
-    _dataChanged(true);
+    validateInBackground();
 }
 
 //--------------------------------------------------------------------------------------------------
 
-bool JsonTextView::validate() {
-  bool ret = true;
+/**
+ * Checks the current text on a worker thread. The result is applied in the main thread, unless another change
+ * came in meanwhile, in which case the result is stale and dropped. A valid text is reported via _dataChanged,
+ * unless it is the text given to setText(), which is no user edit.
+ */
+void JsonTextView::validateInBackground() {
+  cancelValidation();
+
+  auto cancelled = std::make_shared<std::atomic<bool>>(false);
+  _validationCancelled = cancelled;
+  std::string text = _text;
+  bool edited = text != _assignedText;
+  _validationTask = std::async(std::launch::async, [this, text, edited, cancelled]() {
+    ParseResult result = validateJson(text, *cancelled);
+    if (*cancelled)
+      return;
+    mforms::Utilities::perform_from_main_thread(
+      [this, result, edited, cancelled]() -> void * {
+        if (!*cancelled) {
+          showValidationResult(result);
+          if (!result.IsError() && edited)
+            _dataChanged(true);
+        }
+        return nullptr;
+      },
+      false);
+  });
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTextView::cancelValidation() {
+  if (_validationCancelled)
+    *_validationCancelled = true;
+  if (_validationTask.valid())
+    _validationTask.wait();
+  _validationCancelled.reset();
+}
 
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Validates the current text right away, if it was changed since the last validation.
+ */
+bool JsonTextView::validate() {
   if (_modified) {
-    std::future<std::string> validateFuture = std::async(std::launch::async, [&, this]() -> std::string {
-      _document.Parse(_text);
-      if (_document.HasParseError()) {
-        return getParseErrorText(_document.GetParseError());
-      } else {
-        _json.CopyFrom(_document, _document.GetAllocator());
-      }
-      return "";
-    });
-    validateFuture.wait();
-    auto text = validateFuture.get();
-    if (text.empty()) {
-      _textEditor->remove_markup(LineMarkupAll, -1);
-      _textEditor->remove_indicator(mforms::RangeIndicatorError, 0, _textEditor->text_length());
-      _errorEntry.clear();
-      _modified = false;
-      ret = true;
-    } else {
-      int line = (int)_textEditor->line_from_position(_position);
-      _textEditor->show_markup(LineMarkupError, line);
-      std::size_t posBegin = _textEditor->position_from_line(line);
-      posBegin = _text.find_first_not_of(" \t\r\n", posBegin);
-      std::size_t posEnd = _text.find_first_of("\n\r", posBegin + 1);
-      _textEditor->show_indicator(mforms::RangeIndicatorError, posBegin, posEnd - posBegin);
-      _errorEntry.push_back(JsonErrorEntry{ text, posBegin, posEnd - posBegin });
-      ret = false;
-    }
+    cancelValidation();
+    std::atomic<bool> cancelled(false);
+    showValidationResult(validateJson(_text, cancelled));
   }
-  return ret;
+  return _errorEntry.empty();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTextView::showValidationResult(const ParseResult &result) {
+  // Nothing to reset in the editor if the previous run didn't find an error either.
+  if (!_errorEntry.empty()) {
+    _textEditor->remove_markup(LineMarkupAll, -1);
+    _textEditor->remove_indicator(mforms::RangeIndicatorError, 0, _textEditor->text_length());
+    _errorEntry.clear();
+  }
+
+  if (!result.IsError()) {
+    _modified = false;
+    return;
+  }
+
+  std::size_t line = _textEditor->line_from_position(result.Offset());
+  _textEditor->show_markup(LineMarkupError, line);
+  std::size_t posBegin = _text.find_first_not_of(" \t\r\n", _textEditor->position_from_line(line));
+  if (posBegin == std::string::npos || posBegin > result.Offset())
+    posBegin = result.Offset();
+  std::size_t posEnd = _text.find_first_of("\n\r", posBegin + 1);
+  if (posEnd == std::string::npos)
+    posEnd = _text.size();
+  std::size_t length = posEnd > posBegin ? posEnd - posBegin : 1;
+  _textEditor->show_indicator(mforms::RangeIndicatorError, posBegin, length);
+  _errorEntry.push_back(JsonErrorEntry{ getParseErrorText(result.Code()), posBegin, length });
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -820,6 +1000,8 @@ JsonTreeView::JsonTreeView(Document &doc) : JsonTreeBaseView(doc) {
   _treeView->set_cell_edit_handler(std::bind(&JsonTreeBaseView::setCellValue, this, ph::_1, ph::_2, ph::_3));
   _treeView->set_selection_mode(TreeSelectSingle);
   _treeView->set_context_menu(_contextMenu);
+  scoped_connect(_treeView->signal_expand_toggle(),
+                 std::bind(&JsonTreeView::nodeExpandToggled, this, ph::_1, ph::_2));
   init();
 }
 
@@ -833,35 +1015,81 @@ void JsonTreeView::init() {
 //--------------------------------------------------------------------------------------------------
 
 JsonTreeView::~JsonTreeView() {
+  cancelSearch();
   _treeView->clear();
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void JsonTreeView::clear() {
+  cancelSearch();
   _treeView->clear();
   _viewFindResult.clear();
-  _textToFind = "";
-  _searchIdx = 0;
   _useFilter = false;
+  _rootValue = nullptr;
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void JsonTreeView::setJson(rapidjson::Value &value) {
   clear();
+  _rootValue = &value;
   auto node = _treeView->root_node()->add_child();
   generateTree(value, 0, node);
+  populateNode(node);
+  node->expand();
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void JsonTreeView::appendJson(rapidjson::Value &value) {
   TreeNodeRef node = _treeView->root_node();
+  cancelSearch();
   _viewFindResult.clear();
-  _textToFind = "";
-  _searchIdx = 0;
   generateTree(value, 0, node);
+  populateNode(node);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::nodeExpandToggled(TreeNodeRef node, bool expanded) {
+  if (expanded)
+    populateNode(node);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates the direct children of an object or array node, replacing the placeholder added when the node was
+ * generated. Nodes on the path of a filter result are filled and expanded right away.
+ */
+void JsonTreeView::populateNode(TreeNodeRef node) {
+  auto data = dynamic_cast<JsonValueNodeData *>(node->get_data());
+  if (data == nullptr || data->isPopulated())
+    return;
+
+  auto &value = data->getData();
+  if (!value.IsObject() && !value.IsArray())
+    return;
+
+  data->setPopulated(true);
+  node->remove_children();
+  if (value.IsObject())
+    populateObject(value, node);
+  else
+    populateArray(value, node);
+
+  if (_useFilter) {
+    int count = node->count();
+    for (int i = 0; i < count; ++i) {
+      auto child = node->get_child(i);
+      auto childData = dynamic_cast<JsonValueNodeData *>(child->get_data());
+      if (childData != nullptr && _filterGuard.count(&childData->getData()) > 0) {
+        populateNode(child);
+        child->expand();
+      }
+    }
+  }
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -869,27 +1097,45 @@ void JsonTreeView::appendJson(rapidjson::Value &value) {
 void JsonTreeView::generateObjectInTree(rapidjson::Value &value, int /*columnId*/, TreeNodeRef node, bool addNew) {
   if (_useFilter && _filterGuard.count(&value) == 0)
     return;
-  size_t size = 0;
+
   node->set_data(new JsonTreeBaseView::JsonValueNodeData(value));
+  if (addNew) {
+    node->set_icon_path(0, "JS_Datatype_Object.png");
+    std::string name = node->get_string(0);
+    if (name.empty())
+      node->set_string(0, "<unnamed>");
+    node->set_string(1, "");
+    node->set_string(2, "Object");
+  }
+
+  // Placeholder, so the node can be expanded. The members are created in populateNode().
+  if (value.MemberCount() > 0)
+    node->add_child();
+}
+
+//--------------------------------------------------------------------------------------------------
 
+void JsonTreeView::populateObject(rapidjson::Value &value, TreeNodeRef node) {
   for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
     std::string text = it->name.GetString();
     std::stringstream textSize;
     switch (it->value.GetType()) {
       case kArrayType: {
+        if (_useFilter && _filterGuard.count(&it->value) == 0)
+          continue;
         auto &arrayVal = it->value;
-        size = arrayVal.Size();
         node->set_tag(text);
-        textSize << size;
+        textSize << arrayVal.Size();
         text += "[";
         text += textSize.str();
         text += "]";
         break;
       }
       case kObjectType: {
+        if (_useFilter && _filterGuard.count(&it->value) == 0)
+          continue;
         auto &objectVal = it->value;
-        size = objectVal.MemberCount();
-        textSize << size;
+        textSize << objectVal.MemberCount();
         text += "{";
         text += textSize.str();
         text += "}";
@@ -898,19 +1144,10 @@ void JsonTreeView::generateObjectInTree(rapidjson::Value &value, int /*columnId*
       default:
         break;
     }
-    auto node2 = (addNew) ? node->add_child() : node;
-    if (addNew) {
-      node->set_icon_path(0, "JS_Datatype_Object.png");
-      std::string name = node->get_string(0);
-      if (name.empty())
-        node->set_string(0, "<unnamed>");
-      node->set_string(1, "");
-      node->set_string(2, "Object");
-    }
+    auto node2 = node->add_child();
     node2->set_string(0, text);
     node2->set_tag(text);
     generateTree(it->value, 1, node2);
-    node2->expand();
   }
 }
 
@@ -926,9 +1163,18 @@ void JsonTreeView::generateArrayInTree(rapidjson::Value &value, int /*columnId*/
     node->set_string(0, "<unnamed>");
   node->set_string(1, "");
   node->set_string(2, "Array");
-  std::string tagName = node->get_tag();
   node->set_data(new JsonTreeBaseView::JsonValueNodeData(value));
 
+  // Placeholder, so the node can be expanded. The items are created in populateNode().
+  if (!value.Empty())
+    node->add_child();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::populateArray(rapidjson::Value &value, TreeNodeRef node) {
+  std::string tagName = node->get_tag();
+  std::string keyName = tagName.empty() ? "key[%d]" : tagName + "[%d]";
   int index = 0;
   for (auto &v : value.GetArray()) {
     if (_useFilter && _filterGuard.count(&v) == 0)
@@ -937,13 +1183,158 @@ void JsonTreeView::generateArrayInTree(rapidjson::Value &value, int /*columnId*/
     bool addNew = false;
     if (v.GetType() == kArrayType || v.GetType() == kObjectType)
       addNew = true;
-    std::string keyName = tagName.empty() ? "key[%d]" : tagName + "[%d]";
     arrrayNode->set_string(0, base::strfmt(keyName.c_str(), index));
     arrrayNode->set_string(1, "");
     generateTree(v, 1, arrrayNode, addNew);
     index++;
   }
-  node->expand();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Searches the document in the background. The first call with a new text starts the search and shows the first
+ * match once it finished, later calls cycle through the matches found.
+ */
+void JsonTreeView::highlightMatchNode(const std::string &text, bool backward) {
+  if (text != _textToFind) {
+    cancelSearch();
+    _textToFind = text;
+    if (_rootValue == nullptr || text.empty())
+      return;
+
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    _searchCancelled = cancelled;
+    _searchPending = true;
+    Value *root = _rootValue;
+    _searchTask = std::async(std::launch::async, [this, root, text, cancelled]() {
+      auto hits = std::make_shared<ValuePathList>();
+      ValuePath path;
+      findValues(*root, text, path, *hits, *cancelled);
+      mforms::Utilities::perform_from_main_thread(
+        [this, hits, cancelled]() -> void * {
+          // The view might have moved on (or is gone) in the meantime.
+          if (!*cancelled)
+            searchFinished(*hits);
+          return nullptr;
+        },
+        false);
+    });
+    return;
+  }
+
+  // Results are shown as soon as the running search is done.
+  if (_searchPending || _searchHits.empty())
+    return;
+
+  if (backward)
+    _searchIdx = (_searchIdx + _searchHits.size() - 1) % _searchHits.size();
+  else
+    _searchIdx = (_searchIdx + 1) % _searchHits.size();
+  showSearchHit(_searchHits[_searchIdx]);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::searchFinished(const ValuePathList &hits) {
+  _searchPending = false;
+  _searchHits = hits;
+  _searchIdx = 0;
+  if (!_searchHits.empty())
+    showSearchHit(_searchHits[0]);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Expands only the nodes along the path to the given value and selects it.
+ */
+void JsonTreeView::showSearchHit(const ValuePath &path) {
+  auto node = _treeView->root_node();
+  for (auto value : path) {
+    populateNode(node);
+    TreeNodeRef next;
+    int count = node->count();
+    for (int i = 0; i < count; ++i) {
+      auto child = node->get_child(i);
+      auto data = dynamic_cast<JsonValueNodeData *>(child->get_data());
+      if (data != nullptr && &data->getData() == value) {
+        next = child;
+        break;
+      }
+    }
+    if (!next.is_valid())
+      break; // Hidden by the current filter.
+    if (node != _treeView->root_node())
+      node->expand();
+    node = next;
+  }
+
+  if (node != _treeView->root_node()) {
+    _treeView->select_node(node);
+    _treeView->scrollToNode(node);
+    _treeView->focus();
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Keeps only the branches leading to values which contain the given text. The document is searched directly, so
+ * values in collapsed (not yet created) nodes are found too.
+ */
+bool JsonTreeView::filterView(const std::string &text, rapidjson::Value &value) {
+  Value *start = &value;
+  auto selectedNode = _treeView->get_selected_node();
+  if (selectedNode.is_valid()) {
+    auto data = dynamic_cast<JsonValueNodeData *>(selectedNode->get_data());
+    if (data != nullptr)
+      start = &data->getData();
+  }
+
+  cancelSearch();
+  ValuePathList hits;
+  ValuePath path;
+  std::atomic<bool> cancelled(false);
+  findValues(*start, text, path, hits, cancelled);
+  if (!hits.empty()) {
+    _filterGuard.clear();
+
+    // The path to the search start is part of every result as well.
+    std::function<bool(Value &)> collectStart = [&](Value &current) {
+      if (&current == start)
+        return true;
+      if (current.IsObject()) {
+        for (auto it = current.MemberBegin(); it != current.MemberEnd(); ++it)
+          if (collectStart(it->value)) {
+            _filterGuard.insert(&current);
+            return true;
+          }
+      } else if (current.IsArray()) {
+        for (auto &item : current.GetArray())
+          if (collectStart(item)) {
+            _filterGuard.insert(&current);
+            return true;
+          }
+      }
+      return false;
+    };
+    collectStart(value);
+
+    for (auto &hit : hits)
+      _filterGuard.insert(hit.begin(), hit.end());
+
+    _useFilter = true;
+    _treeView->clear();
+    _rootValue = &value;
+    auto node = _treeView->root_node()->add_child();
+    _treeView->BeginUpdate();
+    generateTree(value, 0, node);
+    populateNode(node);
+    node->expand();
+    _treeView->EndUpdate();
+  }
+  return _useFilter;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1001,7 +1392,7 @@ void JsonTreeView::setStringData(int /*columnId*/, TreeNodeRef node, const std::
     node->set_string(2, "String");
   }
   node->set_attributes(1, mforms::TextAttributes("#4b4a4c", false, false));
-  node->set_string(1, text.c_str());
+  node->set_string(1, stringPreview(text));
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1251,7 +1642,6 @@ void JsonGridView::setCellValue(mforms::TreeNodeRef node, int column, const std:
       case kStringType:
         storedValue.SetString(value, _document.GetAllocator());
         setStringData(column, node, value);
-        node->set_string(column, value);
         _dataChanged(false);
         break;
       default:
@@ -1359,7 +1749,7 @@ void JsonGridView::generateObjectInTree(rapidjson::Value &value, int columnId, T
         generateBoolInTree(it->value, index, child);
         break;
       case kStringType:
-        setStringData(index, child, it->value.GetString());
+        setStringData(index, child, stringPreview(it->value.GetString(), it->value.GetStringLength()));
         break;
       case kNullType:
         generateNullInTree(it->value, index, child);
@@ -1405,7 +1795,7 @@ void JsonGridView::generateArrayInTree(rapidjson::Value &value, int /*columnId*/
         arrrayNode->set_data(new JsonTreeBaseView::JsonValueNodeData(item));
         break;
       case kStringType:
-        setStringData(_noNameColId, arrrayNode, item.GetString());
+        setStringData(_noNameColId, arrrayNode, stringPreview(item.GetString(), item.GetStringLength()));
         arrrayNode->set_data(new JsonTreeBaseView::JsonValueNodeData(item));
         break;
       case kNullType:
@@ -1478,10 +1868,11 @@ void JsonGridView::generateNullInTree(rapidjson::Value &value, int columnId, Tre
 //--------------------------------------------------------------------------------------------------
 
 void JsonGridView::setStringData(int columnId, TreeNodeRef node, const std::string &text) {
-  if (isDateTime(text))
+  std::string preview = stringPreview(text);
+  if (isDateTime(preview))
     node->set_icon_path(0, "JS_Datatype_Date.png");
   node->set_attributes(columnId, mforms::TextAttributes("#4b4a4c", false, false));
-  node->set_string(columnId, text.c_str());
+  node->set_string(columnId, preview);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1509,6 +1900,7 @@ JsonTabView::JsonTabView(bool tabLess, JsonTabViewType defaultView)
     _gridView(manage(new JsonGridView(_document))),
     _tabView(manage(new TabView(tabLess ? TabViewTabless : TabViewPalette))),
     _updating(false),
+    _jsonOutdated(false),
     _defaultView(defaultView) {
   Setup();
 }
@@ -1520,8 +1912,10 @@ JsonTabView::~JsonTabView() {
 
 //--------------------------------------------------------------------------------------------------
 void JsonTabView::setJson(const rapidjson::Value &value) {
+  _treeView->cancelSearch();
   Document d;
   _json.CopyFrom(value, d.GetAllocator());
+  _jsonOutdated = false;
   _ident = 0;
   _updating = true;
   d.CopyFrom(_json, d.GetAllocator());
@@ -1568,10 +1962,12 @@ void JsonTabView::tabChanged() {
     _updating = false;
     _dataChanged(_jsonText);
   } else if (tabId == _tabId.treeViewTabId && _updateView.treeViewUpdate) {
+    updateJson();
     _treeView->reCreateTree(_json);
     _updateView.treeViewUpdate = false;
     _dataChanged(_jsonText);
   } else if (tabId == _tabId.gridViewTabId && _updateView.gridViewUpdate) {
+    updateJson();
     _gridView->reCreateTree(_json);
     _updateView.gridViewUpdate = false;
     _dataChanged(_jsonText);
@@ -1591,9 +1987,10 @@ void JsonTabView::dataChanged(bool forceUpdate) {
     _document.Accept(writer);
     _jsonText = buffer.GetString();
   } else {
+    // The text was validated already (without building a DOM). The DOM is only created once a view needs it.
     if (_textView->validate()) {
       _jsonText = _textView->getText();
-      _json.CopyFrom(_textView->getJson(), _document.GetAllocator());
+      _jsonOutdated = true;
     } else
       return;
   }
@@ -1725,12 +2122,31 @@ const std::string &JsonTabView::text() const {
 
 //--------------------------------------------------------------------------------------------------
 
-const rapidjson::Value &JsonTabView::json() const {
+const rapidjson::Value &JsonTabView::json() {
+  updateJson();
   return _json;
 }
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Parses the text of the text view into the shared document, if it was changed since the last call.
+ */
+void JsonTabView::updateJson() {
+  if (!_jsonOutdated)
+    return;
+
+  _jsonOutdated = false;
+  Document document;
+  document.Parse(_jsonText);
+  if (!document.HasParseError()) {
+    _treeView->cancelSearch();
+    _json.CopyFrom(document, _document.GetAllocator());
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void JsonTabView::setTextProcessingStartHandler(std::function<void(std::function<bool()>)> callback) {
   if (_textView)
     _textView->_startTextProcessing = callback;
@@ -31,6 +31,9 @@
 #include "Scintilla.h"
 
 #include <set>
+#include <atomic>
+#include <future>
+#include <memory>
 #include <functional>
 
 
@@ -99,7 +102,6 @@ namespace mforms {
     void setText(const std::string &jsonText, bool validateJson = true);
     virtual void clear();
     void findAndHighlightText(const std::string &text, bool backward = false);
-    const rapidjson::Value &getJson() const;
     const std::string &getText() const;
     bool validate();
     std::function<void()> _stopTextProcessing;
@@ -114,13 +116,17 @@ namespace mforms {
     void init();
     void editorContentChanged(Sci_Position position, Sci_Position length, Sci_Position numberOfLines, bool inserted);
     void dwellEvent(bool started, size_t position, int x, int y);
+    void validateInBackground();
+    void cancelValidation();
+    void showValidationResult(const rapidjson::ParseResult &result);
 
     CodeEditor *_textEditor;
     bool _modified;
     std::string _text;
-    Sci_Position _position;
-    rapidjson::Value _json;
+    std::string _assignedText; // The text last given to setText(), as opposed to user edits.
     std::vector<JsonErrorEntry> _errorEntry;
+    std::future<void> _validationTask;
+    std::shared_ptr<std::atomic<bool>> _validationCancelled;
   };
 
   class JsonTreeBaseView : public JsonBaseView {
@@ -129,27 +135,39 @@ namespace mforms {
     typedef std::vector<TreeNodeRef> TreeNodeVactor;
     typedef std::map<std::string, TreeNodeVactor> TreeNodeVectorMap;
     struct JsonValueNodeData : public mforms::TreeNodeData {
-      JsonValueNodeData(rapidjson::Value &value) : _jsonValue(value), type(value.GetType()) {
+      JsonValueNodeData(rapidjson::Value &value) : _jsonValue(value), type(value.GetType()), _populated(false) {
       }
       rapidjson::Value& getData() {
         return _jsonValue;
       }
+      // Children of object and array nodes are only created when the node is expanded for the first time.
+      bool isPopulated() const {
+        return _populated;
+      }
+      void setPopulated(bool value) {
+        _populated = value;
+      }
       ~JsonValueNodeData() {
       }
 
     private:
       rapidjson::Value &_jsonValue;
       int type;
+      bool _populated;
     };
+    typedef std::vector<rapidjson::Value *> ValuePath;
+    typedef std::vector<ValuePath> ValuePathList;
     JsonTreeBaseView(rapidjson::Document &doc);
     virtual ~JsonTreeBaseView();
     enum JsonNodeIcons { JsonObjectIcon, JsonArrayIcon, JsonStringIcon, JsonNumericIcon, JsonNullIcon };
     void setCellValue(mforms::TreeNodeRef node, int column, const std::string &value);
-    void highlightMatchNode(const std::string &text, bool bacward = false);
-    bool filterView(const std::string &text, rapidjson::Value &value);
+    virtual void highlightMatchNode(const std::string &text, bool backward = false);
+    virtual bool filterView(const std::string &text, rapidjson::Value &value);
     void reCreateTree(rapidjson::Value &value);
+    void cancelSearch();
 
   protected:
+    virtual void populateNode(TreeNodeRef node);
     void generateTree(rapidjson::Value &value, int columnId, mforms::TreeNodeRef node, bool addNew = true);
     virtual void generateArrayInTree(rapidjson::Value &value, int columnId, TreeNodeRef node) = 0;
     virtual void generateObjectInTree(rapidjson::Value &value, int columnId, TreeNodeRef node, bool addNew) = 0;
@@ -168,6 +186,12 @@ namespace mforms {
     std::string _textToFind;
     size_t _searchIdx;
 
+    rapidjson::Value *_rootValue;
+    ValuePathList _searchHits;
+    bool _searchPending;
+    std::future<void> _searchTask;
+    std::shared_ptr<std::atomic<bool>> _searchCancelled;
+
     TreeView *_treeView;
     ContextMenu *_contextMenu;
 
@@ -187,9 +211,17 @@ namespace mforms {
     void setJson(rapidjson::Value &val);
     void appendJson(rapidjson::Value &val);
     virtual void clear();
+    virtual void highlightMatchNode(const std::string &text, bool backward = false) override;
+    virtual bool filterView(const std::string &text, rapidjson::Value &value) override;
 
   private:
     void init();
+    void nodeExpandToggled(TreeNodeRef node, bool expanded);
+    void populateObject(rapidjson::Value &value, TreeNodeRef node);
+    void populateArray(rapidjson::Value &value, TreeNodeRef node);
+    void searchFinished(const ValuePathList &hits);
+    void showSearchHit(const ValuePath &path);
+    virtual void populateNode(TreeNodeRef node);
     virtual void generateArrayInTree(rapidjson::Value &value, int columnId, TreeNodeRef node);
     virtual void generateObjectInTree(rapidjson::Value &value, int columnId, TreeNodeRef node, bool addNew);
     virtual void generateNumberInTree(rapidjson::Value &value, int columnId, TreeNodeRef node);
@@ -265,12 +297,14 @@ namespace mforms {
     JsonTabViewType getActiveTab() const;
     boost::signals2::signal<void(const std::string &text)> *editorDataChanged();
     const std::string &text() const;
-    const rapidjson::Value &json() const;
+    const rapidjson::Value &json();
 
     void setTextProcessingStartHandler(std::function<void(std::function<bool()>)>);
     void setTextProcessingStopHandler(std::function<void()>);
 
   private:
+    void updateJson();
+
     JsonTextView *_textView;
     JsonTreeView *_treeView;
     JsonGridView *_gridView;
@@ -290,6 +324,7 @@ namespace mforms {
       bool gridViewUpdate;
     } _updateView;
     bool _updating;
+    bool _jsonOutdated;
     std::string _matchText;
     boost::signals2::signal<void(const std::string &text)> _dataChanged;
     JsonTabViewType _defaultView;
@@ -38,6 +38,7 @@
 #include "mdc_item_handle.h"
 #include "mdc_box_handle.h"
 #include "mdc_vertex_handle.h"
+#include "mdc_damage_region.h"
 #include "mdc_layer.h"
 #include "mdc_back_layer.h"
 #include "mdc_interaction_layer.h"
@@ -47,7 +48,9 @@
 #include "mdc_orthogonal_line_layouter.h"
 #include "mdc_polygon.h"
 #include "mdc_rectangle.h"
+#include "mdc_rtree.h"
 #include "mdc_text.h"
+#include "mdc_tile_cache.h"
 #include "mdc_icon_text.h"
 #include "mdc_selection.h"
 #include "mdc_group.h"
@@ -51,6 +51,83 @@ bool mdc::intersect_hv_lines(const Point &s1, const Point &e1, const Point &s2,
   return true;
 }
 
+namespace {
+  enum SweepEventType { HorizontalStart, VerticalSegment, HorizontalEnd };
+
+  struct SweepEvent {
+    double x;
+    SweepEventType type; // Starts are handled before verticals at the same x and ends after them.
+    size_t segment;
+
+    bool operator<(const SweepEvent &other) const {
+      if (x != other.x)
+        return x < other.x;
+      return type < other.type;
+    }
+  };
+
+  typedef std::multimap<double, size_t> ActiveSegments;
+}
+
+std::vector<HVCrossing> mdc::find_hv_crossings(const std::vector<HVSegment> &segments) {
+  std::vector<SweepEvent> events;
+  events.reserve(segments.size() * 2);
+  for (size_t i = 0; i < segments.size(); ++i) {
+    const HVSegment &segment = segments[i];
+    if (segment.start == segment.end)
+      continue;
+
+    if (segment.start.y == segment.end.y) {
+      events.push_back({std::min(segment.start.x, segment.end.x), HorizontalStart, i});
+      events.push_back({std::max(segment.start.x, segment.end.x), HorizontalEnd, i});
+    } else if (segment.start.x == segment.end.x)
+      events.push_back({segment.start.x, VerticalSegment, i});
+  }
+  std::sort(events.begin(), events.end());
+
+  // Changed and unchanged horizontals are kept apart, so unchanged verticals only look at the changed ones.
+  ActiveSegments active[2];
+  std::map<size_t, ActiveSegments::iterator> positions;
+  std::vector<HVCrossing> result;
+
+  for (std::vector<SweepEvent>::const_iterator event = events.begin(); event != events.end(); ++event) {
+    const HVSegment &segment = segments[event->segment];
+    switch (event->type) {
+      case HorizontalStart:
+        positions[event->segment] = active[segment.changed].insert(std::make_pair(segment.start.y, event->segment));
+        break;
+
+      case HorizontalEnd: {
+        std::map<size_t, ActiveSegments::iterator>::iterator position = positions.find(event->segment);
+        active[segment.changed].erase(position->second);
+        positions.erase(position);
+        break;
+      }
+
+      case VerticalSegment: {
+        double top = std::min(segment.start.y, segment.end.y);
+        double bottom = std::max(segment.start.y, segment.end.y);
+        for (int set = segment.changed ? 0 : 1; set < 2; ++set) {
+          ActiveSegments::const_iterator end = active[set].upper_bound(bottom);
+          for (ActiveSegments::const_iterator iter = active[set].lower_bound(top); iter != end; ++iter) {
+            if (segments[iter->second].owner == segment.owner)
+              continue;
+
+            HVCrossing crossing;
+            crossing.horizontal = iter->second;
+            crossing.vertical = event->segment;
+            crossing.point = Point(segment.start.x, iter->first);
+            result.push_back(crossing);
+          }
+        }
+        break;
+      }
+    }
+  }
+
+  return result;
+}
+
 bool mdc::intersect_lines(const Point &s1, const Point &e1, const Point &s2, const Point &e2, Point &intersection_ret) {
   double a1, b1;
   double a2, b2;
@@ -61,6 +61,32 @@ namespace mdc {
   bool MYSQLCANVAS_PUBLIC_FUNC intersect_hv_lines(const base::Point &s1, const base::Point &e1, const base::Point &s2,
                                                   const base::Point &e2, base::Point &intersection_ret);
 
+  /**
+   * A horizontal or vertical line segment, as used by find_hv_crossings().
+   */
+  struct HVSegment {
+    base::Point start;
+    base::Point end;
+    size_t owner; // Segments of the same owner never cross each other.
+    bool changed; // Only crossings with at least one changed segment are reported.
+
+    HVSegment(const base::Point &s, const base::Point &e, size_t o, bool c) : start(s), end(e), owner(o), changed(c) {
+    }
+  };
+
+  struct HVCrossing {
+    size_t horizontal; // Index of the horizontal segment.
+    size_t vertical;   // Index of the vertical segment.
+    base::Point point;
+  };
+
+  /**
+   * Finds all crossings between horizontal and vertical segments with a sweep over the x axis, in
+   * O((n + k) log n) time for n segments and k crossings. End points count, the same as for intersect_hv_lines().
+   * Segments which are neither horizontal nor vertical or which have no length are ignored.
+   */
+  std::vector<HVCrossing> MYSQLCANVAS_PUBLIC_FUNC find_hv_crossings(const std::vector<HVSegment> &segments);
+
   bool MYSQLCANVAS_PUBLIC_FUNC intersect_rect_to_line(const base::Rect &rect, const base::Point &s,
                                                       const base::Point &e, base::Point &intersection1_ret,
                                                       base::Point &intersection2_ret);
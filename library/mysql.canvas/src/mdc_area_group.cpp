@@ -46,7 +46,10 @@ AreaGroup::~AreaGroup() {
 }
 
 void AreaGroup::repaint_contents(const Rect &localClipArea, bool direct) {
-  if (_contents.size() > 0) {
+  // Items outside of the clip area are skipped before anything is set up for drawing. The index returns the
+  // items topmost first, so they are painted in reverse.
+  std::vector<CanvasItem *> items = get_items_in(localClipArea);
+  if (items.size() > 0) {
     CairoCtx *cr = _layer->get_view()->cairoctx();
 
     if (_layer->get_view()->has_gl() && !direct) {
@@ -58,8 +61,8 @@ void AreaGroup::repaint_contents(const Rect &localClipArea, bool direct) {
       cr->translate(get_position());
     }
 
-    for (std::list<CanvasItem *>::reverse_iterator iter = _contents.rbegin(); iter != _contents.rend(); ++iter) {
-      if ((*iter)->get_visible() && (*iter)->intersects(localClipArea))
+    for (std::vector<CanvasItem *>::reverse_iterator iter = items.rbegin(); iter != items.rend(); ++iter) {
+      if ((*iter)->get_visible())
         (*iter)->repaint(localClipArea, direct);
     }
     if (_layer->get_view()->has_gl() && !direct) {
@@ -130,9 +130,7 @@ void CanvasItem::set_bounds(const Rect &rect) {
     _pos = rect.pos;
     _size = rect.size;
 
-    //  _bounds_changed_signal.emit(obounds);
-
-    update_handles();
+    _bounds_changed_signal(obounds);
   }
 }
 
@@ -22,6 +22,7 @@
  */
 
 #include "base/file_utilities.h"
+#include "base/log.h"
 #include "base/threading.h"
 
 #ifndef _MSC_VER
@@ -43,6 +44,8 @@
 
 #include "mdc_line.h"
 
+DEFAULT_LOG_DOMAIN("canvas")
+
 using namespace mdc;
 using namespace base;
 
@@ -50,6 +53,8 @@ using namespace base;
 #define DOUBLE_CLICK_TIME 0.5
 
 #include <stdio.h>
+#include <atomic>
+#include <thread>
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -66,7 +71,14 @@ struct CanvasAutoLock {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-CanvasView::CanvasView(int width, int height) : _fps(0), _total_item_cache_mem(0), _last_click_info(3) {
+CanvasView::CanvasView(int width, int height)
+  : _fps(0),
+    _frame_time_avg(0),
+    _tile_cache(32 * 1024 * 1024, std::bind(&CanvasView::bookkeep_cache_mem, this, std::placeholders::_1)),
+    _rendering_tile(false),
+    _tile_invalidated(false),
+    _total_item_cache_mem(0),
+    _last_click_info(3) {
 
   _page_size = Size(2000, 1500);
   _x_page_num = 1;
@@ -83,6 +95,9 @@ CanvasView::CanvasView(int width, int height) : _fps(0), _total_item_cache_mem(0
   _user_data = 0;
 
   _line_hop_rendering = true;
+  _line_routing_deferred = false;
+  _titles_detail_zoom = 0.5;
+  _blocks_detail_zoom = 0.25;
 
   _crsurface = 0;
   _cairo = 0;
@@ -105,6 +120,8 @@ CanvasView::CanvasView(int width, int height) : _fps(0), _total_item_cache_mem(0
   _destroying = false;
   _debug = false;
 
+  _blayer = 0;
+  _ilayer = 0;
   _blayer = new BackLayer(this);
   _ilayer = new InteractionLayer(this);
 
@@ -116,6 +133,8 @@ CanvasView::CanvasView(int width, int height) : _fps(0), _total_item_cache_mem(0
 //----------------------------------------------------------------------------------------------------------------------
 
 CanvasView::~CanvasView() {
+  _tile_cache.clear();
+
   delete _blayer;
   delete _ilayer;
 
@@ -297,7 +316,10 @@ void CanvasView::scroll_to(const Point &pos) {
 
 void CanvasView::set_zoom(float zoom) {
   if (_zoom != zoom) {
+    DetailLevel old_level = get_detail_level();
     _zoom = zoom;
+    if (get_detail_level() != old_level)
+      invalidate_tiles();
     update_offsets();
     queue_repaint();
 
@@ -513,6 +535,7 @@ void CanvasView::add_layer(Layer *layer) {
 
   _layers.push_front(layer);
 
+  invalidate_tiles();
   queue_repaint();
 }
 
@@ -529,12 +552,14 @@ void CanvasView::remove_layer(Layer *layer) {
     else
       _current_layer = _layers.front();
   }
+  invalidate_tiles();
   queue_repaint();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
 void CanvasView::set_needs_repaint_all_items() {
+  invalidate_tiles();
   for (std::list<mdc::Layer *>::const_iterator iter = _layers.begin(); iter != _layers.end(); ++iter)
     (*iter)->set_needs_repaint_all_items();
 }
@@ -552,6 +577,7 @@ void CanvasView::raise_layer(Layer *layer, Layer *above) {
 
   restack_up(_layers, layer, above);
 
+  invalidate_tiles();
   queue_repaint();
 }
 
@@ -562,6 +588,7 @@ void CanvasView::lower_layer(Layer *layer) {
 
   restack_down(_layers, layer);
 
+  invalidate_tiles();
   queue_repaint();
 }
 
@@ -580,33 +607,198 @@ static bool is_line(CanvasItem *item) {
 
 void CanvasView::set_draws_line_hops(bool flag) {
   _line_hop_rendering = flag;
+  invalidate_tiles();
   queue_repaint();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
+void CanvasView::set_detail_zoom_levels(double titles_zoom, double blocks_zoom) {
+  if (_titles_detail_zoom != titles_zoom || _blocks_detail_zoom != blocks_zoom) {
+    _titles_detail_zoom = titles_zoom;
+    _blocks_detail_zoom = blocks_zoom;
+    invalidate_tiles();
+    queue_repaint();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns how much detail items should draw at the current zoom level. Printing, exports and OpenGL rendering
+ * always get everything.
+ */
+DetailLevel CanvasView::get_detail_level() const {
+  if (_printout_mode || has_gl())
+    return DetailFull;
+  if (_zoom < _blocks_detail_zoom)
+    return DetailBlocks;
+  if (_zoom < _titles_detail_zoom)
+    return DetailTitles;
+  return DetailFull;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Schedules the crossings of the given line for an update. Moving a figure with many connections changes a lot of
+ * lines at once, so crossings are computed in one go before the next repaint (see flush_line_crossings()).
+ */
 void CanvasView::update_line_crossings(Line *line) {
   if (!_line_hop_rendering)
     return;
 
-  // get the lines in the same bounding box
+  _pending_line_crossings.insert(line);
+}
 
-  std::list<CanvasItem *> items = get_items_bounded_by(line->get_root_bounds(),  std::bind(&is_line, std::placeholders::_1));
+//----------------------------------------------------------------------------------------------------------------------
 
-  std::list<CanvasItem *>::iterator iter = items.begin();
+void CanvasView::cancel_line_crossings(Line *line) {
+  _pending_line_crossings.erase(line);
+}
 
-  // check if the line crosses with anything under it
-  for (; iter != items.end() && *iter != line; ++iter) {
-    line->mark_crossings(static_cast<Line *>(*iter));
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool has_only_orthogonal_segments(const std::vector<Point> &vertices) {
+  for (size_t i = 1; i < vertices.size(); ++i) {
+    if (vertices[i - 1].x != vertices[i].x && vertices[i - 1].y != vertices[i].y)
+      return false;
   }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
 
-  if (iter != items.end())
-    ++iter; // skip the line itself
+/**
+ * Computes the crossings of all lines changed since the last call. Crossings between orthogonal segments are found
+ * with a single sweep over all segments in the affected area, instead of comparing each changed line with each
+ * line around it. Of two crossing lines the one lower in the stacking order draws the hop.
+ */
+void CanvasView::flush_line_crossings() {
+  if (_pending_line_crossings.empty())
+    return;
 
-  // then check if anything over it crosses the line
-  for (; iter != items.end(); ++iter) {
-    static_cast<Line *>(*iter)->mark_crossings(line);
+  std::set<Line *> changed;
+  changed.swap(_pending_line_crossings);
+  if (!_line_hop_rendering)
+    return;
+
+  Rect area;
+  for (std::set<Line *>::const_iterator iter = changed.begin(); iter != changed.end(); ++iter) {
+    Rect bounds = (*iter)->get_root_bounds();
+    if (iter == changed.begin())
+      area = bounds;
+    else {
+      area.set_xmin(std::min(area.left(), bounds.left()));
+      area.set_ymin(std::min(area.top(), bounds.top()));
+      area.set_xmax(std::max(area.right(), bounds.right()));
+      area.set_ymax(std::max(area.bottom(), bounds.bottom()));
+    }
   }
+
+  // All lines which may cross one of the changed lines, topmost first.
+  std::list<CanvasItem *> items = get_items_bounded_by(area, std::bind(&is_line, std::placeholders::_1));
+  std::vector<Line *> lines;
+  std::vector<bool> orthogonal;
+  std::vector<HVSegment> segments;
+  std::vector<size_t> segment_numbers;
+  for (std::list<CanvasItem *>::const_iterator iter = items.begin(); iter != items.end(); ++iter) {
+    Line *line = static_cast<Line *>(*iter);
+    std::vector<Point> vertices = line->get_root_vertices();
+    bool is_changed = changed.find(line) != changed.end();
+
+    orthogonal.push_back(has_only_orthogonal_segments(vertices));
+    if (orthogonal.back()) {
+      for (size_t i = 1; i < vertices.size(); ++i) {
+        segments.push_back(HVSegment(vertices[i - 1], vertices[i], lines.size(), is_changed));
+        segment_numbers.push_back(i - 1);
+      }
+    }
+    lines.push_back(line);
+  }
+
+  std::vector<std::vector<Line::Crossing> > crossings(lines.size());
+  std::vector<HVCrossing> found = find_hv_crossings(segments);
+  for (std::vector<HVCrossing>::const_iterator iter = found.begin(); iter != found.end(); ++iter) {
+    size_t lower = iter->horizontal, upper = iter->vertical;
+    if (segments[lower].owner < segments[upper].owner)
+      std::swap(lower, upper);
+    crossings[segments[lower].owner].push_back(
+      Line::Crossing(segment_numbers[lower], iter->point, lines[segments[upper].owner]));
+  }
+
+  for (size_t i = 0; i < lines.size(); ++i) {
+    if (orthogonal[i])
+      lines[i]->set_crossings(crossings[i], changed, changed.find(lines[i]) != changed.end());
+  }
+
+  // Lines with diagonal segments (e.g. from the straight line layouter) are handled pair by pair, as before.
+  for (size_t i = 0; i < lines.size(); ++i) {
+    if (orthogonal[i])
+      continue;
+
+    bool is_changed = changed.find(lines[i]) != changed.end();
+    Rect bounds = lines[i]->get_root_bounds();
+    for (size_t j = 0; j < lines.size(); ++j) {
+      if (j == i || (!orthogonal[j] && j < i)) // Pairs of two diagonal lines are only handled once.
+        continue;
+      if (!is_changed && changed.find(lines[j]) == changed.end())
+        continue;
+      if (bounds_intersect(bounds, lines[j]->get_root_bounds())) {
+        if (j > i)
+          lines[j]->mark_crossings(lines[i]);
+        else
+          lines[i]->mark_crossings(lines[j]);
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Schedules the route of the given line for an update. Used by line layouters while items are dragged, so that
+ * connections are routed at most once per frame instead of once per mouse event (see flush_line_routes()).
+ */
+void CanvasView::queue_line_route(Line *line) {
+  _pending_line_routes.insert(line);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CanvasView::cancel_line_route(Line *line) {
+  _pending_line_routes.erase(line);
+  _provisional_line_routes.erase(line);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Routes all lines whose connectors moved since the last call. During a drag the routes are provisional (layouters
+ * keep connectors on their current sides) and are redone once the drag is finished.
+ */
+void CanvasView::flush_line_routes() {
+  // Routing a line can move connectors of other lines, which then get queued again.
+  while (!_pending_line_routes.empty()) {
+    std::set<Line *> lines;
+    lines.swap(_pending_line_routes);
+
+    for (std::set<Line *>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter) {
+      (*iter)->get_layouter()->flush_pending_route();
+      if (_line_routing_deferred)
+        _provisional_line_routes.insert(*iter);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CanvasView::finish_line_routing() {
+  _line_routing_deferred = false;
+
+  _pending_line_routes.insert(_provisional_line_routes.begin(), _provisional_line_routes.end());
+  _provisional_line_routes.clear();
+  flush_line_routes();
 }
 
 void CanvasView::remove_item(mdc::CanvasItem *item) {
@@ -758,6 +950,108 @@ void CanvasView::paint_item_cache(CairoCtx *cr, double x, double y, cairo_surfac
 
 //----------------------------------------------------------------------------------------------------------------------
 
+void CanvasView::set_tile_cache_limit(size_t bytes) {
+  _tile_cache.set_max_memory(bytes);
+  queue_repaint();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CanvasView::invalidate_tiles() {
+  if (_rendering_tile)
+    _tile_invalidated = true;
+  _tile_cache.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CanvasView::invalidate_tiles(const Rect &bounds) {
+  if (_rendering_tile)
+    _tile_invalidated = true;
+  _tile_cache.invalidate(bounds);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Renders the visible layers into a new tile surface, using the current zoom level.
+ */
+cairo_surface_t *CanvasView::render_tile(int x, int y) {
+  Rect area = TileCache::tile_bounds(_zoom, x, y);
+  cairo_surface_t *surface =
+    cairo_image_surface_create(CAIRO_FORMAT_ARGB32, TileCache::TileSize, TileCache::TileSize);
+
+  CairoCtx *oldcr = _cairo;
+  _cairo = new CairoCtx(surface);
+  _cairo->scale(Point(_zoom, _zoom));
+  _cairo->translate(-area.left(), -area.top());
+
+  _rendering_tile = true;
+  _tile_invalidated = false;
+  for (LayerList::reverse_iterator iter = _layers.rbegin(); iter != _layers.rend(); ++iter) {
+    if ((*iter)->visible())
+      (*iter)->repaint(area);
+  }
+  _rendering_tile = false;
+
+  delete _cairo;
+  _cairo = oldcr;
+
+  return surface;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Paints the contents of all layers in the given area from cached tiles, rendering those which are missing.
+ * Tiles are aligned to the canvas origin, so scrolling reuses them. Tiles for other zoom levels stay in the cache
+ * until they are invalidated or pushed out.
+ */
+void CanvasView::paint_tiles(const Rect &area) {
+  double tile_size = TileCache::TileSize / _zoom;
+  int first_x = (int)floor(area.left() / tile_size);
+  int last_x = (int)floor(area.right() / tile_size);
+  int first_y = (int)floor(area.top() / tile_size);
+  int last_y = (int)floor(area.bottom() / tile_size);
+
+  // Tiles are placed on whole pixels, relative to where the canvas origin ends up on the device.
+  double origin_x = 0, origin_y = 0;
+  cairo_user_to_device(_cairo->get_cr(), &origin_x, &origin_y);
+  origin_x = floor(origin_x + 0.5);
+  origin_y = floor(origin_y + 0.5);
+
+  _cairo->save();
+  cairo_identity_matrix(_cairo->get_cr());
+
+  for (int y = first_y; y <= last_y; ++y) {
+    for (int x = first_x; x <= last_x; ++x) {
+      cairo_surface_t *tile = _tile_cache.get(_zoom, x, y);
+      bool cached = tile != 0;
+      if (!cached) {
+        tile = render_tile(x, y);
+        if (!_tile_invalidated) {
+          _tile_cache.add(_zoom, x, y, tile);
+          cached = true;
+        }
+      }
+
+      cairo_set_source_surface(_cairo->get_cr(), tile, origin_x + x * TileCache::TileSize,
+                               origin_y + y * TileCache::TileSize);
+      cairo_pattern_set_filter(cairo_get_source(_cairo->get_cr()), CAIRO_FILTER_NEAREST);
+      _cairo->rectangle(origin_x + x * TileCache::TileSize, origin_y + y * TileCache::TileSize,
+                        TileCache::TileSize, TileCache::TileSize);
+      _cairo->fill();
+
+      if (!cached)
+        cairo_surface_destroy(tile);
+    }
+  }
+
+  _cairo->restore();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void CanvasView::repaint() {
   if (_ui_lock > 0)
     return;
@@ -789,7 +1083,34 @@ void CanvasView::repaint_area(const Rect &aBounds, int wx, int wy, int ww, int w
     bounds = aBounds;
 
   CanvasAutoLock lock(this);
-  Rect clip;
+  gint64 start_time = _debug ? g_get_monotonic_time() : 0;
+  bool use_tiles = !has_gl() && !_printout_mode && _tile_cache.get_max_memory() > 0;
+
+  if (_line_routing_deferred && (_event_state & SLeftButtonMask) == 0)
+    finish_line_routing();
+  else
+    flush_line_routes();
+  flush_line_crossings();
+  if (use_tiles) {
+    // Relayouting while tiles are rendered would invalidate them right away.
+    for (LayerList::iterator iter = _layers.begin(); iter != _layers.end(); ++iter)
+      (*iter)->relayout_queued_items();
+  }
+
+  // If the requested area is covered by the rectangles queued for repaint (i.e. no expose from the platform added
+  // anything), only those get repainted. Moving one figure then only repaints its old and new area, not the bounding
+  // box of both. An expose which reaches into a gap between them must paint the entire requested area.
+  std::vector<Rect> areas;
+  if (!has_gl() && !_damage.empty() && !_damage.is_all() && _damage.contains(bounds, 2)) {
+    for (auto &area : _damage.rects()) {
+      if (bounds_intersect(area, bounds))
+        areas.push_back(clip_bound(expand_bound(area, 1, 1), bounds));
+    }
+  } else
+    areas.push_back(bounds);
+
+  // Anything queued while painting (e.g. by relayouting items) must be kept for the next round.
+  _damage.clear();
 
   begin_repaint(wx, wy, ww, wh);
   if (has_gl())
@@ -802,44 +1123,60 @@ void CanvasView::repaint_area(const Rect &aBounds, int wx, int wy, int ww, int w
   if (has_gl())
     apply_transformations_gl();
 
-  Rect vrect = get_viewport();
+  for (auto &area : areas) {
+    if (areas.size() > 1) {
+      _cairo->save();
+      _cairo->rectangle(area);
+      _cairo->clip();
+    }
 
-  if (_blayer->visible())
-    _blayer->repaint(bounds);
+    if (_blayer->visible())
+      _blayer->repaint(area);
 
-  clip.set_xmin(std::max(vrect.left(), bounds.left()));
-  clip.set_ymin(std::max(vrect.top(), bounds.top()));
+    _cairo->save();
 
-  clip.set_xmax(std::min(vrect.right(), bounds.right()));
-  clip.set_ymax(std::min(vrect.bottom(), bounds.bottom()));
+    // Clip so that only the affected area is redrawn.
+    _cairo->rectangle(area);
+    _cairo->clip();
 
-  clip = bounds;
+    // Repaint layers from back to front.
+    if (use_tiles)
+      paint_tiles(area);
+    else {
+      for (LayerList::reverse_iterator iter = _layers.rbegin(); iter != _layers.rend(); ++iter) {
+        if ((*iter)->visible())
+          (*iter)->repaint(area);
+      }
+    }
 
-  _cairo->save();
+    _cairo->restore();
 
-  // Clip so that only the affected area is redrawn.
-  _cairo->rectangle(clip);
-  _cairo->clip();
+    if (_ilayer->visible())
+      _ilayer->repaint(area);
 
-  // Repaint layers from back to front.
-  for (LayerList::reverse_iterator iter = _layers.rbegin(); iter != _layers.rend(); ++iter) {
-    if ((*iter)->visible())
-      (*iter)->repaint(bounds);
+    if (areas.size() > 1)
+      _cairo->restore();
   }
 
   _cairo->restore();
 
-  if (_ilayer->visible())
-    _ilayer->repaint(bounds);
-
-  _cairo->restore();
-
   end_repaint();
+
+  if (_debug) {
+    double frame_time = (g_get_monotonic_time() - start_time) / 1000.0;
+    _frame_time_avg = _frame_time_avg == 0 ? frame_time : _frame_time_avg * 0.9 + frame_time * 0.1;
+    _fps = _frame_time_avg > 0 ? 1000.0 / _frame_time_avg : 0;
+    logDebug("Repainted %i area(s) of %s in %.2f ms (average %.2f ms)\n", (int)areas.size(), bounds.str().c_str(),
+             frame_time, _frame_time_avg);
+    logDebug2("Text layout cache: %i entries, %i hits, %i misses\n", (int)TextLayoutCache::get()->count(),
+              (int)TextLayoutCache::get()->hits(), (int)TextLayoutCache::get()->misses());
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
 void CanvasView::queue_repaint() {
+  _damage.add_all();
   if (_repaint_lock > 0 || _destroying) {
     _repaints_missed++;
     return;
@@ -854,6 +1191,7 @@ void CanvasView::queue_repaint() {
 //----------------------------------------------------------------------------------------------------------------------
 
 void CanvasView::queue_repaint(const Rect &bounds) {
+  _damage.add(bounds);
   if (_repaint_lock > 0 || _destroying) {
     _repaints_missed++;
     return;
@@ -913,15 +1251,8 @@ void CanvasView::export_png(const std::string &filename, bool crop) {
     bounds.size.height += 20;
   }
 
-  cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, (int)bounds.width(), (int)bounds.height());
+  cairo_surface_t *surface = render_export_image(bounds);
   try {
-    CairoCtx ctx(surface);
-
-    ctx.rectangle(0, 0, bounds.width(), bounds.height());
-    ctx.set_color(Color::white());
-    ctx.fill();
-    render_for_export(bounds, &ctx);
-
     cairo_status_t status;
 
     if ((status = cairo_surface_write_to_png_stream(surface, &write_to_surface, fh.file())) != CAIRO_STATUS_SUCCESS)
@@ -1016,6 +1347,102 @@ void CanvasView::export_svg(const std::string &filename, const Size &size_in_pt)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Renders the given area into a new image surface for raster export. The diagram is drawn once into a recording
+ * surface, which several threads then replay into horizontal bands of the final image. Each band is drawn directly
+ * into its rows of the image. Bands start on whole pixels, so the result is the same as drawing the whole image in
+ * one go.
+ */
+cairo_surface_t *CanvasView::render_export_image(const Rect &bounds) {
+  const int band_height = 256;
+
+  int width = (int)bounds.width();
+  int height = (int)bounds.height();
+  int band_count = (height + band_height - 1) / band_height;
+  unsigned thread_count = std::max(1U, std::min((unsigned)band_count, std::thread::hardware_concurrency()));
+
+  cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+  if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+    std::string error = cairo_status_to_string(cairo_surface_status(surface));
+    cairo_surface_destroy(surface);
+    throw canvas_error(error);
+  }
+
+  // Recording surfaces don't hint font metrics, while image surfaces do. Use the options of the final image,
+  // so text is laid out exactly like it is when drawn directly.
+  cairo_font_options_t *font_options = cairo_font_options_create();
+  cairo_surface_get_font_options(surface, font_options);
+
+  // Recording is done here, as the canvas must not be painted from several threads.
+  cairo_rectangle_t extents = { 0, 0, (double)width, (double)height };
+  cairo_surface_t *recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR, &extents);
+  try {
+    CairoCtx ctx(recording);
+    cairo_set_font_options(ctx.get_cr(), font_options);
+
+    ctx.rectangle(0, 0, bounds.width(), bounds.height());
+    ctx.set_color(Color::white());
+    ctx.fill();
+    render_for_export(bounds, &ctx);
+  } catch (std::exception &) {
+    cairo_font_options_destroy(font_options);
+    cairo_surface_destroy(recording);
+    cairo_surface_destroy(surface);
+    throw;
+  }
+  cairo_font_options_destroy(font_options);
+  cairo_surface_flush(recording);
+
+  cairo_surface_flush(surface);
+  unsigned char *data = cairo_image_surface_get_data(surface);
+  int stride = cairo_image_surface_get_stride(surface);
+  std::vector<cairo_status_t> band_status(band_count, CAIRO_STATUS_SUCCESS);
+
+  auto render_band = [&](int band) {
+    int top = band * band_height;
+    cairo_surface_t *target = cairo_image_surface_create_for_data(data + top * stride, CAIRO_FORMAT_RGB24, width,
+                                                                  std::min(band_height, height - top), stride);
+    cairo_t *cr = cairo_create(target);
+    cairo_set_source_surface(cr, recording, 0, -top);
+    cairo_paint(cr);
+    band_status[band] = cairo_status(cr);
+    cairo_destroy(cr);
+    cairo_surface_flush(target);
+    if (band_status[band] == CAIRO_STATUS_SUCCESS)
+      band_status[band] = cairo_surface_status(target);
+    cairo_surface_destroy(target);
+  };
+
+  std::atomic<int> next_band(0);
+  auto render_bands = [&]() {
+    for (int band = next_band++; band < band_count; band = next_band++)
+      render_band(band);
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < thread_count; ++i)
+    threads.push_back(std::thread(render_bands));
+  render_bands();
+  for (std::thread &thread : threads)
+    thread.join();
+
+  cairo_surface_destroy(recording);
+  cairo_surface_mark_dirty(surface);
+
+  for (cairo_status_t status : band_status) {
+    if (status != CAIRO_STATUS_SUCCESS) {
+      cairo_surface_destroy(surface);
+      throw canvas_error(cairo_status_to_string(status));
+    }
+  }
+
+  logDebug2("Rendered %ix%i pixels for export in %i bands, using %u threads\n", width, height, band_count,
+            thread_count);
+  return surface;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void CanvasView::render_for_export(const Rect &bounds, CairoCtx *ctx) {
   CairoCtx *oldcr = _cairo;
 
@@ -1023,6 +1450,8 @@ void CanvasView::render_for_export(const Rect &bounds, CairoCtx *ctx) {
     _cairo = ctx;
 
   set_printout_mode(true);
+  flush_line_routes();
+  flush_line_crossings();
 
   _cairo->save();
 
@@ -1315,6 +1744,15 @@ void CanvasView::handle_mouse_move(int x, int y, EventState state) {
   // drags are only valid for leftbutton
   bool is_dragging = (_event_state & SLeftButtonMask) != 0;
 
+  // Connections of dragged items are routed once per frame, see flush_line_routes(). A move without the button
+  // means its release never reached us (e.g. the pointer grab was lost), so the provisional routes are finished.
+  if (is_dragging && (state & SLeftButtonMask) != 0)
+    _line_routing_deferred = true;
+  else if (_line_routing_deferred) {
+    CanvasAutoLock lock(this);
+    finish_line_routing();
+  }
+
   if (_motion_event_relay && _motion_event_relay(this, point, state))
     return;
 
@@ -1414,6 +1852,11 @@ void CanvasView::handle_mouse_button(MouseButton button, bool press, int x, int
   Point offset;
   bool handled = false;
 
+  if (!press && button == ButtonLeft && _line_routing_deferred) {
+    CanvasAutoLock lock(this);
+    finish_line_routing();
+  }
+
   if (_button_event_relay && _button_event_relay(this, button, press, point, state))
     return;
 
@@ -1502,6 +1945,13 @@ void CanvasView::handle_mouse_leave(int x, int y, EventState state) {
     return;
   Point point = window_to_canvas(x, y);
 
+  // Routes stay provisional only while the pointer is over the view. If the drag goes on, the next move defers
+  // them again.
+  if (_line_routing_deferred) {
+    CanvasAutoLock lock(this);
+    finish_line_routing();
+  }
+
   bool is_dragging = (_event_state & SLeftButtonMask) != 0;
 
   if (is_dragging)
@@ -30,6 +30,8 @@
 #include "mdc_events.h"
 #include "mdc_canvas_item.h"
 #include "mdc_selection.h"
+#include "mdc_tile_cache.h"
+#include "mdc_damage_region.h"
 #include "base/threading.h"
 
 #ifndef _MSC_VER
@@ -44,6 +46,13 @@ namespace mdc {
 
   enum SelectType { SelectSet, SelectAdd, SelectToggle };
 
+  // How much of a diagram is drawn, depending on the zoom level.
+  enum DetailLevel {
+    DetailFull,   // Everything.
+    DetailTitles, // Figures draw their outline and title only, lines are drawn as plain segments.
+    DetailBlocks  // Figures are drawn as coloured blocks, lines as plain segments.
+  };
+
   class MYSQLCANVAS_PUBLIC_FUNC CanvasView {
     friend class BackLayer;
     friend class CanvasViewExtras;
@@ -137,6 +146,10 @@ namespace mdc {
 
     void set_draws_line_hops(bool flag);
 
+    // Zoom levels below which less details are drawn. 0 disables the level.
+    void set_detail_zoom_levels(double titles_zoom, double blocks_zoom);
+    DetailLevel get_detail_level() const;
+
     Layer *new_layer(const std::string &name);
     void set_current_layer(Layer *layer);
     Layer *get_current_layer() const {
@@ -198,6 +211,15 @@ namespace mdc {
     Selection::ContentType get_selected_items();
 
     void update_line_crossings(Line *line);
+    void cancel_line_crossings(Line *line);
+    void flush_line_crossings();
+
+    bool defers_line_routing() const {
+      return _line_routing_deferred;
+    }
+    void queue_line_route(Line *line);
+    void cancel_line_route(Line *line);
+    void flush_line_routes();
 
     virtual bool initialize();
 
@@ -260,6 +282,11 @@ namespace mdc {
 
     void paint_item_cache(CairoCtx *cr, double x, double y, cairo_surface_t *cached_item, double alpha = 1.0);
 
+    // Memory used for caching rendered tiles of the layer contents, 0 disables tile caching.
+    void set_tile_cache_limit(size_t bytes);
+    void invalidate_tiles();
+    void invalidate_tiles(const base::Rect &bounds);
+
   protected:
     void *_user_data;
     std::string _tag;
@@ -297,11 +324,23 @@ namespace mdc {
     bool _grid_snapping;
     bool _printout_mode;
     bool _line_hop_rendering;
+    double _titles_detail_zoom;
+    double _blocks_detail_zoom;
+    std::set<Line *> _pending_line_crossings; // Lines which changed since crossings were last computed.
+    std::set<Line *> _pending_line_routes;     // Lines with moved connectors, routed with the next repaint.
+    std::set<Line *> _provisional_line_routes; // Lines routed during the current drag, rerouted when it ends.
+    bool _line_routing_deferred;               // Set while items are dragged.
 
     bool _destroying;
     bool _debug;
 
     double _fps;
+    double _frame_time_avg; // In ms, only measured in debug mode.
+
+    DamageRegion _damage; // Everything queued for repaint since the last repaint.
+    TileCache _tile_cache;
+    bool _rendering_tile;
+    bool _tile_invalidated; // Set if something changed while a tile was rendered.
 
     size_t _total_item_cache_mem;
 
@@ -320,8 +359,11 @@ namespace mdc {
     virtual void end_repaint() = 0;
 
     void repaint_area(const base::Rect &rect, int wx, int wy, int ww, int wh);
+    void paint_tiles(const base::Rect &area);
+    cairo_surface_t *render_tile(int x, int y);
 
     void update_offsets();
+    void finish_line_routing();
     void apply_transformations();
     void apply_transformations_gl();
     void reset_transformations_gl();
@@ -330,6 +372,7 @@ namespace mdc {
     bool perform_auto_scroll(const base::Point &mouse_pos);
 
     void render_for_export(const base::Rect &bounds, CairoCtx *cr);
+    cairo_surface_t *render_export_image(const base::Rect &bounds);
 
   private:
     struct ClickInfo {
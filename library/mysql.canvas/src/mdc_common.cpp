@@ -319,6 +319,25 @@ void CairoCtx::get_text_extents(const FontSpec &font, const char *text, cairo_te
   cairo_scaled_font_text_extents(fm->get_font(font), text, &extents);
 }
 
+TextLayoutCache::LayoutRef CairoCtx::get_text_layout(const FontSpec &font, const std::string &text) {
+  return TextLayoutCache::get()->lookup(fm->get_font(font), font, text);
+}
+
+/**
+ * Draws cached glyphs with their origin at pos. The font must have been set with set_font() before.
+ */
+void CairoCtx::show_text_layout(const TextLayoutCache::Layout &layout, const base::Point &pos) {
+  if (layout.glyphs.empty())
+    return;
+
+  std::vector<cairo_glyph_t> glyphs(layout.glyphs);
+  for (std::vector<cairo_glyph_t>::iterator glyph = glyphs.begin(); glyph != glyphs.end(); ++glyph) {
+    glyph->x += pos.x;
+    glyph->y += pos.y;
+  }
+  cairo_show_glyphs(cr, &glyphs[0], (int)glyphs.size());
+}
+
 bool CairoCtx::get_font_extents(const FontSpec &font, cairo_font_extents_t &extents) {
   cairo_scaled_font_t *fontp = fm->get_font(font);
   if (fontp) {
@@ -328,6 +347,167 @@ bool CairoCtx::get_font_extents(const FontSpec &font, cairo_font_extents_t &exte
   return false;
 }
 
+//--------------------------------------------------------------------------------------------------
+
+bool TextLayoutCache::Key::operator<(const Key &other) const {
+  if (max_width != other.max_width)
+    return max_width < other.max_width;
+  if (text != other.text)
+    return text < other.text;
+  if (font.size != other.font.size)
+    return font.size < other.font.size;
+  if (font.weight != other.font.weight)
+    return font.weight < other.font.weight;
+  if (font.slant != other.font.slant)
+    return font.slant < other.font.slant;
+  return font.family < other.font.family;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+TextLayoutCache *TextLayoutCache::get() {
+  static TextLayoutCache cache(10000);
+  return &cache;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+TextLayoutCache::TextLayoutCache(size_t max_entries) : _max_entries(max_entries), _hits(0), _misses(0) {
+}
+
+//--------------------------------------------------------------------------------------------------
+
+TextLayoutCache::LayoutRef TextLayoutCache::lookup(cairo_scaled_font_t *font, const FontSpec &spec,
+                                                   const std::string &text) {
+  Key key = { spec, text, -1 };
+  {
+    base::MutexLock lock(_mutex);
+    Entry *entry = find(key);
+    if (entry != NULL && entry->layout)
+      return entry->layout;
+  }
+
+  // Shape the text without holding the lock. If another thread added the same text meanwhile, its layout is used.
+  std::shared_ptr<Layout> layout = std::make_shared<Layout>();
+  cairo_scaled_font_text_extents(font, text.c_str(), &layout->extents);
+
+  cairo_glyph_t *glyphs = NULL;
+  int count = 0;
+  if (cairo_scaled_font_text_to_glyphs(font, 0, 0, text.c_str(), (int)text.size(), &glyphs, &count, NULL, NULL,
+                                       NULL) == CAIRO_STATUS_SUCCESS) {
+    layout->glyphs.assign(glyphs, glyphs + count);
+    cairo_glyph_free(glyphs);
+  }
+
+  base::MutexLock lock(_mutex);
+  Entry &entry = add(key);
+  if (!entry.layout)
+    entry.layout = layout;
+  return entry.layout;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool TextLayoutCache::lookup_fitted(const FontSpec &spec, const std::string &text, double max_width,
+                                    std::string &fitted_text) {
+  Key key = { spec, text, (int)floor(max_width * 10) };
+  base::MutexLock lock(_mutex);
+  Entry *entry = find(key);
+  if (entry == NULL)
+    return false;
+
+  fitted_text = entry->fitted_text;
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TextLayoutCache::add_fitted(const FontSpec &spec, const std::string &text, double max_width,
+                                 const std::string &fitted_text) {
+  Key key = { spec, text, (int)floor(max_width * 10) };
+  base::MutexLock lock(_mutex);
+  add(key).fitted_text = fitted_text;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TextLayoutCache::set_max_entries(size_t max_entries) {
+  base::MutexLock lock(_mutex);
+  _max_entries = max_entries;
+  shrink_to(_max_entries);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t TextLayoutCache::count() const {
+  base::MutexLock lock(_mutex);
+  return _entries.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TextLayoutCache::clear() {
+  base::MutexLock lock(_mutex);
+  _entries.clear();
+  _lru.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t TextLayoutCache::hits() const {
+  base::MutexLock lock(_mutex);
+  return _hits;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t TextLayoutCache::misses() const {
+  base::MutexLock lock(_mutex);
+  return _misses;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+TextLayoutCache::Entry *TextLayoutCache::find(const Key &key) {
+  std::map<Key, Entry>::iterator entry = _entries.find(key);
+  if (entry == _entries.end()) {
+    ++_misses;
+    return NULL;
+  }
+
+  ++_hits;
+  _lru.splice(_lru.begin(), _lru, entry->second.lru_position);
+  return &entry->second;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TextLayoutCache::shrink_to(size_t max_entries) {
+  while (_entries.size() > max_entries) {
+    _entries.erase(_lru.back());
+    _lru.pop_back();
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+TextLayoutCache::Entry &TextLayoutCache::add(const Key &key) {
+  std::map<Key, Entry>::iterator entry = _entries.find(key);
+  if (entry != _entries.end()) {
+    _lru.splice(_lru.begin(), _lru, entry->second.lru_position);
+    return entry->second;
+  }
+
+  shrink_to(_max_entries > 0 ? _max_entries - 1 : 0);
+
+  _lru.push_front(key);
+  Entry &new_entry = _entries[key];
+  new_entry.lru_position = _lru.begin();
+  return new_entry;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 Timestamp mdc::get_time() {
 #ifdef _MSC_VER
   unsigned __int64 t = 0;
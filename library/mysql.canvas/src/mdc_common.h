@@ -30,6 +30,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
 #include <set>
 #include <stdexcept>
 #include <assert.h>
@@ -53,6 +54,7 @@
 #include "base/geometry.h"
 #include "base/drawing.h"
 #include "base/string_utilities.h"
+#include "base/threading.h"
 
 #include "mdc_canvas_public.h"
 
@@ -135,6 +137,67 @@ namespace mdc {
     }
   };
 
+  /**
+   * Shared cache for measured and shaped text. Text figures are repainted far more often than their text changes,
+   * so the extents and glyphs of a string in a given font are kept here and the least recently used entries get
+   * dropped once the cache is full. Fonts are created with an identity matrix and without metrics hinting (see
+   * FontManager), which makes the entries independent of the zoom level and of the context they were created for.
+   */
+  class MYSQLCANVAS_PUBLIC_FUNC TextLayoutCache {
+  public:
+    struct Layout {
+      cairo_text_extents_t extents;
+      std::vector<cairo_glyph_t> glyphs; // Positioned relative to the start of the text.
+    };
+    typedef std::shared_ptr<const Layout> LayoutRef;
+
+    static TextLayoutCache *get();
+
+    TextLayoutCache(size_t max_entries);
+
+    // The cache is shared by all views, so it can be used from any thread. Returned layouts stay valid
+    // for as long as the caller holds on to them, even when their entry gets evicted.
+    LayoutRef lookup(cairo_scaled_font_t *font, const FontSpec &spec, const std::string &text);
+
+    // Text shortened by the caller to fit into the given width. Returns false if that wasn't stored yet.
+    bool lookup_fitted(const FontSpec &spec, const std::string &text, double max_width, std::string &fitted_text);
+    void add_fitted(const FontSpec &spec, const std::string &text, double max_width, const std::string &fitted_text);
+
+    void set_max_entries(size_t max_entries);
+    size_t count() const;
+    void clear();
+
+    size_t hits() const;
+    size_t misses() const;
+
+  private:
+    struct Key {
+      FontSpec font;
+      std::string text;
+      int max_width; // In 1/10 pixel, -1 for no limit.
+
+      bool operator<(const Key &other) const;
+    };
+
+    struct Entry {
+      LayoutRef layout;
+      std::string fitted_text; // Only for entries with a maximum width.
+      std::list<Key>::iterator lru_position;
+    };
+
+    base::Mutex _mutex;
+    std::map<Key, Entry> _entries;
+    std::list<Key> _lru; // Most recently used first.
+    size_t _max_entries;
+    size_t _hits;
+    size_t _misses;
+
+    // The following must be called with _mutex held.
+    Entry *find(const Key &key);
+    Entry &add(const Key &key);
+    void shrink_to(size_t max_entries);
+  };
+
   class canvas_error : public std::runtime_error {
   public:
     canvas_error(const std::string &msg) : std::runtime_error(msg){};
@@ -289,6 +352,10 @@ namespace mdc {
     void get_text_extents(const FontSpec &font, const char *text, cairo_text_extents_t &extents);
     bool get_font_extents(const FontSpec &font, cairo_font_extents_t &extents);
 
+    // Measured and shaped text from the shared TextLayoutCache.
+    TextLayoutCache::LayoutRef get_text_layout(const FontSpec &font, const std::string &text);
+    void show_text_layout(const TextLayoutCache::Layout &layout, const base::Point &pos);
+
     inline void set_source_surface(cairo_surface_t *srf, double x, double y) {
       cairo_set_source_surface(cr, srf, x, y);
     }
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "mdc_damage_region.h"
+#include "mdc_algorithms.h"
+
+using namespace mdc;
+using namespace base;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static Rect union_bounds(const Rect &r1, const Rect &r2) {
+  double left = std::min(r1.left(), r2.left());
+  double top = std::min(r1.top(), r2.top());
+  double right = std::max(r1.right(), r2.right());
+  double bottom = std::max(r1.bottom(), r2.bottom());
+
+  return Rect(left, top, right - left, bottom - top);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static double area(const Rect &rect) {
+  return rect.width() * rect.height();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the area that would be painted in addition if both rectangles were replaced by their union.
+ */
+static double merge_cost(const Rect &r1, const Rect &r2) {
+  return area(union_bounds(r1, r2)) - area(r1) - area(r2);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+DamageRegion::DamageRegion(size_t max_rects) : _max_rects(std::max<size_t>(1, max_rects)), _all(false) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void DamageRegion::add(const Rect &rect) {
+  if (_all || rect.width() <= 0 || rect.height() <= 0)
+    return;
+
+  Rect pending = rect;
+
+  // Merge with everything the new rect overlaps (or which it can be combined with at no extra cost).
+  // A merge can make the result overlap other rects, so start over after each one.
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (std::vector<Rect>::iterator iter = _rects.begin(); iter != _rects.end(); ++iter) {
+      if (bounds_contain_bounds(*iter, pending))
+        return;
+
+      if (merge_cost(*iter, pending) <= 0) {
+        pending = union_bounds(*iter, pending);
+        _rects.erase(iter);
+        merged = true;
+        break;
+      }
+    }
+  }
+  _rects.push_back(pending);
+
+  while (_rects.size() > _max_rects) {
+    size_t best_i = 0, best_j = 1;
+    double best_cost = merge_cost(_rects[0], _rects[1]);
+    for (size_t i = 0; i < _rects.size(); ++i) {
+      for (size_t j = i + 1; j < _rects.size(); ++j) {
+        double cost = merge_cost(_rects[i], _rects[j]);
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_i = i;
+          best_j = j;
+        }
+      }
+    }
+    _rects[best_i] = union_bounds(_rects[best_i], _rects[best_j]);
+    _rects.erase(_rects.begin() + best_j);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void DamageRegion::add_all() {
+  _all = true;
+  _rects.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void DamageRegion::clear() {
+  _all = false;
+  _rects.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the bounding box of all damaged areas. Meaningless if the entire area is damaged (see is_all()).
+ */
+Rect DamageRegion::bounds() const {
+  if (_rects.empty())
+    return Rect();
+
+  Rect result = _rects.front();
+  for (size_t i = 1; i < _rects.size(); ++i)
+    result = union_bounds(result, _rects[i]);
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool DamageRegion::intersects(const Rect &rect) const {
+  if (_all)
+    return true;
+
+  for (auto &damaged : _rects) {
+    if (bounds_intersect(damaged, rect))
+      return true;
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns true if the given rect is completely covered by the damaged areas, each of them grown by tolerance on
+ * all sides. Unlike a check against bounds(), gaps between the damaged areas are not counted as covered.
+ */
+bool DamageRegion::contains(const Rect &rect, double tolerance) const {
+  if (_all)
+    return true;
+
+  // Cut the covered parts out of the rect until nothing or no damaged area is left. Pieces without an area
+  // (e.g. from damaged areas which only touch them) need no repaint.
+  std::vector<Rect> uncovered;
+  auto add_piece = [](std::vector<Rect> &pieces, const Rect &piece) {
+    if (piece.width() > 0 && piece.height() > 0)
+      pieces.push_back(piece);
+  };
+  add_piece(uncovered, rect);
+  if (uncovered.empty())
+    return true;
+
+  for (auto &damaged : _rects) {
+    Rect cover = expand_bound(damaged, tolerance, tolerance);
+    std::vector<Rect> rest;
+    for (auto &piece : uncovered) {
+      if (!bounds_intersect(cover, piece)) {
+        rest.push_back(piece);
+        continue;
+      }
+
+      // Up to four pieces remain: above, below, left and right of the covered part.
+      double top = std::max(piece.top(), cover.top());
+      double bottom = std::min(piece.bottom(), cover.bottom());
+      add_piece(rest, Rect(piece.left(), piece.top(), piece.width(), top - piece.top()));
+      add_piece(rest, Rect(piece.left(), bottom, piece.width(), piece.bottom() - bottom));
+      add_piece(rest, Rect(piece.left(), top, cover.left() - piece.left(), bottom - top));
+      add_piece(rest, Rect(cover.right(), top, piece.right() - cover.right(), bottom - top));
+    }
+    uncovered.swap(rest);
+    if (uncovered.empty())
+      return true;
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
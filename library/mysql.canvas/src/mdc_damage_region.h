@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#ifndef _MDC_DAMAGE_REGION_H_
+#define _MDC_DAMAGE_REGION_H_
+
+#include "mdc_common.h"
+
+namespace mdc {
+
+  // Collects the areas that need to be repainted. Overlapping rectangles (and those that waste little space when
+  // combined) are merged as they come in. If there are still more than max_rects left, the pair which grows the
+  // least when merged is combined, so the region always stays a short list of rectangles.
+  class MYSQLCANVAS_PUBLIC_FUNC DamageRegion {
+  public:
+    DamageRegion(size_t max_rects = 8);
+
+    void add(const base::Rect &rect);
+    void add_all();
+    void clear();
+
+    bool empty() const {
+      return !_all && _rects.empty();
+    }
+    // True if everything must be repainted.
+    bool is_all() const {
+      return _all;
+    }
+    const std::vector<base::Rect> &rects() const {
+      return _rects;
+    }
+
+    base::Rect bounds() const;
+    bool intersects(const base::Rect &rect) const;
+    bool contains(const base::Rect &rect, double tolerance = 0) const;
+
+  private:
+    std::vector<base::Rect> _rects;
+    size_t _max_rects;
+    bool _all;
+  };
+
+} // end of mdc namespace
+
+#endif /* _MDC_DAMAGE_REGION_H_ */
@@ -38,6 +38,7 @@ Group::Group(Layer *layer) : Layouter(layer) {
   _activated = false;
 #endif
   _freeze_bounds_updates = 0;
+  _stack_top = 0;
 
   set_accepts_focus(true);
   set_accepts_selection(true);
@@ -46,6 +47,10 @@ Group::Group(Layer *layer) : Layouter(layer) {
 }
 
 Group::~Group() {
+  for (std::map<CanvasItem *, ItemInfo>::iterator iter = _content_info.begin(); iter != _content_info.end(); ++iter) {
+    iter->second.connection.disconnect();
+    iter->second.bounds_connection.disconnect();
+  }
 }
 
 void Group::repaint(const Rect &clipArea, bool direct) {
@@ -70,10 +75,14 @@ void Group::repaint(const Rect &clipArea, bool direct) {
     cr->restore();
   }
 
+  std::vector<CanvasItem *> items = get_items_in(clipRect);
+  if (items.empty())
+    return;
+
   cr->save();
   cr->translate(get_position());
-  for (std::list<CanvasItem *>::reverse_iterator iter = _contents.rbegin(); iter != _contents.rend(); ++iter) {
-    if ((*iter)->get_visible() && (*iter)->intersects(clipRect))
+  for (std::vector<CanvasItem *>::reverse_iterator iter = items.rbegin(); iter != items.rend(); ++iter) {
+    if ((*iter)->get_visible())
       (*iter)->repaint(clipRect, false);
   }
   cr->restore();
@@ -94,6 +103,7 @@ void Group::add(CanvasItem *item) {
   item->set_parent(this);
 
   _contents.push_front(item);
+  _item_index.insert(item, item->get_bounds());
   update_bounds();
 
   if (select)
@@ -103,13 +113,17 @@ void Group::add(CanvasItem *item) {
 
   info.connection =
     item->signal_focus_change()->connect(std::bind(&Group::focus_changed, this, std::placeholders::_1, item));
+  info.bounds_connection = item->signal_bounds_changed()->connect(std::bind(&Group::item_bounds_changed, this, item));
+  info.stack_order = ++_stack_top;
   _content_info[item] = info;
 }
 
 void Group::remove(CanvasItem *item) {
   _content_info[item].connection.disconnect();
+  _content_info[item].bounds_connection.disconnect();
 
   _content_info.erase(item);
+  _item_index.remove(item);
 
   item->set_parent(0);
   _contents.remove(item);
@@ -202,40 +216,70 @@ void Group::set_selected(bool flag) {
   _layer->queue_repaint(get_bounds());
 }
 
+std::vector<CanvasItem *> Group::get_items_in(const Rect &area) {
+  std::vector<CanvasItem *> items = _item_index.query(area);
+
+  // Return the items in stacking order (topmost first), like they are stored in _contents.
+  if (items.size() > 1) {
+    std::vector<std::pair<int, CanvasItem *> > ordered;
+    ordered.reserve(items.size());
+    for (std::vector<CanvasItem *>::const_iterator iter = items.begin(); iter != items.end(); ++iter)
+      ordered.push_back(std::make_pair(-_content_info[*iter].stack_order, *iter));
+    std::sort(ordered.begin(), ordered.end());
+    for (size_t i = 0; i < ordered.size(); ++i)
+      items[i] = ordered[i].second;
+  }
+  return items;
+}
+
+CanvasItem *Group::get_top_item_at(const Point &point, CanvasItem *skip) {
+  CanvasItem *top = 0;
+  int top_order = 0;
+
+  // Lines accept clicks slightly outside of their bounds, so look a little around the point.
+  _item_index.visit(Rect(point.x - 3, point.y - 3, 6, 6), [&](CanvasItem *item) {
+    if (item != skip && item->get_visible() && item->contains_point(point)) {
+      int order = _content_info[item].stack_order;
+      if (top == 0 || order > top_order) {
+        top = item;
+        top_order = order;
+      }
+    }
+  });
+
+  return top;
+}
+
 CanvasItem *Group::get_direct_subitem_at(const Point &point) {
   Point npoint = point - get_position();
 
-  for (std::list<CanvasItem *>::const_iterator iter = _contents.begin(); iter != _contents.end(); ++iter) {
-    if ((*iter)->get_visible() && (*iter)->contains_point(npoint)) {
-      Group *subgroup = dynamic_cast<Group *>((*iter));
-      if (subgroup) {
-        CanvasItem *subitem = subgroup->get_direct_subitem_at(npoint);
-        if (subitem)
-          return subitem;
-      }
-      return (*iter);
+  CanvasItem *item = get_top_item_at(npoint);
+  if (item) {
+    Group *subgroup = dynamic_cast<Group *>(item);
+    if (subgroup) {
+      CanvasItem *subitem = subgroup->get_direct_subitem_at(npoint);
+      if (subitem)
+        return subitem;
     }
   }
 
-  return 0;
+  return item;
 }
 
 CanvasItem *Group::get_other_item_at(const Point &point, CanvasItem *other_item) {
   Point npoint = point - get_position();
 
-  for (std::list<CanvasItem *>::const_iterator iter = _contents.begin(); iter != _contents.end(); ++iter) {
-    if ((*iter)->get_visible() && (*iter)->contains_point(npoint) && *iter != other_item) {
-      Layouter *litem = dynamic_cast<Layouter *>(*iter);
-      if (litem) {
-        CanvasItem *item = litem->get_item_at(npoint);
-        if (item && other_item != item)
-          return item;
-      }
-      return *iter;
+  CanvasItem *found = get_top_item_at(npoint, other_item);
+  if (found) {
+    Layouter *litem = dynamic_cast<Layouter *>(found);
+    if (litem) {
+      CanvasItem *item = litem->get_item_at(npoint);
+      if (item && other_item != item)
+        return item;
     }
   }
 
-  return 0;
+  return found;
 }
 
 CanvasItem *Group::get_item_at(const Point &point) {
@@ -244,10 +288,23 @@ CanvasItem *Group::get_item_at(const Point &point) {
 
 void Group::raise_item(CanvasItem *item, CanvasItem *above) {
   restack_up(_contents, item, above);
+  update_stack_order();
 }
 
 void Group::lower_item(CanvasItem *item) {
   restack_down(_contents, item);
+  update_stack_order();
+}
+
+void Group::update_stack_order() {
+  // front of list is top stack
+  _stack_top = 0;
+  for (std::list<CanvasItem *>::reverse_iterator iter = _contents.rbegin(); iter != _contents.rend(); ++iter)
+    _content_info[*iter].stack_order = ++_stack_top;
+}
+
+void Group::item_bounds_changed(CanvasItem *item) {
+  _item_index.insert(item, item->get_bounds());
 }
 
 void Group::move_item(CanvasItem *item, const Point &pos) {
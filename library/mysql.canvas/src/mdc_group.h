@@ -25,6 +25,7 @@
 #define _MDC_GROUP_H_
 
 #include "mdc_layouter.h"
+#include "mdc_rtree.h"
 
 namespace mdc {
 
@@ -54,6 +55,7 @@ namespace mdc {
     void thaw();
 
     CanvasItem *get_direct_subitem_at(const base::Point &point);
+    CanvasItem *get_top_item_at(const base::Point &point, CanvasItem *skip = 0);
     virtual CanvasItem *get_other_item_at(const base::Point &point, CanvasItem *item);
     virtual CanvasItem *get_item_at(const base::Point &point);
 
@@ -68,15 +70,22 @@ namespace mdc {
 
     virtual void repaint(const base::Rect &clipArea, bool direct);
 
+    // Direct children whose bounds (in the coordinates of this group) intersect the given area, topmost first.
+    std::vector<CanvasItem *> get_items_in(const base::Rect &area);
+
   protected:
     struct ItemInfo {
       boost::signals2::connection connection;
+      boost::signals2::connection bounds_connection;
+      int stack_order; // Higher values are closer to the top.
     };
 
     // front of list is top stack
     std::list<CanvasItem *> _contents;
 
     std::map<CanvasItem *, ItemInfo> _content_info;
+    RTree<CanvasItem *> _item_index; // Bounds of the direct children, for hit-testing and area queries.
+    int _stack_top;
     int _freeze_bounds_updates;
 #ifdef no_group_activate
     bool _activated;
@@ -85,6 +94,8 @@ namespace mdc {
     virtual void update_bounds();
 
     void focus_changed(bool f, CanvasItem *item);
+    void item_bounds_changed(CanvasItem *item);
+    void update_stack_order();
 #ifdef no_group_activate
     void activate_group(bool flag);
 #endif
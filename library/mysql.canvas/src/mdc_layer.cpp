@@ -28,6 +28,8 @@
 #include "mdc_item_handle.h"
 #include "mdc_area_group.h"
 #include "mdc_selection.h"
+#include "mdc_back_layer.h"
+#include "mdc_interaction_layer.h"
 
 using namespace mdc;
 using namespace base;
@@ -69,6 +71,7 @@ void Layer::set_visible(bool flag) {
     _visible = flag;
     if (flag)
       queue_repaint();
+    _owner->invalidate_tiles();
     _owner->queue_repaint();
   }
 }
@@ -118,27 +121,31 @@ void Layer::set_needs_repaint_all_items() {
 
 void Layer::repaint_pending() {
   if (_needs_repaint) {
-    // XXX record pending areas and repaint only what's needed
+    // The damaged areas are tracked by the view, see CanvasView::repaint_area().
     repaint(Rect(Point(0, 0), _owner->get_total_view_size()));
     _needs_repaint = false;
   }
 }
 
-void Layer::repaint(const Rect &bounds) {
-  for (std::list<CanvasItem *>::iterator iter = _relayout_queue.begin(); iter != _relayout_queue.end(); ++iter) {
+void Layer::relayout_queued_items() {
+  // The old area of each item was queued in queue_relayout(), the relayout can move or resize it however.
+  std::list<CanvasItem *> items;
+  items.swap(_relayout_queue);
+  for (std::list<CanvasItem *>::iterator iter = items.begin(); iter != items.end(); ++iter) {
     (*iter)->relayout();
+    queue_item_area(*iter);
   }
-  _relayout_queue.clear();
+}
+
+void Layer::repaint(const Rect &bounds) {
+  relayout_queued_items();
 
   if (_visible)
     _root_area->repaint(bounds, false);
 }
 
 void Layer::repaint_for_export(const Rect &aBounds) {
-  for (std::list<CanvasItem *>::iterator iter = _relayout_queue.begin(); iter != _relayout_queue.end(); ++iter) {
-    (*iter)->relayout();
-  }
-  _relayout_queue.clear();
+  relayout_queued_items();
 
   if (_visible)
     _root_area->repaint(aBounds, true);
@@ -148,6 +155,8 @@ void Layer::repaint_for_export(const Rect &aBounds) {
 
 void Layer::queue_repaint() {
   _needs_repaint = true;
+  if (is_content_layer())
+    _owner->invalidate_tiles();
   _owner->queue_repaint();
 }
 
@@ -155,21 +164,48 @@ void Layer::queue_repaint() {
 
 void Layer::queue_repaint(const Rect &bounds) {
   _needs_repaint = true;
+  if (is_content_layer())
+    _owner->invalidate_tiles(bounds);
   _owner->queue_repaint(bounds);
 }
 
 //--------------------------------------------------------------------------------------------------
 
+// The background and interaction layers are painted directly, all other layers go into the view's tile cache.
+bool Layer::is_content_layer() const {
+  return this != _owner->get_background_layer() && this != _owner->get_interaction_layer();
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void Layer::queue_relayout(CanvasItem *item) {
   if (!item->is_toplevel())
     throw std::logic_error("trying to queue non-toplevel item for relayout");
 
   if (std::find(_relayout_queue.begin(), _relayout_queue.end(), item) == _relayout_queue.end()) {
-    queue_repaint();
+    // Only the current area of the item is affected here. The area it has after the relayout is queued in
+    // relayout_queued_items().
+    queue_item_area(item);
     _relayout_queue.push_back(item);
   }
 }
 
+//--------------------------------------------------------------------------------------------------
+
+// Queues the area of the given toplevel item, including the outer padding used for handles and shadows.
+// Items without a valid size yet invalidate the whole layer.
+void Layer::queue_item_area(CanvasItem *item) {
+  Rect bounds(item->get_root_bounds());
+  bounds.pos.x -= LEFT_OUTER_PAD;
+  bounds.pos.y -= TOP_OUTER_PAD;
+  bounds.size.width += LEFT_OUTER_PAD + RIGHT_OUTER_PAD;
+  bounds.size.height += TOP_OUTER_PAD + BOTTOM_OUTER_PAD;
+  if (bounds.width() > LEFT_OUTER_PAD + RIGHT_OUTER_PAD && bounds.height() > TOP_OUTER_PAD + BOTTOM_OUTER_PAD)
+    queue_repaint(bounds);
+  else
+    queue_repaint();
+}
+
 CanvasItem *Layer::get_other_item_at(const Point &point, CanvasItem *item) {
   return _root_area->get_other_item_at(point, item);
 }
@@ -183,17 +219,23 @@ CanvasItem *Layer::get_top_item_at(const Point &point) {
 }
 
 static std::list<CanvasItem *> get_items_bounded_by(const Rect &rect, const Layer::ItemCheckFunc &pred, Group *group) {
-  std::list<CanvasItem *> &items = group->get_contents();
   std::list<CanvasItem *> result;
 
-  for (std::list<CanvasItem *>::iterator iter = items.begin(); iter != items.end(); ++iter) {
-    Group *g;
+  // The group's spatial index works in group coordinates. Query a slightly larger area to be safe from rounding
+  // and do the exact check below.
+  Rect local_rect = expand_bound(rect, 1, 1);
+  local_rect.pos = local_rect.pos - group->get_root_position();
+  std::vector<CanvasItem *> items = group->get_items_in(local_rect);
+
+  for (std::vector<CanvasItem *>::iterator iter = items.begin(); iter != items.end(); ++iter) {
+    if (!bounds_intersect((*iter)->get_root_bounds(), rect))
+      continue;
 
-    if (bounds_intersect((*iter)->get_root_bounds(), rect) && (!pred || pred(*iter)))
+    if (!pred || pred(*iter))
       result.push_back(*iter);
 
-    g = dynamic_cast<Group *>(*iter);
-    if (g && bounds_intersect(g->get_root_bounds(), rect)) {
+    Group *g = dynamic_cast<Group *>(*iter);
+    if (g) {
       std::list<CanvasItem *> tmp = get_items_bounded_by(rect, pred, g);
 
       result.insert(result.end(), tmp.begin(), tmp.end());
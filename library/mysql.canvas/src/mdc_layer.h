@@ -64,6 +64,7 @@ namespace mdc {
     };
 
     void queue_relayout(CanvasItem *item);
+    void relayout_queued_items();
     void invalidate_caches();
 
     void set_needs_repaint_all_items();
@@ -105,6 +106,8 @@ namespace mdc {
     bool _needs_repaint;
 
     Layer *get_layer_under_this();
+    bool is_content_layer() const;
+    void queue_item_area(CanvasItem *item);
 
   private:
     void view_resized();
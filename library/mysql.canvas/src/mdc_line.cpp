@@ -103,6 +103,10 @@ Line::Line(Layer *layer, LineLayouter *layouter) : Figure(layer), _layouter(0) {
 }
 
 Line::~Line() {
+  if (get_view()) {
+    get_view()->cancel_line_crossings(this);
+    get_view()->cancel_line_route(this);
+  }
   delete _layouter;
 }
 
@@ -185,6 +189,31 @@ GLushort Line::get_gl_pattern(LinePatternType pattern) {
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * At lower levels of detail lines are drawn as plain segments, without hops, end decorations or caching.
+ */
+void Line::repaint(const Rect &clipArea, bool direct) {
+  if (_segments.empty() || get_view()->get_detail_level() == DetailFull) {
+    Figure::repaint(clipArea, direct);
+    return;
+  }
+
+  CairoCtx *cr = get_view()->cairoctx();
+  cr->save();
+  cr->translate(get_position());
+  cr->set_color(_pen_color);
+  cr->set_line_width(1.0 / get_view()->get_zoom());
+
+  std::vector<SegmentPoint>::const_iterator v = _segments.begin();
+  cr->move_to(v->pos);
+  while (++v != _segments.end())
+    cr->line_to(v->pos);
+  cr->stroke();
+  cr->restore();
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void Line::draw_contents(CairoCtx *cr) {
   cr->translate(get_position());
 
@@ -826,6 +855,66 @@ void Line::mark_crossings(Line *line) {
   set_needs_render();
 }
 
+/**
+ * Returns the vertices of the line (without any hops) in root coordinates.
+ */
+std::vector<Point> Line::get_root_vertices() const {
+  std::vector<Point> vertices;
+  Point origin = get_root_position();
+
+  vertices.reserve(_vertices.size());
+  for (std::vector<SegmentPoint>::const_iterator iter = _segments.begin(); iter != _segments.end(); ++iter) {
+    if (!iter->hop)
+      vertices.push_back(iter->pos + origin);
+  }
+  return vertices;
+}
+
+/**
+ * Updates the hops of this line with crossings computed for several lines at once (see
+ * CanvasView::flush_line_crossings()). Hops over the changed lines (or all hops if replace_all is set) are replaced
+ * by the given crossings, all others are kept.
+ */
+void Line::set_crossings(std::vector<Crossing> crossings, const std::set<Line *> &changed_lines, bool replace_all) {
+  if (_segments.size() < 2)
+    return;
+
+  Point origin = get_root_position();
+  for (std::vector<Crossing>::iterator iter = crossings.begin(); iter != crossings.end(); ++iter)
+    iter->pos = iter->pos - origin;
+
+  // Collect the hops which stay as they are, with the segment they are on.
+  std::vector<Point> vertices;
+  for (std::vector<SegmentPoint>::const_iterator iter = _segments.begin(); iter != _segments.end(); ++iter) {
+    if (!iter->hop)
+      vertices.push_back(iter->pos);
+    else if (!replace_all && changed_lines.find(iter->hop) == changed_lines.end())
+      crossings.push_back(Crossing(vertices.size() - 1, iter->pos, iter->hop));
+  }
+
+  // Hops are sorted by their distance from the start of the segment they are on.
+  std::sort(crossings.begin(), crossings.end(), [&vertices](const Crossing &a, const Crossing &b) {
+    if (a.segment != b.segment)
+      return a.segment < b.segment;
+    return points_distance(vertices[a.segment], a.pos) < points_distance(vertices[b.segment], b.pos);
+  });
+
+  std::vector<SegmentPoint> new_segs;
+  new_segs.reserve(vertices.size() + crossings.size());
+  std::vector<Crossing>::const_iterator crossing = crossings.begin();
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    new_segs.push_back(SegmentPoint(vertices[i], 0));
+    for (; crossing != crossings.end() && crossing->segment == i; ++crossing)
+      new_segs.push_back(SegmentPoint(crossing->pos, crossing->line));
+  }
+
+  if (new_segs == _segments)
+    return;
+
+  _segments.swap(new_segs);
+  set_needs_render();
+}
+
 void Line::update_bounds() {
   if (_vertices.size() <= 1) {
     set_bounds(Rect());
@@ -87,6 +87,11 @@ namespace mdc {
 
     virtual void update() = 0;
 
+    // Called by the view for lines queued with CanvasView::queue_line_route().
+    virtual void flush_pending_route() {
+      update();
+    }
+
   protected:
     struct Segment {
       base::Point p1;
@@ -111,6 +116,7 @@ namespace mdc {
 
     virtual bool contains_point(const base::Point &point) const;
 
+    virtual void repaint(const base::Rect &clipArea, bool direct);
     virtual void draw_contents(CairoCtx *cr);
     virtual void stroke_outline(CairoCtx *cr, float offset = 0) const;
     virtual void stroke_outline_gl(float offset = 0) const;
@@ -135,6 +141,19 @@ namespace mdc {
 
     virtual void mark_crossings(Line *line);
 
+    // A crossing with another line, on the given segment (between the vertices segment and segment + 1).
+    struct Crossing {
+      size_t segment;
+      base::Point pos; // In root coordinates.
+      Line *line;
+
+      Crossing(size_t s, const base::Point &p, Line *l) : segment(s), pos(p), line(l) {
+      }
+    };
+
+    std::vector<base::Point> get_root_vertices() const;
+    void set_crossings(std::vector<Crossing> crossings, const std::set<Line *> &changed_lines, bool replace_all);
+
     virtual void create_handles(InteractionLayer *ilayer);
     virtual void update_handles();
 
@@ -27,6 +27,7 @@
 #include "mdc_connector.h"
 #include "mdc_algorithms.h"
 #include "mdc_line_segment_handle.h"
+#include "mdc_canvas_view.h"
 
 using namespace mdc;
 using namespace base;
@@ -38,6 +39,8 @@ OrthogonalLineLayouter::OrthogonalLineLayouter(Connector *sconn, Connector *econ
   econn->set_update_handler(std::bind(&OrthogonalLineLayouter::connector_changed, this, std::placeholders::_1));
 
   _updating = false;
+  _start_moved = false;
+  _end_moved = false;
 }
 
 OrthogonalLineLayouter::~OrthogonalLineLayouter() {
@@ -163,13 +166,57 @@ bool OrthogonalLineLayouter::update_end_point() {
 
 void OrthogonalLineLayouter::update() {
   _change_pending = true;
-  connector_changed(_linfo.start_connector());
+  route_from(_linfo.start_connector());
 
   if (_change_pending)
     _changed();
 }
 
+/**
+ * Returns true while the view routes lines only once per frame (i.e. while items are being dragged). Such routes
+ * are provisional and subclasses should not move connectors between magnet sides then.
+ */
+bool OrthogonalLineLayouter::routing_deferred() const {
+  Line *line = dynamic_cast<Line *>(_linfo.start_connector()->get_owner());
+
+  return line && line->get_view() && line->get_view()->defers_line_routing();
+}
+
+void OrthogonalLineLayouter::flush_pending_route() {
+  bool start_moved = _start_moved;
+  bool end_moved = _end_moved;
+
+  // Keep the flags for provisional routes, the final route must still see which ends moved.
+  if (!routing_deferred())
+    _start_moved = _end_moved = false;
+
+  if (start_moved)
+    route_from(_linfo.start_connector());
+  if (end_moved)
+    route_from(_linfo.end_connector());
+}
+
 void OrthogonalLineLayouter::connector_changed(Connector *conn) {
+  if (_updating)
+    return;
+
+  if (routing_deferred()) {
+    if (conn == _linfo.start_connector())
+      _start_moved = true;
+    else if (conn == _linfo.end_connector())
+      _end_moved = true;
+    else
+      return;
+
+    Line *line = dynamic_cast<Line *>(_linfo.start_connector()->get_owner());
+    line->get_view()->queue_line_route(line);
+    return;
+  }
+
+  route_from(conn);
+}
+
+void OrthogonalLineLayouter::route_from(Connector *conn) {
   bool changed = false;
 
   if (_updating)
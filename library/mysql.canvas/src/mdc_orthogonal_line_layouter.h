@@ -88,6 +88,7 @@ namespace mdc {
     void set_segment_offset(int subline, double offset);
 
     virtual void update();
+    virtual void flush_pending_route();
 
   protected:
     struct LineInfo {
@@ -200,10 +201,14 @@ namespace mdc {
     LineInfo _linfo;
     bool _change_pending;
     bool _updating;
+    bool _start_moved; // Connectors which moved since the line was last routed with final connector sides.
+    bool _end_moved;
 
     virtual std::vector<base::Point> get_points_for_subline(int subline);
 
     virtual void connector_changed(Connector *conn);
+    void route_from(Connector *conn);
+    bool routing_deferred() const;
 
     virtual bool update_start_point();
     virtual bool update_end_point();
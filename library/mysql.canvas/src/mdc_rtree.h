@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#ifndef _MDC_RTREE_H_
+#define _MDC_RTREE_H_
+
+#include "mdc_common.h"
+
+#include <unordered_map>
+
+namespace mdc {
+
+  /**
+   * A dynamic R-tree (Guttman's variant with quadratic node splits), mapping values to their bounds.
+   * It answers point and area queries in logarithmic time instead of visiting every stored value, which matters
+   * for hit-testing and area selection on diagrams with thousands of items.
+   *
+   * Each value can be stored only once. Inserting a value again moves it to the new bounds.
+   */
+  template <class T>
+  class RTree {
+  public:
+    RTree(size_t max_entries = 8) : _root(new Node(true)) {
+      _max_entries = std::max(max_entries, (size_t)4);
+      _min_entries = std::max(_max_entries * 2 / 5, (size_t)2);
+    }
+
+    ~RTree() {
+      free_node(_root);
+    }
+
+    RTree(const RTree &) = delete;
+    RTree &operator=(const RTree &) = delete;
+
+    void insert(const T &value, const base::Rect &bounds) {
+      Box box(bounds);
+      typename std::unordered_map<T, Box>::iterator iter = _values.find(value);
+      if (iter != _values.end()) {
+        if (iter->second == box)
+          return;
+        remove(value);
+      }
+
+      _values[value] = box;
+      insert_entry(box, value);
+    }
+
+    bool remove(const T &value) {
+      typename std::unordered_map<T, Box>::iterator iter = _values.find(value);
+      if (iter == _values.end())
+        return false;
+
+      Box box = iter->second;
+      _values.erase(iter);
+
+      Node *leaf = find_leaf(_root, value, box);
+      if (leaf != nullptr) {
+        for (typename std::vector<Entry>::iterator entry = leaf->entries.begin(); entry != leaf->entries.end();
+             ++entry) {
+          if (entry->value == value) {
+            leaf->entries.erase(entry);
+            break;
+          }
+        }
+        condense_tree(leaf);
+      }
+      return true;
+    }
+
+    void clear() {
+      free_node(_root);
+      _root = new Node(true);
+      _values.clear();
+    }
+
+    bool contains(const T &value) const {
+      return _values.find(value) != _values.end();
+    }
+
+    size_t size() const {
+      return _values.size();
+    }
+
+    bool empty() const {
+      return _values.empty();
+    }
+
+    // The union of all stored bounds.
+    base::Rect bounds() const {
+      return node_box(_root).rect();
+    }
+
+    // Calls callback(value) for every value whose bounds intersect the given area (borders included).
+    template <class F>
+    void visit(const base::Rect &area, F callback) const {
+      if (!_values.empty())
+        visit_node(_root, Box(area), callback);
+    }
+
+    std::vector<T> query(const base::Rect &area) const {
+      std::vector<T> result;
+      visit(area, [&result](const T &value) { result.push_back(value); });
+      return result;
+    }
+
+  private:
+    // Rects are stored as their edges, so containment checks while descending the tree are exact.
+    struct Box {
+      double x1, y1, x2, y2;
+
+      Box() : x1(0), y1(0), x2(0), y2(0) {
+      }
+      Box(const base::Rect &rect) {
+        x1 = std::min(rect.left(), rect.right());
+        x2 = std::max(rect.left(), rect.right());
+        y1 = std::min(rect.top(), rect.bottom());
+        y2 = std::max(rect.top(), rect.bottom());
+      }
+
+      base::Rect rect() const {
+        return base::Rect(x1, y1, x2 - x1, y2 - y1);
+      }
+
+      bool operator==(const Box &other) const {
+        return x1 == other.x1 && y1 == other.y1 && x2 == other.x2 && y2 == other.y2;
+      }
+
+      bool intersects(const Box &other) const {
+        return x2 >= other.x1 && x1 <= other.x2 && y2 >= other.y1 && y1 <= other.y2;
+      }
+
+      bool contains(const Box &other) const {
+        return x1 <= other.x1 && other.x2 <= x2 && y1 <= other.y1 && other.y2 <= y2;
+      }
+
+      Box unite(const Box &other) const {
+        Box result;
+        result.x1 = std::min(x1, other.x1);
+        result.y1 = std::min(y1, other.y1);
+        result.x2 = std::max(x2, other.x2);
+        result.y2 = std::max(y2, other.y2);
+        return result;
+      }
+
+      // Lines are often only 1 pixel wide or high, so the area is computed with an extra pixel in each direction to
+      // keep such boxes comparable.
+      double area() const {
+        return (x2 - x1 + 1) * (y2 - y1 + 1);
+      }
+    };
+
+    struct Node;
+
+    struct Entry {
+      Box box;
+      Node *child; // Only used in inner nodes.
+      T value;     // Only used in leaves.
+
+      Entry(const Box &b, Node *n, const T &v) : box(b), child(n), value(v) {
+      }
+    };
+
+    struct Node {
+      Node *parent;
+      bool leaf;
+      std::vector<Entry> entries;
+
+      Node(bool is_leaf) : parent(nullptr), leaf(is_leaf) {
+      }
+    };
+
+    Node *_root;
+    std::unordered_map<T, Box> _values;
+    size_t _max_entries;
+    size_t _min_entries;
+
+    static void free_node(Node *node) {
+      if (!node->leaf) {
+        for (typename std::vector<Entry>::iterator iter = node->entries.begin(); iter != node->entries.end(); ++iter)
+          free_node(iter->child);
+      }
+      delete node;
+    }
+
+    static Box node_box(const Node *node) {
+      if (node->entries.empty())
+        return Box();
+
+      Box box = node->entries.front().box;
+      for (typename std::vector<Entry>::const_iterator iter = node->entries.begin() + 1; iter != node->entries.end();
+           ++iter)
+        box = box.unite(iter->box);
+      return box;
+    }
+
+    static Entry &parent_entry(Node *node) {
+      for (typename std::vector<Entry>::iterator iter = node->parent->entries.begin();
+           iter != node->parent->entries.end(); ++iter) {
+        if (iter->child == node)
+          return *iter;
+      }
+      throw std::logic_error("R-tree node not found in its parent");
+    }
+
+    template <class F>
+    static void visit_node(const Node *node, const Box &area, F &callback) {
+      for (typename std::vector<Entry>::const_iterator iter = node->entries.begin(); iter != node->entries.end();
+           ++iter) {
+        if (iter->box.intersects(area)) {
+          if (node->leaf)
+            callback(iter->value);
+          else
+            visit_node(iter->child, area, callback);
+        }
+      }
+    }
+
+    Node *find_leaf(Node *node, const T &value, const Box &box) const {
+      for (typename std::vector<Entry>::iterator iter = node->entries.begin(); iter != node->entries.end(); ++iter) {
+        if (node->leaf) {
+          if (iter->value == value)
+            return node;
+        } else if (iter->box.contains(box)) {
+          Node *leaf = find_leaf(iter->child, value, box);
+          if (leaf != nullptr)
+            return leaf;
+        }
+      }
+      return nullptr;
+    }
+
+    // Descends to the leaf whose box grows least when adding the given box.
+    Node *choose_leaf(const Box &box) const {
+      Node *node = _root;
+      while (!node->leaf) {
+        Node *best = nullptr;
+        double best_growth = 0, best_area = 0;
+        for (typename std::vector<Entry>::iterator iter = node->entries.begin(); iter != node->entries.end();
+             ++iter) {
+          double area = iter->box.area();
+          double growth = iter->box.unite(box).area() - area;
+          if (best == nullptr || growth < best_growth || (growth == best_growth && area < best_area)) {
+            best = iter->child;
+            best_growth = growth;
+            best_area = area;
+          }
+        }
+        node = best;
+      }
+      return node;
+    }
+
+    void insert_entry(const Box &box, const T &value) {
+      Node *leaf = choose_leaf(box);
+      leaf->entries.push_back(Entry(box, nullptr, value));
+      adjust_tree(leaf);
+    }
+
+    // Walks up from the given node, splitting overfull nodes and updating the boxes stored in the parents.
+    void adjust_tree(Node *node) {
+      while (node != nullptr) {
+        Node *sibling = nullptr;
+        if (node->entries.size() > _max_entries)
+          sibling = split(node);
+
+        if (node->parent == nullptr) {
+          if (sibling != nullptr) {
+            _root = new Node(false);
+            _root->entries.push_back(Entry(node_box(node), node, T()));
+            _root->entries.push_back(Entry(node_box(sibling), sibling, T()));
+            node->parent = _root;
+            sibling->parent = _root;
+          }
+          break;
+        }
+
+        parent_entry(node).box = node_box(node);
+        if (sibling != nullptr) {
+          sibling->parent = node->parent;
+          node->parent->entries.push_back(Entry(node_box(sibling), sibling, T()));
+        }
+        node = node->parent;
+      }
+    }
+
+    // Quadratic split: the two entries which would waste most space together seed two groups, the rest is
+    // distributed to where it causes the least growth.
+    Node *split(Node *node) {
+      std::vector<Entry> entries;
+      entries.swap(node->entries);
+
+      size_t seed1 = 0, seed2 = 1;
+      double worst = -1;
+      for (size_t i = 0; i < entries.size(); ++i) {
+        for (size_t j = i + 1; j < entries.size(); ++j) {
+          double waste = entries[i].box.unite(entries[j].box).area() - entries[i].box.area() - entries[j].box.area();
+          if (waste > worst) {
+            worst = waste;
+            seed1 = i;
+            seed2 = j;
+          }
+        }
+      }
+
+      Node *sibling = new Node(node->leaf);
+      std::vector<bool> assigned(entries.size(), false);
+      Box box1 = entries[seed1].box, box2 = entries[seed2].box;
+      node->entries.push_back(entries[seed1]);
+      sibling->entries.push_back(entries[seed2]);
+      assigned[seed1] = assigned[seed2] = true;
+
+      size_t remaining = entries.size() - 2;
+      while (remaining > 0) {
+        // Make sure both nodes end up with at least the minimum number of entries.
+        Node *target = nullptr;
+        if (node->entries.size() + remaining <= _min_entries)
+          target = node;
+        else if (sibling->entries.size() + remaining <= _min_entries)
+          target = sibling;
+        if (target != nullptr) {
+          for (size_t i = 0; i < entries.size(); ++i) {
+            if (!assigned[i])
+              target->entries.push_back(entries[i]);
+          }
+          break;
+        }
+
+        size_t next = 0;
+        double growth1 = 0, growth2 = 0, max_difference = -1;
+        for (size_t i = 0; i < entries.size(); ++i) {
+          if (assigned[i])
+            continue;
+          double g1 = box1.unite(entries[i].box).area() - box1.area();
+          double g2 = box2.unite(entries[i].box).area() - box2.area();
+          if (fabs(g1 - g2) > max_difference) {
+            max_difference = fabs(g1 - g2);
+            next = i;
+            growth1 = g1;
+            growth2 = g2;
+          }
+        }
+
+        bool first = growth1 < growth2;
+        if (growth1 == growth2) {
+          if (box1.area() != box2.area())
+            first = box1.area() < box2.area();
+          else
+            first = node->entries.size() <= sibling->entries.size();
+        }
+        if (first) {
+          node->entries.push_back(entries[next]);
+          box1 = box1.unite(entries[next].box);
+        } else {
+          sibling->entries.push_back(entries[next]);
+          box2 = box2.unite(entries[next].box);
+        }
+        assigned[next] = true;
+        --remaining;
+      }
+
+      if (!node->leaf) {
+        for (typename std::vector<Entry>::iterator iter = sibling->entries.begin(); iter != sibling->entries.end();
+             ++iter)
+          iter->child->parent = sibling;
+      }
+      return sibling;
+    }
+
+    static void collect_values(Node *node, std::vector<T> &values) {
+      for (typename std::vector<Entry>::iterator iter = node->entries.begin(); iter != node->entries.end(); ++iter) {
+        if (node->leaf)
+          values.push_back(iter->value);
+        else
+          collect_values(iter->child, values);
+      }
+    }
+
+    // Removes underfull nodes on the way up from the given leaf and reinserts their values.
+    void condense_tree(Node *leaf) {
+      std::vector<T> orphans;
+      Node *node = leaf;
+      while (node->parent != nullptr) {
+        Node *parent = node->parent;
+        if (node->entries.size() < _min_entries) {
+          for (typename std::vector<Entry>::iterator iter = parent->entries.begin(); iter != parent->entries.end();
+               ++iter) {
+            if (iter->child == node) {
+              parent->entries.erase(iter);
+              break;
+            }
+          }
+          collect_values(node, orphans);
+          free_node(node);
+        } else
+          parent_entry(node).box = node_box(node);
+        node = parent;
+      }
+
+      while (!_root->leaf && _root->entries.size() == 1) {
+        Node *old_root = _root;
+        _root = old_root->entries.front().child;
+        _root->parent = nullptr;
+        delete old_root;
+      }
+      if (!_root->leaf && _root->entries.empty())
+        _root->leaf = true;
+
+      for (typename std::vector<T>::const_iterator iter = orphans.begin(); iter != orphans.end(); ++iter)
+        insert_entry(_values[*iter], *iter);
+    }
+  };
+
+} // end of mdc namespace
+
+#endif /* _MDC_RTREE_H_ */
@@ -216,7 +216,7 @@ void TextFigure::draw_contents(CairoCtx *cr, const Rect &bounds) {
     Point text_pos;
 
     cr->set_font(_font);
-    cr->get_text_extents(_font, _text.c_str(), extents);
+    extents = cr->get_text_layout(_font, _text)->extents;
 
     x = bounds.left() + _xpadding;
     y = bounds.bottom() - (bounds.height() - _font_extents.height) / 2 - _font_extents.descent;
@@ -239,38 +239,36 @@ void TextFigure::draw_contents(CairoCtx *cr, const Rect &bounds) {
     if (extents.width > bounds.size.width - 2 * _xpadding) {
       // the text doesnt fit in the space we have, so check how much of it does fit
       if (_shrinked_text.empty()) {
-        cr->get_text_extents(_font, "\xe2\x80\xa6", extents);
+        double max_width = bounds.size.width - 2 * _xpadding;
+        if (!TextLayoutCache::get()->lookup_fitted(_font, _text, max_width, _shrinked_text)) {
+          cr->get_text_extents(_font, "\xe2\x80\xa6", extents);
 
-        _shrinked_text =
-          fit_text_to_width(cr, _font, _text, bounds.size.width - 2 * _xpadding - extents.x_advance, extents);
-        _shrinked_text.append("\xe2\x80\xa6");
+          _shrinked_text = fit_text_to_width(cr, _font, _text, max_width - extents.x_advance, extents);
+          _shrinked_text.append("\xe2\x80\xa6");
+          TextLayoutCache::get()->add_fitted(_font, _text, max_width, _shrinked_text);
+        }
       }
       text = _shrinked_text;
     }
 
+    TextLayoutCache::LayoutRef layout = cr->get_text_layout(_font, text);
+
     if (_highlight_color && _highlighted && _highlight_through_text) {
       cr->set_color(*_highlight_color);
       for (int x = -3; x <= 3; x++) {
-        for (int y = -3; y <= 3; y++) {
-          cr->move_to(text_pos + Point(x, y));
-          cr->show_text(text);
-        }
+        for (int y = -3; y <= 3; y++)
+          cr->show_text_layout(*layout, text_pos + Point(x, y));
       }
     }
     if (_draw_outline) {
       cr->set_color(base::Color::white());
-      cr->move_to(text_pos + Point(1, 0));
-      cr->show_text(text);
-      cr->move_to(text_pos - Point(1, 0));
-      cr->show_text(text);
-      cr->move_to(text_pos + Point(0, 1));
-      cr->show_text(text);
-      cr->move_to(text_pos - Point(0, 1));
-      cr->show_text(text);
+      cr->show_text_layout(*layout, text_pos + Point(1, 0));
+      cr->show_text_layout(*layout, text_pos - Point(1, 0));
+      cr->show_text_layout(*layout, text_pos + Point(0, 1));
+      cr->show_text_layout(*layout, text_pos - Point(0, 1));
     }
     cr->set_color(_pen_color);
-    cr->move_to(text_pos);
-    cr->show_text(text);
+    cr->show_text_layout(*layout, text_pos);
 
     cr->check_state();
   }
@@ -356,9 +354,7 @@ Size TextFigure::get_text_size() {
     return _text_layout->get_size();
   }
   Size size;
-  cairo_text_extents_t extents;
-
-  get_layer()->get_view()->cairoctx()->get_text_extents(_font, _text, extents);
+  cairo_text_extents_t extents = get_layer()->get_view()->cairoctx()->get_text_layout(_font, _text)->extents;
 
   size.width = ceil(extents.x_advance);
   size.height = ceil(_font_extents.height);
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "mdc_tile_cache.h"
+#include "mdc_algorithms.h"
+
+using namespace mdc;
+using namespace base;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TileCache::TileCache(size_t max_memory, const MemoryCallback &bookkeep)
+  : _memory(0), _max_memory(max_memory), _bookkeep(bookkeep) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TileCache::~TileCache() {
+  clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void TileCache::set_max_memory(size_t max_memory) {
+  _max_memory = max_memory;
+  shrink_to(_max_memory);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TileCache::Key TileCache::make_key(double zoom, int x, int y) {
+  Key key;
+  key.zoom = (int)floor(zoom * 1000 + 0.5);
+  key.x = x;
+  key.y = y;
+  return key;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Rect TileCache::tile_bounds(double zoom, int x, int y) {
+  double size = TileSize / zoom;
+  return Rect(x * size, y * size, size, size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+cairo_surface_t *TileCache::get(double zoom, int x, int y) {
+  std::map<Key, Tile>::iterator tile = _tiles.find(make_key(zoom, x, y));
+  if (tile == _tiles.end())
+    return 0;
+
+  _lru.splice(_lru.begin(), _lru, tile->second.lru_position);
+  return tile->second.surface;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void TileCache::add(double zoom, int x, int y, cairo_surface_t *surface) {
+  Key key = make_key(zoom, x, y);
+  std::map<Key, Tile>::iterator old = _tiles.find(key);
+  if (old != _tiles.end())
+    remove(old);
+
+  size_t size = cairo_image_surface_get_stride(surface) * cairo_image_surface_get_height(surface);
+  if (size > _max_memory) {
+    cairo_surface_destroy(surface);
+    return;
+  }
+  shrink_to(_max_memory - size);
+
+  _lru.push_front(key);
+  Tile tile;
+  tile.surface = surface;
+  tile.lru_position = _lru.begin();
+  _tiles[key] = tile;
+
+  _memory += size;
+  if (_bookkeep)
+    _bookkeep((int)size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void TileCache::invalidate(const Rect &area) {
+  std::map<Key, Tile>::iterator next, tile = _tiles.begin();
+  while (tile != _tiles.end()) {
+    next = tile;
+    ++next;
+    const Key &key = tile->first;
+    if (bounds_intersect(tile_bounds(key.zoom / 1000.0, key.x, key.y), area))
+      remove(tile);
+    tile = next;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void TileCache::clear() {
+  while (!_tiles.empty())
+    remove(_tiles.begin());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void TileCache::remove(std::map<Key, Tile>::iterator tile) {
+  size_t size = cairo_image_surface_get_stride(tile->second.surface) *
+                cairo_image_surface_get_height(tile->second.surface);
+
+  cairo_surface_destroy(tile->second.surface);
+  _lru.erase(tile->second.lru_position);
+  _tiles.erase(tile);
+
+  _memory -= size;
+  if (_bookkeep)
+    _bookkeep(-(int)size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void TileCache::shrink_to(size_t max_memory) {
+  while (_memory > max_memory && !_lru.empty())
+    remove(_tiles.find(_lru.back()));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#ifndef _MDC_TILE_CACHE_H_
+#define _MDC_TILE_CACHE_H_
+
+#include "mdc_common.h"
+
+#include <functional>
+
+namespace mdc {
+
+  /**
+   * Keeps rendered tiles of the diagram contents, so that scrolling and zooming to a previously used zoom level are
+   * just blits as long as nothing changed. Tiles have a fixed size in pixels and are kept per zoom level. The least
+   * recently used tiles are dropped when the memory limit is reached.
+   */
+  class MYSQLCANVAS_PUBLIC_FUNC TileCache {
+  public:
+    static const int TileSize = 256; // In pixels.
+
+    typedef std::function<void(int)> MemoryCallback;
+
+    TileCache(size_t max_memory, const MemoryCallback &bookkeep = MemoryCallback());
+    ~TileCache();
+
+    void set_max_memory(size_t max_memory);
+    size_t get_max_memory() const {
+      return _max_memory;
+    }
+    size_t get_memory() const {
+      return _memory;
+    }
+    size_t count() const {
+      return _tiles.size();
+    }
+
+    // The area in canvas coordinates covered by the given tile.
+    static base::Rect tile_bounds(double zoom, int x, int y);
+
+    // Returns the cached tile or 0 if there is none. The surface stays owned by the cache.
+    cairo_surface_t *get(double zoom, int x, int y);
+
+    // Adds a tile to the cache, which takes over the surface reference.
+    void add(double zoom, int x, int y, cairo_surface_t *surface);
+
+    // Removes all tiles (of any zoom level) which overlap the given area in canvas coordinates.
+    void invalidate(const base::Rect &area);
+    void clear();
+
+  private:
+    struct Key {
+      int zoom; // The zoom factor in 1/1000.
+      int x;
+      int y;
+
+      bool operator<(const Key &other) const {
+        if (zoom != other.zoom)
+          return zoom < other.zoom;
+        if (y != other.y)
+          return y < other.y;
+        return x < other.x;
+      }
+    };
+
+    struct Tile {
+      cairo_surface_t *surface;
+      std::list<Key>::iterator lru_position;
+    };
+
+    std::map<Key, Tile> _tiles;
+    std::list<Key> _lru; // Most recently used first.
+    size_t _memory;
+    size_t _max_memory;
+    MemoryCallback _bookkeep;
+
+    static Key make_key(double zoom, int x, int y);
+    void remove(std::map<Key, Tile>::iterator tile);
+    void shrink_to(size_t max_memory);
+  };
+
+} // end of mdc namespace
+
+#endif /* _MDC_TILE_CACHE_H_ */
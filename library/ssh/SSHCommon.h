@@ -119,7 +119,7 @@ namespace ssh {
 
     SSHConnectionConfig();
 
-    std::string getServer() {
+    std::string getServer() const {
       return remoteSSHhost + ":" + std::to_string(remoteSSHport);
     }
 
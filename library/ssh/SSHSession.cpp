@@ -44,7 +44,7 @@ namespace ssh {
   }
 
   SSHSession::SSHSession()
-      : _session(new ssh::Session()), _isConnected(false), _event(nullptr) {
+      : _session(new ssh::Session()), _isConnected(false), _event(nullptr), _lockCount(0) {
     initLibSSH();
   }
 
@@ -191,14 +191,23 @@ namespace ssh {
       return;
     }
 
+    ++_lockCount;
+    logDebug2("Session pool event\n");
+    handlePackets();
+    _sessionMutex.unlock();
+  }
+
+  // Processes whatever the server sent without waiting for more, the caller must hold the session lock.
+  void SSHSession::handlePackets() {
+    if (!_isConnected)
+      return;
+
     if (_event == nullptr) {
       _event = ssh_event_new();
       ssh_event_add_session(_event, _session->getCSession());
     }
 
-    logDebug2("Session pool event\n");
     ssh_event_dopoll(_event, 0);
-    _sessionMutex.unlock();
   }
 
   void SSHSession::disconnect() {
@@ -247,6 +256,7 @@ namespace ssh {
 
 
   bool SSHSession::openChannel(ssh::Channel *chann) {
+    auto start = std::chrono::steady_clock::now();
     int rc = SSH_ERROR;
     std::size_t i = 0;
     while (i < _config.connectTimeout) {
@@ -261,7 +271,8 @@ namespace ssh {
         logError("Unable to open channel: %s \n", ssh_get_error(chann->getCSession()));
         return false;
       } else {
-        logDebug("Channel successfully opened\n");
+        logDebug("Channel successfully opened in %.1f ms\n",
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
         return true;
       }
     }
@@ -492,9 +503,25 @@ namespace ssh {
 
   base::MutexLock SSHSession::lockSession() {
     base::MutexLock mutexLock(_sessionMutex);
+    ++_lockCount;
     return mutexLock;
   }
 
+  // For callers which must not wait while another thread uses the session, like the tunnel event loop.
+  bool SSHSession::tryLockSession() {
+    return _sessionMutex.tryLock();
+  }
+
+  void SSHSession::unlockSession() {
+    _sessionMutex.unlock();
+  }
+
+  // How often the session was used through lockSession() or pollEvent(), i.e. by anything but the tunnel event loop.
+  // Those users may have read tunnel traffic from the socket, which the event loop then won't be woken up for.
+  std::size_t SSHSession::lockCount() const {
+    return _lockCount;
+  }
+
   int SSHSession::verifyKnownHost(const ssh::SSHConnectionConfig &config, std::string &fingerprint) {
     std::unique_ptr<unsigned char, void (*)(unsigned char*)> hash(
         nullptr, [](unsigned char* v) {if (v != nullptr) ssh_clean_pubkey_hash(&v);});
@@ -41,6 +41,7 @@
 #include "SSHCommon.h"
 #include "base/any.h"
 #include "base/threading.h"
+#include <atomic>
 #include <memory>
 
 namespace ssh {
@@ -51,6 +52,7 @@ namespace ssh {
     bool _isConnected;
     ssh_event _event;
     mutable base::Mutex _sessionMutex;
+    std::atomic<std::size_t> _lockCount;
   public:
     static std::shared_ptr<SSHSession> createSession();
     virtual ~SSHSession();
@@ -68,6 +70,10 @@ namespace ssh {
                                                           std::size_t logSize = LOG_SIZE_100MB);
 
     base::MutexLock lockSession();
+    bool tryLockSession();
+    void unlockSession();
+    std::size_t lockCount() const;
+    void handlePackets();
     void reconnect();
   protected:
     SSHSession();
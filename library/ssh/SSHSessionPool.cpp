@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "SSHSessionPool.h"
+
+#include "base/log.h"
+#include "base/threaded_timer.h"
+
+#include <algorithm>
+
+DEFAULT_LOG_DOMAIN("SSHSessionPool")
+
+namespace ssh {
+
+  SSHSessionPool *SSHSessionPool::get() {
+    // Never destroyed, the cleanup timer may still fire while the application shuts down.
+    static SSHSessionPool *pool = new SSHSessionPool();
+    return pool;
+  }
+
+  SSHSessionPool::SSHSessionPool() : _idleTimeout(120), _cleanupTask(0) {
+  }
+
+  std::string SSHSessionPool::makeKey(const SSHConnectionConfig &config, const SSHConnectionCredentials &credentials,
+                                     Use use) {
+    return std::string(use == Use::TUNNEL ? "tunnel|" : "commands|") + credentials.username + "@" +
+           config.remoteSSHhost + ":" + std::to_string(config.remoteSSHport) + "|" + credentials.keyfile;
+  }
+
+  std::tuple<SSHReturnType, base::any> SSHSessionPool::acquire(const SSHConnectionConfig &config,
+                                                               const SSHConnectionCredentials &credentials, Use use,
+                                                               std::shared_ptr<SSHSession> &session) {
+    std::string key = makeKey(config, credentials, use);
+    std::vector<std::shared_ptr<SSHSession>> toClose;
+    {
+      base::MutexLock lock(_poolMutex);
+      auto range = _sessions.equal_range(key);
+      for (auto it = range.first; it != range.second;) {
+        if (!it->second.stale && it->second.session->isConnected()) {
+          session = it->second.session;
+          ++it->second.users;
+          logInfo("Reusing SSH session to %s, now used %d times.\n", config.getServer().c_str(),
+                  (int)it->second.users);
+          return std::make_tuple(SSHReturnType::CONNECTED, nullptr);
+        }
+
+        // A lost session stays with its current users (they reconnect it on their own) until the last of them
+        // releases it, new users get a new one.
+        if (it->second.users > 0) {
+          it->second.stale = true;
+          ++it;
+        } else {
+          toClose.push_back(it->second.session);
+          it = _sessions.erase(it);
+        }
+      }
+    }
+
+    for (auto &stale : toClose)
+      stale->disconnect();
+
+    session = SSHSession::createSession();
+    auto start = std::chrono::steady_clock::now();
+    auto retVal = session->connect(config, credentials);
+    if (std::get<0>(retVal) != SSHReturnType::CONNECTED)
+      return retVal;
+
+    logInfo("Opened SSH session to %s in %.1f ms.\n", config.getServer().c_str(),
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+    std::shared_ptr<SSHSession> duplicate;
+    {
+      base::MutexLock lock(_poolMutex);
+      auto range = _sessions.equal_range(key);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (!it->second.stale && it->second.session->isConnected()) {
+          // Somebody else connected in the meantime, share theirs.
+          duplicate = session;
+          session = it->second.session;
+          ++it->second.users;
+          break;
+        }
+      }
+
+      if (!duplicate)
+        _sessions.insert({ key, { session, 1, std::chrono::steady_clock::now(), false } });
+    }
+
+    if (duplicate)
+      duplicate->disconnect();
+
+    return retVal;
+  }
+
+  void SSHSessionPool::release(std::shared_ptr<SSHSession> session) {
+    if (!session)
+      return;
+
+    std::shared_ptr<SSHSession> toClose = session;
+    {
+      base::MutexLock lock(_poolMutex);
+      for (auto it = _sessions.begin(); it != _sessions.end(); ++it) {
+        if (it->second.session != session)
+          continue;
+
+        toClose.reset();
+        if (it->second.users > 0)
+          --it->second.users;
+
+        if (it->second.users == 0) {
+          if (_idleTimeout <= 0 || it->second.stale || !session->isConnected()) {
+            toClose = session;
+            _sessions.erase(it);
+          } else {
+            it->second.idleSince = std::chrono::steady_clock::now();
+            scheduleCleanup();
+          }
+        }
+        break;
+      }
+    }
+
+    if (toClose) {
+      logDebug2("Closing SSH session which is no longer used.\n");
+      toClose->disconnect();
+    }
+  }
+
+  bool SSHSessionPool::isShared(const std::shared_ptr<SSHSession> &session) {
+    base::MutexLock lock(_poolMutex);
+    for (auto &it : _sessions) {
+      if (it.second.session == session)
+        return it.second.users > 1;
+    }
+    return false;
+  }
+
+  void SSHSessionPool::setIdleTimeout(int seconds) {
+    base::MutexLock lock(_poolMutex);
+    _idleTimeout = seconds;
+  }
+
+  /**
+   * Disconnects the unused sessions which reached the idle timeout (or all unused ones). Returns the number of
+   * unused sessions which are kept.
+   */
+  std::size_t SSHSessionPool::closeIdleSessions(bool all) {
+    std::vector<std::shared_ptr<SSHSession>> toClose;
+    std::size_t idle = 0;
+    {
+      base::MutexLock lock(_poolMutex);
+      auto now = std::chrono::steady_clock::now();
+      for (auto it = _sessions.begin(); it != _sessions.end();) {
+        if (it->second.users == 0 &&
+            (all || !it->second.session->isConnected() ||
+             now - it->second.idleSince >= std::chrono::seconds(_idleTimeout))) {
+          toClose.push_back(it->second.session);
+          it = _sessions.erase(it);
+          continue;
+        }
+
+        if (it->second.users == 0)
+          ++idle;
+        ++it;
+      }
+
+      if (idle == 0)
+        _cleanupTask = 0;
+    }
+
+    for (auto &session : toClose) {
+      logDebug("Closing SSH session to %s after being idle.\n", session->getConfig().getServer().c_str());
+      session->disconnect();
+    }
+
+    return idle;
+  }
+
+  // Must be called with the pool locked.
+  void SSHSessionPool::scheduleCleanup() {
+    if (_cleanupTask != 0)
+      return;
+
+    // The task stops itself once no unused session is left.
+    _cleanupTask = ThreadedTimer::add_task(TimerTimeSpan, std::max(1, _idleTimeout / 4), false,
+                                           [this](int) { return closeIdleSessions() == 0; });
+  }
+
+} /* namespace ssh */
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <vector>
+#include "SSHCommon.h"
+#include "SSHSession.h"
+
+namespace ssh {
+
+  // Keeps authenticated sessions around, so tunnels (or SFTP and remote commands) going to the same host with the same
+  // account open their channels over a single connection instead of doing a key exchange and authentication each.
+  // Sessions are reference counted and disconnected once they have not been used for the idle timeout.
+  class WBSSHLIBRARY_PUBLIC_FUNC SSHSessionPool {
+  public:
+    // SFTP transfers and remote commands hold the session lock until they are done, which would stall the tunnels
+    // in the meantime. So they never share a session with tunnels.
+    enum class Use { TUNNEL, COMMANDS };
+
+    static SSHSessionPool *get();
+
+    // Returns a connected session for the given host and account in session, reusing a pooled one if possible.
+    // The result is the same as from SSHSession::connect(). Only sessions which got connected are pooled.
+    std::tuple<SSHReturnType, base::any> acquire(const SSHConnectionConfig &config,
+                                                 const SSHConnectionCredentials &credentials, Use use,
+                                                 std::shared_ptr<SSHSession> &session);
+
+    // Gives up one use of the session. Sessions which aren't pooled are disconnected right away.
+    void release(std::shared_ptr<SSHSession> session);
+
+    bool isShared(const std::shared_ptr<SSHSession> &session);
+    void setIdleTimeout(int seconds);
+    std::size_t closeIdleSessions(bool all = false);
+
+  private:
+    struct Entry {
+      std::shared_ptr<SSHSession> session;
+      std::size_t users;
+      std::chrono::steady_clock::time_point idleSince;
+      bool stale; // Lost its connection while in use. Kept for its users, but not handed out again.
+    };
+
+    SSHSessionPool();
+    static std::string makeKey(const SSHConnectionConfig &config, const SSHConnectionCredentials &credentials, Use use);
+    void scheduleCleanup();
+
+    base::Mutex _poolMutex;
+    std::multimap<std::string, Entry> _sessions;
+    int _idleTimeout;
+    int _cleanupTask;
+  };
+
+} /* namespace ssh */
@@ -28,6 +28,7 @@
 #ifndef _MSC_VER
 #include <unistd.h>
 #endif
+#include <deque>
 #include <vector>
 #include "SSHSftp.h"
 
@@ -35,8 +36,11 @@ DEFAULT_LOG_DOMAIN("SSHSftp")
 
 namespace ssh {
 
+  // Largest payload OpenSSH's sftp-server accepts in a single message, with some room for the message header.
+  static const std::size_t MaxChunkSize = 255 * 1024;
+
   SSHSftp::SSHSftp(std::shared_ptr<SSHSession> session, std::size_t maxFileSize)
-      : _session(session), _maxFileLimit(maxFileSize) {
+      : _session(session), _maxFileLimit(maxFileSize), _maxRequests(1), _chunkSize(16384) {
 
     auto lock = _session->lockSession();
     _sftp = sftp_new(_session->getSession()->getCSession());
@@ -220,10 +224,94 @@ namespace ssh {
     });
   }
 
+  void SSHSftp::read(sftp_file file, const std::function<void(const char *, std::size_t)> &sink) const {
+    std::vector<char> buffer(_chunkSize);
+
+    if (_maxRequests <= 1) {
+      while (true) {
+        ssize_t nBytes = sftp_read(file, buffer.data(), buffer.size());
+        if (nBytes == 0)
+          break;
+        else if (nBytes < 0)
+          throw SSHSftpException(_session->getSession()->getError());
+
+        sink(buffer.data(), nBytes);
+      }
+      return;
+    }
+
+    struct Request {
+      int id;
+      uint64_t offset;
+      uint32_t length;
+    };
+
+    // Every request carries its own offset, so a short read can be completed by asking for the rest again.
+    auto sendRequest = [&](uint64_t offset, uint32_t length) {
+      sftp_seek64(file, offset);
+      int id = sftp_async_read_begin(file, length);
+      if (id < 0)
+        throw SSHSftpException(_session->getSession()->getError());
+      return Request{ id, offset, length };
+    };
+
+    std::deque<Request> requests;
+    uint64_t nextOffset = sftp_tell64(file);
+    bool eof = false;
+    try {
+      while (true) {
+        while (!eof && requests.size() < _maxRequests) {
+          requests.push_back(sendRequest(nextOffset, (uint32_t)buffer.size()));
+          nextOffset += buffer.size();
+        }
+        if (requests.empty())
+          break;
+
+        Request current = requests.front();
+        requests.pop_front();
+
+        // Seeking clears the file's eof flag, without which replies after the end of the file would not be consumed.
+        sftp_seek64(file, current.offset);
+        int nBytes = sftp_async_read(file, buffer.data(), current.length, current.id);
+        if (nBytes < 0)
+          throw SSHSftpException(_session->getSession()->getError());
+
+        // Data behind the end of the file can only come from a file which grows while we read it. Ignore it.
+        if (eof)
+          continue;
+
+        if (nBytes == 0) {
+          eof = true;
+          continue;
+        }
+
+        sink(buffer.data(), nBytes);
+        if ((uint32_t)nBytes < current.length)
+          requests.push_front(sendRequest(current.offset + nBytes, current.length - nBytes));
+      }
+    } catch (...) {
+      // Outstanding replies would otherwise pile up in the sftp session.
+      for (auto &request : requests) {
+        sftp_seek64(file, request.offset);
+        sftp_async_read(file, buffer.data(), request.length, request.id);
+      }
+      throw;
+    }
+  }
+
+  void SSHSftp::finishTransfer(const std::string &path, uint64_t bytes,
+                               const std::chrono::steady_clock::time_point &start) const {
+    _lastTransfer.bytes = bytes;
+    _lastTransfer.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    logDebug("Transferred %s: %llu bytes in %.2f s (%.1f KB/s)\n", path.c_str(), (unsigned long long)bytes,
+             _lastTransfer.seconds, _lastTransfer.bytesPerSecond() / 1024);
+  }
+
   void SSHSftp::get(const std::string &src, const std::string &dest) const {
     auto lock = _session->lockSession();
-    sftp_file file = sftp_open(_sftp, createRemotePath(src).c_str(), O_RDONLY, 0);
-    if (file == nullptr)
+    auto start = std::chrono::steady_clock::now();
+    auto file = createPtr(sftp_open(_sftp, createRemotePath(src).c_str(), O_RDONLY, 0));
+    if (file->ptr == nullptr)
       throw SSHSftpException(_session->getSession()->getError());
 
     base::FileHandle fileHandle;
@@ -233,26 +321,20 @@ namespace ssh {
       throw SSHSftpException(fe.what());
     }
 
-    char buffer[16384];
-    while (true) {
-      ssize_t nBytes = sftp_read(file, buffer, sizeof(buffer));
-      if (nBytes == 0)
-        break;
-      else if (nBytes < 0) {
-        sftp_close(file);
-        throw SSHSftpException(_session->getSession()->getError());
-      }
-
-      std::size_t nWritten = fwrite(buffer, sizeof(char), nBytes, fileHandle.file());
-      if (nBytes > 0 && nWritten != (std::size_t) nBytes) {
-        sftp_close(file);
+    uint64_t bytesCount = 0;
+    read(file->ptr, [&](const char *data, std::size_t size) {
+      std::size_t nWritten = fwrite(data, sizeof(char), size, fileHandle.file());
+      if (nWritten != size)
         throw SSHSftpException("Error writing file");
-      }
-    }
+      bytesCount += size;
+    });
 
-    int rc = sftp_close(file);
+    int rc = sftp_close(file->ptr);
+    file->ptr = nullptr;
     if (rc != SSH_OK)
       throw SSHSftpException(_session->getSession()->getError());
+
+    finishTransfer(src, bytesCount, start);
   }
 
   void SSHSftp::setContent(const std::string &path, const std::string &data) const {
@@ -271,64 +353,57 @@ namespace ssh {
 
   void SSHSftp::put(const std::string &src, const std::string &dest) const {
     auto lock = _session->lockSession();
-    auto file = createPtr(sftp_open(_sftp, createRemotePath(src).c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRWXU));
+    auto start = std::chrono::steady_clock::now();
+    auto file = createPtr(sftp_open(_sftp, createRemotePath(dest).c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRWXU));
 
     if (file->ptr == nullptr)
       throw SSHSftpException(_session->getSession()->getError());
 
     base::FileHandle fileHandle;
     try {
-      fileHandle = base::FileHandle(src, "w+", true);
+      fileHandle = base::FileHandle(src, "rb", true);
     } catch (base::file_error &fe) {
       throw SSHSftpException(fe.what());
     }
 
-    std::size_t buffSize = 16384;
-    std::vector<char> buff;
-    buff.reserve(buffSize);
+    // libssh has no asynchronous writes, but larger chunks still save round trips.
+    uint64_t bytesCount = 0;
+    std::vector<char> buff(_chunkSize);
     while (true) {
-
-      std::size_t nBytes = fread(buff.data(), sizeof(char), buffSize, fileHandle.file());
-      if (nBytes == buffSize) {
-        ssize_t nWritten = sftp_write(file->ptr, buff.data(), buffSize);
-        if (nWritten > 0 && (std::size_t) nWritten != buffSize) {
-          throw SSHSftpException("Error writing file");
-        }
-      } else if (feof(fileHandle.file())) {
+      std::size_t nBytes = fread(buff.data(), sizeof(char), buff.size(), fileHandle.file());
+      if (nBytes > 0) {
         ssize_t nWritten = sftp_write(file->ptr, buff.data(), nBytes);
-        if (nWritten > 0 && (std::size_t) nWritten != nBytes) {
+        if (nWritten < 0 || (std::size_t) nWritten != nBytes)
           throw SSHSftpException("Error writing file");
-        }
-      } else {
-        throw SSHSftpException("Error reading file");
+        bytesCount += nBytes;
+      }
+
+      if (nBytes < buff.size()) {
+        if (ferror(fileHandle.file()))
+          throw SSHSftpException("Error reading file");
+        break;
       }
     }
+
+    finishTransfer(dest, bytesCount, start);
   }
 
   std::string SSHSftp::getContent(const std::string &src) const {
     auto lock = _session->lockSession();
+    auto start = std::chrono::steady_clock::now();
     auto file = createPtr(sftp_open(_sftp, createRemotePath(src).c_str(), O_RDONLY, 0));
     if (file->ptr == nullptr)
       throw SSHSftpException(_session->getSession()->getError());
 
     std::string buff;
-    size_t bytesCount = 0;
-    char buffer[16384];
-    while (true) {
-      ssize_t nBytes = sftp_read(file->ptr, buffer, sizeof(buffer));
-      if (nBytes == 0)
-        break;
-      else if (nBytes < 0) {
-        throw SSHSftpException(_session->getSession()->getError());
-      }
-      buff.append(buffer, nBytes);
-      bytesCount += nBytes;
-      if (bytesCount > _maxFileLimit) {
+    read(file->ptr, [&](const char *data, std::size_t size) {
+      buff.append(data, size);
+      if (buff.size() > _maxFileLimit) {
         throw SSHSftpException("Max file limit exceeded\n.");
       }
+    });
 
-    }
-
+    finishTransfer(src, buff.size(), start);
     return buff;
   }
 
@@ -336,6 +411,15 @@ namespace ssh {
     _maxFileLimit = limit;
   }
 
+  void SSHSftp::setTransferOptions(std::size_t maxRequests, std::size_t chunkSize) {
+    _maxRequests = std::max<std::size_t>(maxRequests, 1);
+    _chunkSize = std::min(std::max<std::size_t>(chunkSize, 1024), MaxChunkSize);
+  }
+
+  SftpTransferStats SSHSftp::lastTransferStats() const {
+    return _lastTransfer;
+  }
+
   int SSHSftp::cd(const std::string &dirname) {
     auto lock = _session->lockSession();
     if (dirname.empty())
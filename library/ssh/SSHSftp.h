@@ -41,6 +41,8 @@
 #include "SSHCommon.h"
 #include "SSHSession.h"
 #include "base/any.h"
+#include <chrono>
+#include <functional>
 #include <vector>
 
 #if defined(_MSC_VER)
@@ -80,11 +82,23 @@ namespace ssh {
     bool isDir;
   };
 
+  struct SftpTransferStats {
+    uint64_t bytes = 0;
+    double seconds = 0;
+
+    double bytesPerSecond() const {
+      return seconds > 0 ? bytes / seconds : 0;
+    }
+  };
+
   class WBSSHLIBRARY_PUBLIC_FUNC SSHSftp {
     std::shared_ptr<SSHSession> _session;
     sftp_session _sftp;
     std::size_t _maxFileLimit;
     std::vector<std::string> _path;
+    std::size_t _maxRequests;
+    std::size_t _chunkSize;
+    mutable SftpTransferStats _lastTransfer;
   public:
     SSHSftp(std::shared_ptr<SSHSession> session, std::size_t maxFileSize);
     virtual ~SSHSftp();
@@ -99,6 +113,11 @@ namespace ssh {
     void put(const std::string &src, const std::string &dest) const;
     std::string getContent(const std::string &src) const;
     void setMaxFileLimit(std::size_t limit);
+
+    // Number of read requests get() and getContent() keep in flight and the size of each request (also used as
+    // write size by put()). With a single request every chunk waits for a full round trip.
+    void setTransferOptions(std::size_t maxRequests, std::size_t chunkSize);
+    SftpTransferStats lastTransferStats() const;
     int cd(const std::string &dirname);
     std::vector<SftpStatAttrib> ls(const std::string &dirname) const;
     std::string pwd() const;
@@ -109,6 +128,9 @@ namespace ssh {
     SSHSftp(const SSHSftp&& ses) = delete;
     SSHSftp &operator =(SSHSftp&) = delete;
     void throwOnError(int rc) const;
+    void read(sftp_file file, const std::function<void(const char *, std::size_t)> &sink) const;
+    void finishTransfer(const std::string &path, uint64_t bytes,
+                        const std::chrono::steady_clock::time_point &start) const;
     std::string createRemotePath(const std::string &path) const;
 
   };
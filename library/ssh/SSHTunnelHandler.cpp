@@ -22,7 +22,9 @@
  */
 
 #include "SSHTunnelHandler.h"
+#include "SSHSessionPool.h"
 
+#include <algorithm>
 #include "base/log.h"
 
 DEFAULT_LOG_DOMAIN("SSHTunnelHandler")
@@ -37,21 +39,59 @@ DEFAULT_LOG_DOMAIN("SSHTunnelHandler")
 
 namespace ssh {
 
-  SSHTunnelHandler::SSHTunnelHandler(uint16_t localPort, int localSocket, std::shared_ptr<SSHSession> session)
-      : _session(std::move(session)), _localPort(localPort), _localSocket(localSocket), _pollTimeout(-1) {
-    _event = ssh_event_new();
-    ssh_event_add_session(_event, _session->getSession()->getCSession());
+  static bool isWouldBlock() {
+#if _MSC_VER
+    int error = WSAGetLastError();
+    return error == WSAEWOULDBLOCK || error == WSAEINTR;
+#else
+    return errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR;
+#endif
+  }
+
+  SSHTunnelBuffer::SSHTunnelBuffer(std::size_t capacity) : _data(capacity), _start(0), _size(0) {
+  }
+
+  char *SSHTunnelBuffer::writePtr(std::size_t &length) {
+    std::size_t end = (_start + _size) % _data.size();
+    length = (end < _start || full()) ? _start - end : _data.size() - end;
+    return _data.data() + end;
+  }
+
+  void SSHTunnelBuffer::commit(std::size_t length) {
+    _size += length;
+  }
+
+  const char *SSHTunnelBuffer::readPtr(std::size_t &length) const {
+    length = std::min(_size, _data.size() - _start);
+    return _data.data() + _start;
+  }
+
+  void SSHTunnelBuffer::consume(std::size_t length) {
+    _size -= length;
+    _start = _size == 0 ? 0 : (_start + length) % _data.size();
+  }
+
+  SSHTunnelHandler::Connection::Connection(int sock, std::size_t bufferSize)
+      : socket(sock), toServer(bufferSize), toClient(bufferSize), events(0), opened(false), clientEof(false),
+        eofSent(false), channelEof(false), openStarted(std::chrono::steady_clock::now()) {
+  }
+
+  SSHTunnelHandler::SSHTunnelHandler(uint16_t localPort, int localSocket, std::shared_ptr<SSHSession> session,
+                                     const SSHConnectionConfig &config)
+      : _session(std::move(session)), _config(config), _localPort(localPort), _localSocket(localSocket),
+        _event(nullptr), _acceptPending(false), _alive(true), _sessionBusy(false), _seenLockCount(0) {
   }
 
   SSHTunnelHandler::~SSHTunnelHandler() {
-    stop();
-    ssh_event_remove_session(_event, _session->getSession()->getCSession());
-    ssh_event_free(_event);
+    detach();
+    logDebug("Tunnel on port %d closed, %llu bytes sent, %llu bytes received over %llu connections, "
+             "average channel open time %.1f ms.\n", _localPort, (unsigned long long)_stats.bytesToServer,
+             (unsigned long long)_stats.bytesToClient, (unsigned long long)_stats.connections,
+             _stats.averageChannelOpenMs());
     if (_session) {
-      _session->disconnect();
+      SSHSessionPool::get()->release(_session);
       _session.reset();
     }
-
   }
 
   int SSHTunnelHandler::getLocalSocket() const {
@@ -63,208 +103,315 @@ namespace ssh {
   }
 
   SSHConnectionConfig SSHTunnelHandler::getConfig() const {
-    return _session->getConfig();
+    return _config;
   }
 
-  void SSHTunnelHandler::run() {
-    handleConnection();
+  SSHTunnelStats SSHTunnelHandler::getStats() const {
+    return _stats;
   }
 
-  // This is noop function so ssh_even_dopoll will exit once client socket will have new data
+  bool SSHTunnelHandler::isAlive() const {
+    return _alive;
+  }
+
+  bool SSHTunnelHandler::isAttached() const {
+    return _event != nullptr;
+  }
 
-    static int onSocketEvent(socket_t fd, int revents, void *userdata) {
-      //the return should be:
-      //  0 success
-      // -1 the internal ssh_poll_handle was removed/freed and should be removed from the context
-      // -2 an error happened and the ssh_event_dopoll() should stop
-      return 0;
+  void SSHTunnelHandler::attach(ssh_event event) {
+    if (ssh_event_add_fd(event, _localSocket, POLLIN, onListenSocketEvent, this) != SSH_OK) {
+      logError("Unable to register tunnel on port %d with the event loop.\n", _localPort);
+      _alive = false;
+      return;
     }
+    _event = event;
+    logDebug3("Tunnel on port %d attached to the event loop.\n", _localPort);
+  }
 
-  void SSHTunnelHandler::handleConnection() {
-    logDebug3("Start tunnel handler thread.\n");
-    int rc = 0;
+  void SSHTunnelHandler::detach() {
+    if (_event == nullptr)
+      return;
 
-    do {
-      std::unique_lock<std::recursive_mutex> lock(_newConnMtx);
-      if(!_newConnection.empty()) {
-        prepareTunnel(_newConnection.back());
-        _newConnection.pop_back();
-      }
-      lock.unlock();
-      rc = ssh_event_dopoll(_event, 100);
+    if (!_connections.empty()) {
+      auto lock = _session->lockSession();
+      closeConnections();
+    }
+    ssh_event_remove_fd(_event, _localSocket);
+    _event = nullptr;
+  }
 
-      if (rc == SSH_ERROR) {
-        logError("There was an error handling connection poll, retrying: %s\n", _session->getSession()->getError());
+  socket_t SSHTunnelHandler::getSessionSocket() const {
+    if (!_alive || _sessionBusy || !_session->isConnected())
+      return SSH_INVALID_SOCKET;
+    return ssh_get_fd(_session->getSession()->getCSession());
+  }
 
-        for (auto &sIt : _clientSocketList) {
-          ssh_event_remove_fd(_event, sIt.first);
-          sIt.second->close();
-          wbCloseSocket(sIt.first);
-          sIt.second.reset();
-        }
-        _clientSocketList.clear();
+  // Whether the manager should look at us again soon, even without any socket becoming ready. That's the case when
+  // the session was busy, or when another thread used it since we last processed it, which may have read our data
+  // from the socket. Other tunnels on the same session are processed in the same loop and need no polling.
+  bool SSHTunnelHandler::needsPolling() const {
+    return _alive && _event != nullptr && (_sessionBusy || _session->lockCount() != _seenLockCount);
+  }
 
-        ssh_event_remove_session(_event, _session->getSession()->getCSession());
-        ssh_event_free(_event);
+  // The callbacks only record readiness, all the work happens in process() once ssh_event_dopoll() returned, as the
+  // event must not be modified while it dispatches.
+  int SSHTunnelHandler::onListenSocketEvent(socket_t fd, int revents, void *userdata) {
+    static_cast<SSHTunnelHandler *>(userdata)->_acceptPending = true;
+    return 0;
+  }
 
-        if (!_session->isConnected())
-          _session->reconnect();
-        if (!_session->isConnected()) {
-          logError("Unable to reconnect session.\n");
-          break;
-        }
+  int SSHTunnelHandler::onClientSocketEvent(socket_t fd, int revents, void *userdata) {
+    //the return should be:
+    //  0 success
+    // -1 the internal ssh_poll_handle was removed/freed and should be removed from the context
+    // -2 an error happened and the ssh_event_dopoll() should stop
+    return 0;
+  }
+
+  void SSHTunnelHandler::process() {
+    if (_event == nullptr)
+      return;
+
+    // Don't wait for others using the same session, just come back a bit later.
+    _sessionBusy = !_session->tryLockSession();
+    if (_sessionBusy)
+      return;
+
+    _session->handlePackets();
+    if (!_session->isConnected()) {
+      _session->unlockSession();
+      handleSessionError();
+      return;
+    }
+
+    // Others expect the session to be blocking, while we must never wait in here.
+    ssh_session session = _session->getSession()->getCSession();
+    int blocking = ssh_is_blocking(session);
+    ssh_set_blocking(session, 0);
+
+    if (_acceptPending)
+      acceptConnections();
 
-        _event = ssh_event_new();
-        ssh_event_add_session(_event, _session->getSession()->getCSession());
-        continue;
+    for (auto it = _connections.begin(); it != _connections.end();) {
+      Connection &connection = *it->second;
+      bool keep = false;
+      try {
+        keep = openChannel(connection) && (!connection.opened || pump(connection)) && updateEvents(connection);
+      } catch (SSHTunnelException &exc) {
+        logError("Error during data transfer: %s\n", exc.what());
       }
 
-      for (auto it = _clientSocketList.begin(); it != _clientSocketList.end() && !_stop;) {
-        try {
-          transferDataFromClient(it->first, it->second.get());
-          transferDataToClient(it->first, it->second.get());
-          ++it;
-        } catch (SSHTunnelException &exc) {
-            ssh_event_remove_fd(_event, it->first);
-            it->second->close();
-            it->second.reset();
-            wbCloseSocket(it->first);
-            it = _clientSocketList.erase(it);
-          logError("Error during data transfer: %s\n", exc.what());
-        }
+      if (keep) {
+        ++it;
+      } else {
+        closeConnection(connection);
+        it = _connections.erase(it);
       }
+    }
+
+    ssh_set_blocking(session, blocking);
+    _seenLockCount = _session->lockCount();
+    _session->unlockSession();
+  }
 
-    } while (!_stop);
+  // Called without holding the session lock, as reconnecting needs it.
+  void SSHTunnelHandler::handleSessionError() {
+    logError("There was an error handling connection poll, reconnecting: %s\n", _session->getSession()->getError());
 
-    for (auto &sIt : _clientSocketList) {
-      ssh_event_remove_fd(_event, sIt.first);
-      sIt.second->close();
-      wbCloseSocket(sIt.first);
-      sIt.second.reset();
+    {
+      auto lock = _session->lockSession();
+      closeConnections();
     }
-    _clientSocketList.clear();
-    logDebug3("Tunnel handler thread stopped.\n");
-  }
 
-  void SSHTunnelHandler::handleNewConnection(int incomingSocket) {
-    logDebug3("About to handle new connection.\n");
-    struct sockaddr_in client;
-    socklen_t addrlen = sizeof(client);
-    errno = 0;
-    int clientSock = accept(incomingSocket, (struct sockaddr*) &client, &addrlen);
-    if (clientSock < 0) {
-      if (errno != EWOULDBLOCK || errno == EINTR)
-        logError("accept() failed: %s\n.", getError().c_str());
-      return;
+    // Another user of a shared session may have reconnected it already.
+    _session->reconnect();
+    if (!_session->isConnected()) {
+      logError("Unable to reconnect session.\n");
+      detach();
+      _alive = false;
     }
+  }
+
+  void SSHTunnelHandler::acceptConnections() {
+    _acceptPending = false;
+    std::size_t bufferSize = std::max<std::size_t>(_config.bufferSize, 1024);
+
+    while (true) {
+      struct sockaddr_in client;
+      socklen_t addrlen = sizeof(client);
+      errno = 0;
+      int clientSock = accept(_localSocket, (struct sockaddr*) &client, &addrlen);
+      if (clientSock < 0) {
+        if (!isWouldBlock())
+          logError("accept() failed: %s\n.", getError().c_str());
+        return;
+      }
+
+      setSocketNonBlocking(clientSock);
 
-    setSocketNonBlocking(clientSock);
+      std::unique_ptr<Connection> connection(new Connection(clientSock, bufferSize));
+      connection->channel.reset(new ssh::Channel(*(_session->getSession())));
+      _connections[clientSock] = std::move(connection);
 
-    std::lock_guard<std::recursive_mutex> guard(_newConnMtx);
-    _newConnection.push_back(clientSock);
-    logDebug3("Accepted new connection.\n");
+      ++_stats.connections;
+      ++_stats.activeConnections;
+      logDebug3("Accepted new connection.\n");
+    }
   }
 
-  void SSHTunnelHandler::transferDataFromClient(int sock, ssh::Channel *chan) {
-    ssize_t readlen = 0;
-    std::vector<char> buff(_session->getConfig().bufferSize, '\0');
+  // Opening a forwarding channel is asynchronous in a non blocking session, the call is simply repeated whenever the
+  // session had some traffic, until the server confirmed the channel or the connect timeout passed.
+  bool SSHTunnelHandler::openChannel(Connection &connection) {
+    if (connection.opened)
+      return true;
+
+    int rc = ssh_channel_open_forward(connection.channel->getCChannel(), _config.remotehost.c_str(),
+                                      _config.remoteport, _config.localhost.c_str(), _config.localport);
+    auto now = std::chrono::steady_clock::now();
+    if (rc == SSH_AGAIN) {
+      if (now - connection.openStarted < std::chrono::seconds(_config.connectTimeout))
+        return true;
+      logError("Unable to open tunnel. The channel was not opened within %d seconds.\n", (int)_config.connectTimeout);
+      return false;
+    }
 
-    while (!_stop && (readlen = recv(sock, buff.data(), buff.size(), 0)) > 0) {
-      int bWritten = 0;
-      for (char* buffPtr = buff.data(); readlen > 0 && !_stop; buffPtr += bWritten, readlen -= bWritten) {
-        try {
-          bWritten = chan->write(buffPtr, readlen);
-          if (bWritten <= 0) {
-            throw SSHTunnelException("unable to write, remote end disconnected");
-          }
-        } catch (SshException &exc) {
-          throw SSHTunnelException(exc.getError());
-        }
-      }
+    if (rc != SSH_OK) {
+      logError("Unable to open tunnel. Exception when opening tunnel: %s\n", _session->getSession()->getError());
+      return false;
     }
+
+    double openTime = std::chrono::duration<double, std::milli>(now - connection.openStarted).count();
+    connection.opened = true;
+    ++_stats.channelsOpened;
+    _stats.totalChannelOpenMs += openTime;
+    _stats.maxChannelOpenMs = std::max(_stats.maxChannelOpenMs, openTime);
+    logInfo("Tunnel created on port %d, channel to %s:%d opened in %.1f ms.\n", _localPort,
+            _config.remotehost.c_str(), _config.remoteport, openTime);
+    return true;
   }
 
-  void SSHTunnelHandler::transferDataToClient(int sock, ssh::Channel *chan) {
-    ssize_t readlen = 0;
-    std::vector<char> buff(_session->getConfig().bufferSize, '\0');
+  // Moves as much data as the buffers, the client socket and the channel window allow. A side is only read while the
+  // buffer towards the other side has room, so a slow reader stalls the writer instead of growing memory: libssh stops
+  // extending the channel window while we don't read, and the client's TCP window fills up while we don't recv().
+  // Returns false once the connection is finished.
+  bool SSHTunnelHandler::pump(Connection &connection) {
+    ssh_channel channel = connection.channel->getCChannel();
+    bool progress;
     do {
-      try {
-        readlen = chan->readNonblocking(buff.data(), buff.size());
-      } catch (SshException &exc) {
-        throw SSHTunnelException(exc.getError());
+      progress = false;
+      std::size_t length = 0;
+
+      if (!connection.clientEof && !connection.toServer.full()) {
+        char *data = connection.toServer.writePtr(length);
+        errno = 0;
+        ssize_t readlen = recv(connection.socket, data, length, 0);
+        if (readlen > 0) {
+          connection.toServer.commit(readlen);
+          progress = true;
+        } else if (readlen == 0) {
+          connection.clientEof = true;
+        } else if (!isWouldBlock()) {
+          throw SSHTunnelException("unable to read, client disconnected: " + getError());
+        }
       }
 
-      if (readlen < 0 && readlen != SSH_AGAIN)
-        throw SSHTunnelException("unable to read, remote end disconnected");
+      if (!connection.toServer.empty()) {
+        uint32_t window = ssh_channel_window_size(channel);
+        if (window > 0) {
+          const char *data = connection.toServer.readPtr(length);
+          int written = ssh_channel_write(channel, data, static_cast<uint32_t>(std::min<std::size_t>(length, window)));
+          if (written == SSH_ERROR)
+            throw SSHTunnelException("unable to write, remote end disconnected");
+          if (written > 0) {
+            connection.toServer.consume(written);
+            _stats.bytesToServer += written;
+            progress = true;
+          }
+        }
+      }
 
-      if (readlen == 0) {
-        if (chan->isClosed())
-          throw SSHTunnelException("channel is closed");
-        break;
+      if (!connection.channelEof && !connection.toClient.full()) {
+        char *data = connection.toClient.writePtr(length);
+        int readlen = ssh_channel_read_nonblocking(channel, data, static_cast<uint32_t>(length), 0);
+        if (readlen > 0) {
+          connection.toClient.commit(readlen);
+          progress = true;
+        } else if (readlen == SSH_EOF || (readlen == 0 && (ssh_channel_is_eof(channel) || ssh_channel_is_closed(channel)))) {
+          connection.channelEof = true;
+        } else if (readlen < 0) {
+          throw SSHTunnelException("unable to read, remote end disconnected");
+        }
       }
 
-      ssize_t bWritten = 0;
-      for (char* buffPtr = buff.data(); readlen > 0 && !_stop; buffPtr += bWritten, readlen -= bWritten) {
-        bWritten = send(sock, buffPtr, readlen, MSG_NOSIGNAL);
-        if (bWritten <= 0)
-          throw SSHTunnelException("unable to write, client disconnected");
+      if (!connection.toClient.empty()) {
+        const char *data = connection.toClient.readPtr(length);
+        errno = 0;
+        ssize_t written = send(connection.socket, data, length, MSG_NOSIGNAL);
+        if (written > 0) {
+          connection.toClient.consume(written);
+          _stats.bytesToClient += written;
+          progress = true;
+        } else if (written < 0 && !isWouldBlock()) {
+          throw SSHTunnelException("unable to write, client disconnected: " + getError());
+        }
       }
-    } while (!_stop && true);
-  }
+    } while (progress);
 
-  std::unique_ptr<ssh::Channel> SSHTunnelHandler::openTunnel() {
-    std::unique_ptr<ssh::Channel> channel(new ssh::Channel(*(_session->getSession())));
-    ssh_channel_set_blocking(channel->getCChannel(), false);
+    if (connection.clientEof && connection.toServer.empty() && !connection.eofSent) {
+      ssh_channel_send_eof(channel);
+      connection.eofSent = true;
+    }
 
-    int rc = SSH_ERROR;
-    std::size_t i = 0;
+    // Once the server is done and everything it sent reached the client there's nothing left to forward.
+    return !(connection.channelEof && connection.toClient.empty());
+  }
 
-    while ((_session->getConfig().connectTimeout * 1000 - (i * 100))  > 0) {
-      rc = channel->openForward(_session->getConfig().remotehost.c_str(), _session->getConfig().remoteport,
-                              _session->getConfig().localhost.c_str(), _session->getConfig().localport);
-      if (rc == SSH_AGAIN) {
-        logDebug3("Unable to open channel, wait a moment and retry.\n");
-        i++;
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-      } else {
-        logDebug("Channel successfully opened\n");
-        break;
-      }
+  // The client socket is only watched for what can currently be handled: POLLIN while there's room for more data
+  // towards the server and POLLOUT while data for the client is waiting. The session socket wakes us up for the rest.
+  bool SSHTunnelHandler::updateEvents(Connection &connection) {
+    short events = 0;
+    if (connection.opened) {
+      if (!connection.clientEof && !connection.toServer.full())
+        events |= POLLIN;
+      if (!connection.toClient.empty())
+        events |= POLLOUT;
     }
 
-    // If we're here and it's still not ok, we throw exception as we can't open the channel.
-    if (rc != SSH_OK)
-      throw SSHTunnelException("Unable to open channel");
+    if (events == connection.events)
+      return true;
 
-    return channel;
-  }
+    if (connection.events != 0)
+      ssh_event_remove_fd(_event, connection.socket);
+    connection.events = 0;
 
-  void SSHTunnelHandler::prepareTunnel(int clientSocket) {
-    std::unique_ptr<ssh::Channel> channel;
-    try {
-      channel = openTunnel();
-    } catch (ssh::SSHTunnelException &exc) {
-      wbCloseSocket(clientSocket);
-      logError("Unable to open tunnel. Exception when opening tunnel: %s\n", exc.what());
-      return;
-    } catch (ssh::SshException &exc) {
-      wbCloseSocket(clientSocket);
-      logError("Unable to open tunnel. Exception when opening tunnel: %s\n", exc.getError().c_str());
-      return;
+    if (events != 0) {
+      if (ssh_event_add_fd(_event, connection.socket, events, onClientSocketEvent, this) != SSH_OK) {
+        logError("Unable to open tunnel. Could not register event handler.\n");
+        return false;
+      }
+      connection.events = events;
     }
+    return true;
+  }
 
-    short events = POLLIN;
-    if (ssh_event_add_fd(_event, clientSocket, events, onSocketEvent, this) != SSH_OK) {
-      logError("Unable to open tunnel. Could not register event handler.\n");
-      channel.reset();
-      wbCloseSocket(clientSocket);
-      return;
-    } else {
-      logDebug("Tunnel created.\n");
+  void SSHTunnelHandler::closeConnection(Connection &connection) {
+    if (connection.events != 0)
+      ssh_event_remove_fd(_event, connection.socket);
+    connection.events = 0;
+
+    if (connection.channel) {
+      if (connection.opened)
+        ssh_channel_close(connection.channel->getCChannel());
+      connection.channel.reset();
     }
+    wbCloseSocket(connection.socket);
+    --_stats.activeConnections;
+  }
 
-    _clientSocketList.insert(std::make_pair(clientSocket, std::move(channel)));
-    return;
+  void SSHTunnelHandler::closeConnections() {
+    for (auto &it : _connections)
+      closeConnection(*it.second);
+    _connections.clear();
   }
 
 } /* namespace ssh */
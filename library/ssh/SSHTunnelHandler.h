@@ -28,42 +28,121 @@
 #include <poll.h>
 #endif
 #include <string.h>
-#include <thread>
+#include <chrono>
 #include <map>
-#include <mutex>
 #include <vector>
 #include "SSHCommon.h"
 #include "SSHSession.h"
 
 namespace ssh {
-  class WBSSHLIBRARY_PUBLIC_FUNC SSHTunnelHandler : public SSHThread {
+
+  // Fixed size ring buffer which holds data on its way between a client socket and an SSH channel.
+  // Data is received directly into the free space and sent directly from the stored data, so nothing is copied
+  // or reallocated while a connection is pumped.
+  class WBSSHLIBRARY_PUBLIC_FUNC SSHTunnelBuffer {
+  public:
+    explicit SSHTunnelBuffer(std::size_t capacity);
+
+    std::size_t size() const {
+      return _size;
+    }
+    bool empty() const {
+      return _size == 0;
+    }
+    bool full() const {
+      return _size == _data.size();
+    }
+
+    // Contiguous free space after the stored data. Call commit() with the number of bytes actually written there.
+    char *writePtr(std::size_t &length);
+    void commit(std::size_t length);
+
+    // Contiguous stored data. Call consume() with the number of bytes actually taken from there.
+    const char *readPtr(std::size_t &length) const;
+    void consume(std::size_t length);
+
+  private:
+    std::vector<char> _data;
+    std::size_t _start;
+    std::size_t _size;
+  };
+
+  struct WBSSHLIBRARY_PUBLIC_FUNC SSHTunnelStats {
+    uint64_t bytesToServer = 0;       // Bytes written to the SSH channels.
+    uint64_t bytesToClient = 0;       // Bytes written to the client sockets.
+    std::size_t connections = 0;      // Client connections accepted over the lifetime of the tunnel.
+    std::size_t activeConnections = 0;
+    std::size_t channelsOpened = 0;
+    double totalChannelOpenMs = 0;    // Time spent waiting for the server to open forwarding channels.
+    double maxChannelOpenMs = 0;
+
+    double averageChannelOpenMs() const {
+      return channelsOpened > 0 ? totalChannelOpenMs / channelsOpened : 0;
+    }
+  };
+
+  // Forwards the connections accepted on one local port through an SSH session. The handler has no thread of its own,
+  // it is driven by the event loop of the SSHTunnelManager, which owns the ssh_event all tunnels are registered with.
+  // Apart from the accessors, all the methods must only be called from that event loop.
+  // The session may be shared with other tunnels (see SSHSessionPool), so it is only used while holding its lock and
+  // the manager watches its socket instead of handing it to the event.
+  class WBSSHLIBRARY_PUBLIC_FUNC SSHTunnelHandler {
   public:
-    SSHTunnelHandler(uint16_t localPort, int localSocket, std::shared_ptr<ssh::SSHSession> session);
+    SSHTunnelHandler(uint16_t localPort, int localSocket, std::shared_ptr<ssh::SSHSession> session,
+                     const SSHConnectionConfig &config);
     ~SSHTunnelHandler();
     int getLocalSocket() const;
     int getLocalPort() const;
     SSHConnectionConfig getConfig() const;
+    SSHTunnelStats getStats() const;
+    bool isAlive() const;
+
+    bool isAttached() const;
+    void attach(ssh_event event);
+    void detach();
+
+    socket_t getSessionSocket() const;
+    bool needsPolling() const;
+    void process();
+
+  private:
+    struct Connection {
+      int socket;
+      std::unique_ptr<ssh::Channel> channel;
+      SSHTunnelBuffer toServer;   // Data read from the client, waiting for room in the channel window.
+      SSHTunnelBuffer toClient;   // Data read from the channel, waiting for the client socket to become writable.
+      short events;               // The poll events currently registered for the client socket.
+      bool opened;
+      bool clientEof;
+      bool eofSent;
+      bool channelEof;
+      std::chrono::steady_clock::time_point openStarted;
 
-    void handleConnection();
-    void handleNewConnection(int incomingSocket);
-    void transferDataFromClient(int sock, ssh::Channel *chan);
-    void transferDataToClient(int sock, ssh::Channel *chan);
+      Connection(int sock, std::size_t bufferSize);
+    };
 
-    std::unique_ptr<ssh::Channel> openTunnel();
-    void prepareTunnel(int clientSocket);
+    void acceptConnections();
+    bool openChannel(Connection &connection);
+    bool pump(Connection &connection);
+    bool updateEvents(Connection &connection);
+    void closeConnection(Connection &connection);
+    void closeConnections();
+    void handleSessionError();
 
-  protected:
-    virtual void run() override;
+    static int onListenSocketEvent(socket_t fd, int revents, void *userdata);
+    static int onClientSocketEvent(socket_t fd, int revents, void *userdata);
 
     std::shared_ptr<SSHSession> _session;
+    SSHConnectionConfig _config;
     uint16_t _localPort;
     int _localSocket;
-    std::map<int, std::unique_ptr<ssh::Channel>> _clientSocketList;
-    int _pollTimeout;
     ssh_event _event;
-    std::vector<int> _sockRemovalList;
-    std::recursive_mutex _newConnMtx;
-    std::vector<int> _newConnection;
+    bool _acceptPending;
+    bool _alive;
+    bool _sessionBusy;
+    std::size_t _seenLockCount; // The session's lockCount() when we last processed it.
+    std::map<int, std::unique_ptr<Connection>> _connections;
+    SSHTunnelStats _stats;
   };
 
 } /* namespace ssh */
@@ -40,7 +40,7 @@ DEFAULT_LOG_DOMAIN("SSHTunnelManager")
 namespace ssh {
 
   SSHTunnelManager::SSHTunnelManager()
-      : _wakeupSocketPort(0), _wakeupSocket(-1) {
+      : _wakeupSocketPort(0), _wakeupSocket(-1), _event(nullptr) {
 #if _MSC_VER
     WSADATA wsaData;
     int iResult = WSAStartup(MAKEWORD(2, 2), &wsaData);
@@ -67,7 +67,6 @@ namespace ssh {
     stop();  // wait for thread to finish
     auto sockLock = lockSocketList();
     for (auto &it : _socketList) {
-      it.second->stop();
       it.second.release();
     }
 #if _MSC_VER
@@ -125,10 +124,17 @@ namespace ssh {
   }
 
   std::tuple<SSHReturnType, base::any> SSHTunnelManager::createTunnel(std::shared_ptr<SSHSession> &session) {
+    return createTunnel(session, session->getConfig());
+  }
+
+  // The config describes the tunnel, which can differ from the one the session was connected with if the session
+  // is shared.
+  std::tuple<SSHReturnType, base::any> SSHTunnelManager::createTunnel(std::shared_ptr<SSHSession> &session,
+                                                                      const SSHConnectionConfig &config) {
     logDebug3("About to create ssh tunnel.\n");
     auto sockLock = lockSocketList();
     for (auto &it : _socketList) {
-      if (it.second->getConfig() == session->getConfig()) {
+      if (it.second->getConfig() == config) {
         logDebug3("Found existing ssh tunnel.\n");
         return std::make_tuple(SSHReturnType::CONNECTED, it.second->getLocalPort());
       }
@@ -136,8 +142,7 @@ namespace ssh {
 
     auto ret = createSocket();
     logDebug2("Tunnel port created on socket: %d\n", ret.port);
-    std::unique_ptr<SSHTunnelHandler> handler(new SSHTunnelHandler(ret.port, ret.socketHandle, session));
-    handler->start();
+    std::unique_ptr<SSHTunnelHandler> handler(new SSHTunnelHandler(ret.port, ret.socketHandle, session, config));
     _socketList.insert(std::make_pair(ret.socketHandle, std::move(handler)));
     pokeWakeupSocket();  // If we're connected, we should notify manager that it shoud reload connection list.
     return std::make_tuple(SSHReturnType::CONNECTED, ret.port);
@@ -148,7 +153,7 @@ namespace ssh {
 
     for (auto &it : _socketList) {
       if (it.second->getConfig() == config) {
-        if (!it.second->isRunning()) {
+        if (!it.second->isAlive()) {
           disconnect(config);
           logWarning("Dead tunnel found, clearing it up.\n");
           return 0;
@@ -160,107 +165,118 @@ namespace ssh {
     return 0;
   }
 
+  SSHTunnelStats SSHTunnelManager::getTunnelStats(const SSHConnectionConfig &config) {
+    auto sockLock = lockSocketList();
+
+    for (auto &it : _socketList) {
+      if (it.second->getConfig() == config)
+        return it.second->getStats();
+    }
+
+    return SSHTunnelStats();
+  }
+
   // We need to handle wakeupsocket connection, this should be enough.
   static void acceptAndClose(int socket) {
     struct sockaddr_in client;
     socklen_t addrlen = sizeof(client);
     errno = 0;
     int clientSock = accept(socket, (struct sockaddr*) &client, &addrlen);
-    wbCloseSocket(clientSock);
+    if (clientSock >= 0)
+      wbCloseSocket(clientSock);
   }
 
-  std::vector<pollfd> SSHTunnelManager::getSocketList() {
-    std::vector<pollfd> socketList;
-    {
-      auto sockLock = lockSocketList();
-      for (auto &it : _socketList) {
-        pollfd p;
-        p.fd = it.second->getLocalSocket();
-        p.events = POLLIN;
-        socketList.push_back(p);
-      }
+  int SSHTunnelManager::onWakeupEvent(socket_t fd, int revents, void *userdata) {
+    logDebug2("Wakeup socket got connection, reloading tunnel list.\n");
+    acceptAndClose(fd);
+    return 0;
+  }
+
+  int SSHTunnelManager::onSessionEvent(socket_t fd, int revents, void *userdata) {
+    return 0;
+  }
+
+  void SSHTunnelManager::attachTunnels() {
+    auto sockLock = lockSocketList();
+    _closedHandlers.clear();
+    for (auto &it : _socketList) {
+      if (it.second->isAlive() && !it.second->isAttached())
+        it.second->attach(_event);
     }
+    updateSessionSockets();
+  }
 
-    {
-      pollfd p;
-      p.fd = _wakeupSocket;
-      p.events = POLLIN;
-      socketList.push_back(p);
+  // Brings the watched session sockets in line with the tunnels. This must run right after anything that can close
+  // a session socket, before its number can be reused for a client connection.
+  void SSHTunnelManager::updateSessionSockets() {
+    std::set<socket_t> sockets;
+    for (auto &it : _socketList) {
+      socket_t fd = it.second->getSessionSocket();
+      if (fd != SSH_INVALID_SOCKET)
+        sockets.insert(fd);
     }
-    return socketList;
+
+    for (auto fd : _sessionSockets) {
+      if (sockets.count(fd) == 0)
+        ssh_event_remove_fd(_event, fd);
+    }
+
+    for (auto fd : sockets) {
+      if (_sessionSockets.count(fd) == 0 && ssh_event_add_fd(_event, fd, POLLIN, onSessionEvent, this) != SSH_OK)
+        logError("Unable to watch SSH session socket.\n");
+    }
+    _sessionSockets.swap(sockets);
   }
 
   void SSHTunnelManager::localSocketHandler() {
-    auto socketList = getSocketList();
-    int rc = 0;
-    do {
-      auto pollSocketList = socketList;  // We need to duplicate this as we will be changing it later, so we could loose other socket data.
-      rc = wbPoll(pollSocketList.data(), pollSocketList.size());
-      if (rc < 0) {
-        logError("poll() error: %s.\n", getError().c_str());
-        break;
+    {
+      auto sockLock = lockSocketList();
+      _event = ssh_event_new();
+      if (_event == nullptr || ssh_event_add_fd(_event, _wakeupSocket, POLLIN, onWakeupEvent, this) != SSH_OK) {
+        logError("Unable to create the tunnel event loop.\n");
+        if (_event != nullptr)
+          ssh_event_free(_event);
+        _event = nullptr;
+        return;
       }
+    }
 
-      if (rc == 0) {
-        logError("poll() timeout.\n");
-        break;
-      }
+    int timeout = 1000;
+    while (!_stop) {
+      attachTunnels();
 
-      for (auto &pollIt : pollSocketList) {
-        if (pollIt.revents == 0)
-          continue;
-        if (pollIt.revents == POLLERR) {
-          logError("Error revents: %d.\n", pollIt.revents);
-          _stop = true;
-          break;
-        }
+      // Any ready socket ends the poll right away, the timeout only limits how late channel open timeouts and stop
+      // requests are noticed, unless a tunnel needs to be looked at regularly.
+      ssh_event_dopoll(_event, timeout);
+      if (_stop)
+        break;
 
-        if (pollIt.fd == _wakeupSocket)  // This is special case we reload fds and continue.
-            {
-          logDebug2("Wakeup socket got connection, reloading socketList.\n");
-          socketList.clear();
-          acceptAndClose(pollIt.fd);
-          if (_stop)
-            break;
-
-          socketList = getSocketList();
-          continue;
-        } else { // This is a new connection, we need to handle it.
-          auto sockLock = lockSocketList();
-          auto it = _socketList.find(pollIt.fd);
-          if (it != _socketList.end()) {
-            it->second->handleNewConnection(pollIt.fd);
-          } else {
-            // Let's check if this is something that wasn't removed from the sock list, then just close it.
-            bool found = false;
-            for (auto s : pollSocketList) {
-              if (s.fd == pollIt.fd && s.fd != _wakeupSocket) {
-                shutdown(pollIt.fd, SHUT_RDWR);
-                found = true;
-                break;
-              }
-            }
-
-            if (found) { // We have to reload the socket list here.
-              socketList = getSocketList();
-            }
-
-            if (!found) {
-              logError("Something went wrong, incoming socket connection wasn't found in the socketList, abort.\n");
-              _stop = true;
-              break;
-            }
-          }
-        }
+      auto sockLock = lockSocketList();
+      timeout = 1000;
+      for (auto &it : _socketList) {
+        it.second->process();
+        updateSessionSockets();
+        if (it.second->needsPolling())
+          timeout = 50;
       }
-    } while (!_stop);
+    }
 
     auto sockLock = lockSocketList();
+    _closedHandlers.clear();
     for (auto &sIt : _socketList) {
+      sIt.second->detach();
       sIt.second.release();
       shutdown(sIt.first, SHUT_RDWR);
     }
 
+    for (auto fd : _sessionSockets)
+      ssh_event_remove_fd(_event, fd);
+    _sessionSockets.clear();
+
+    ssh_event_remove_fd(_event, _wakeupSocket);
+    ssh_event_free(_event);
+    _event = nullptr;
+
     // This means wakeup socket is also cleared.
     _wakeupSocket = 0;
     _socketList.clear();
@@ -296,16 +312,19 @@ namespace ssh {
     }
 
     shutdown(sock, SHUT_RDWR);
+    wbCloseSocket(sock);
   }
 
   void SSHTunnelManager::disconnect(const SSHConnectionConfig &config) {
     auto sockLock = lockSocketList();
     for (auto &it : _socketList) {
       if (it.second->getConfig() == config) {
-        // Here we need to perform disconnect
-        it.second->stop();
-        it.second.release();
+        // Here we need to perform disconnect. A handler registered with the event loop must leave it on that thread.
         shutdown(it.first, SHUT_RDWR);
+        if (_event != nullptr) {
+          _closedHandlers.push_back(std::move(it.second));
+          pokeWakeupSocket();
+        }
         _socketList.erase(it.first);
         logDebug2("Shutdown port: %d\n", config.localport);
         break;
@@ -28,6 +28,7 @@
 #include <atomic>
 #include <deque>
 #include <map>
+#include <set>
 #include "SSHCommon.h"
 #include "SSHSession.h"
 #include "SSHTunnelHandler.h"
@@ -39,11 +40,16 @@ namespace ssh {
     int socketHandle;
   } sockInfo;
 
+  // Owns the local listening sockets of all tunnels and runs the single event loop which serves them. The loop sleeps
+  // in ssh_event_dopoll() until a listening socket, a client socket or one of the SSH sessions becomes ready.
   class WBSSHLIBRARY_PUBLIC_FUNC SSHTunnelManager : public SSHThread {
   public:
     SSHTunnelManager();
     std::tuple<SSHReturnType, base::any> createTunnel(std::shared_ptr<SSHSession> &session);
+    std::tuple<SSHReturnType, base::any> createTunnel(std::shared_ptr<SSHSession> &session,
+                                                      const SSHConnectionConfig &config);
     int lookupTunnel(const SSHConnectionConfig &config);
+    SSHTunnelStats getTunnelStats(const SSHConnectionConfig &config);
     virtual ~SSHTunnelManager();
     void pokeWakeupSocket();
     void setStop() {
@@ -58,11 +64,17 @@ namespace ssh {
     virtual void run() override;
     sockInfo createSocket();
     void localSocketHandler();
-    std::vector<pollfd> getSocketList();
+    void attachTunnels();
+    void updateSessionSockets();
+    static int onWakeupEvent(socket_t fd, int revents, void *userdata);
+    static int onSessionEvent(socket_t fd, int revents, void *userdata);
 
     uint16_t _wakeupSocketPort;
     int _wakeupSocket;
+    ssh_event _event;
     std::map<int, std::unique_ptr<SSHTunnelHandler>> _socketList;
+    std::vector<std::unique_ptr<SSHTunnelHandler>> _closedHandlers;  // Destroyed by the event loop, which owns _event.
+    std::set<socket_t> _sessionSockets;  // Session sockets registered with _event, tunnels may share a session.
 
   };
 
@@ -29,16 +29,15 @@
 #include "base/string_utilities.h"
 #include "base/wb_iterators.h"
 #include "base/file_utilities.h"
+#include "base/log.h"
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-#ifndef M_PI_2
-#define M_PI_2 1.57079632679489661923
-#endif
+#include <chrono>
+#include <thread>
 
-#define PI_38 M_PI * 0.375
-#define PI_58 M_PI * 0.625
+// Time in seconds after which autolayout stops refining the layout of a diagram (all layers together).
+#define AUTOLAYOUT_TIME_BUDGET 20.0
+
+DEFAULT_LOG_DOMAIN("Model")
 
 using namespace grt;
 using namespace std; // In VS min/max are not in the std namespace, so we have to split that.
@@ -254,9 +253,18 @@ int WbModelImpl::autolayout(model_DiagramRef view) {
 
   begin_undo_group();
 
-  do_autolayout(view->rootLayer(), selection);
+  // The time budget is for the whole diagram. Every layer gets an equal share of what is left, so time not used
+  // by one layer goes to the following ones.
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::size_t remaining_layers = layers.count() + 1;
+  auto layer_budget = [&]() {
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return std::max(AUTOLAYOUT_TIME_BUDGET - elapsed, 0.0) / remaining_layers--;
+  };
+
+  do_autolayout(view->rootLayer(), selection, layer_budget());
   for (std::size_t i = 0, layerCount = layers.count(); i != layerCount; ++i) {
-    result = do_autolayout(layers.get(i), selection);
+    result = do_autolayout(layers.get(i), selection, layer_budget());
     if (0 != result)
       break;
   }
@@ -270,410 +278,401 @@ int WbModelImpl::autolayout(model_DiagramRef view) {
 }
 
 //==============================================================================
-//
+// Force directed layout of the figures in a layer. Figures push each other away when they come closer than the
+// desired distance and connected figures pull each other together. Figures can only be that close when they are in
+// neighbouring cells of a uniform grid, so every step is linear in the number of figures. Forces are evaluated on
+// several threads for larger diagrams.
 //==============================================================================
 class Layouter {
 public:
-  Layouter(const model_LayerRef &layer);
+  Layouter(const model_LayerRef &layer, grt::UndoManager *undo_manager);
 
   void add_figure_to_layout(const model_FigureRef &figure);
   void connect(const model_FigureRef &f1, const model_FigureRef &f2);
 
-  int do_layout();
+  int do_layout(double time_budget);
 
 private:
-  struct Node;
+  struct Node {
+    Node(const model_FigureRef &figure);
 
-  static bool compare_node_links(const Node &n1, const Node &n2);
+    double hw; // Half of the width and height.
+    double hh;
+    double x; // Center of the figure.
+    double y;
+    double dx; // Displacement computed in the current step.
+    double dy;
+    double left; // Original position.
+    double top;
+    model_FigureRef fig;
+    std::vector<std::size_t> linked;
+  };
 
-  bool shuffle();
-  double calc_energy();
-  double calc_node_energy(const std::size_t i, const Node &n);
-  long distance_to_node(const std::size_t n1, const std::size_t n2, bool *is_horiz = NULL);
-  double calc_node_pair(const std::size_t i1, const std::size_t i2);
-  void prepare_layout_stages();
+  void prepare_layout();
+  void build_grid();
+  void calc_displacements(std::size_t first, std::size_t last, double temperature, bool overlaps_only);
+  double apply_displacements();
+  bool has_displacements();
+  void update_figures(bool final);
 
   const double _w;
   const double _h;
+  const double _min_dist; // Desired distance between figures.
+  double _cell_size;
+  double _center_x;
+  double _center_y;
 
-  struct Node {
-    Node(const model_FigureRef &figure);
-    void move_by(const long dx, const long dy);
-    void move(const long x, const long y);
-    bool is_linked_to(const ssize_t node) const;
-
-    long w;
-    long h;
-    long x1;
-    long y1;
-    long x2;
-    long y2;
-    model_FigureRef fig;
-    std::vector<ssize_t> linked;
-  };
-  typedef std::vector<Node> NodesList;
-  NodesList _all_figures;
-  NodesList _figures;
-  long _min_dist; // desired dist between nodes
-  double _min_energy;
-  int _cell_w;
-  int _cell_h;
-  model_LayerRef _layer;
+  std::set<std::string> _layer_figures;
+  std::map<std::string, std::size_t> _node_index;
+  std::vector<Node> _nodes;
+
+  int _grid_columns;
+  int _grid_rows;
+  std::vector<std::vector<std::size_t> > _grid;
+
+  grt::UndoManager *_undo_manager;
 };
 
 //------------------------------------------------------------------------------
 Layouter::Node::Node(const model_FigureRef &figure)
-  : w((long)figure->width()),
-    h((long)figure->height()),
-    x1((long)figure->left()),
-    y1((long)figure->top()),
-    x2(x1 + w),
-    y2(y1 + h),
+  : hw(*figure->width() / 2),
+    hh(*figure->height() / 2),
+    x(*figure->left() + hw),
+    y(*figure->top() + hh),
+    dx(0),
+    dy(0),
+    left(*figure->left()),
+    top(*figure->top()),
     fig(figure) {
 }
 
 //------------------------------------------------------------------------------
-void Layouter::Node::move(const long x, const long y) {
-  x1 = x;
-  y1 = y;
-  x2 = x1 + w;
-  y2 = y1 + h;
-}
-
-//------------------------------------------------------------------------------
-void Layouter::Node::move_by(const long dx, const long dy) {
-  x1 += dx;
-  y1 += dy;
-  x2 += dx;
-  y2 += dy;
-}
-
-//------------------------------------------------------------------------------
-bool Layouter::Node::is_linked_to(const ssize_t node) const {
-  bool found = false;
-
-  for (ssize_t i = linked.size() - 1; i >= 0; --i) {
-    if (linked[i] == node) {
-      found = true;
-      break;
-    }
-  }
-
-  return found;
-}
-
-//------------------------------------------------------------------------------
-Layouter::Layouter(const model_LayerRef &layer)
-  : _w(layer->width()), _h(layer->height()), _min_dist(80), _min_energy(0), _cell_w(0), _cell_h(0), _layer(layer) {
+Layouter::Layouter(const model_LayerRef &layer, grt::UndoManager *undo_manager)
+  : _w(layer->width()),
+    _h(layer->height()),
+    _min_dist(80),
+    _cell_size(0),
+    _center_x(0),
+    _center_y(0),
+    _grid_columns(0),
+    _grid_rows(0),
+    _undo_manager(undo_manager) {
   const ListRef<model_Figure> figures = layer->figures();
 
   for (std::size_t i = 0; i < figures->count(); ++i)
-    _all_figures.push_back(figures[i]);
+    _layer_figures.insert(figures[i]->id());
 }
 
 //------------------------------------------------------------------------------
 void Layouter::add_figure_to_layout(const model_FigureRef &figure) {
-  for (std::size_t i = 0; i < _all_figures.size(); ++i) {
-    if (_all_figures[i].fig == figure) {
-      _figures.push_back(figure);
-    }
+  if (_layer_figures.find(figure->id()) != _layer_figures.end() &&
+      _node_index.find(figure->id()) == _node_index.end()) {
+    _node_index[figure->id()] = _nodes.size();
+    _nodes.push_back(Node(figure));
   }
 }
 
 //------------------------------------------------------------------------------
 void Layouter::connect(const model_FigureRef &f1, const model_FigureRef &f2) {
-  ssize_t n1 = -1;
-  ssize_t n2 = -1;
-
-  for (std::size_t i = 0; i < _figures.size(); ++i) {
-    Node &n = _figures[i];
-    if (n1 == -1 && n.fig == f1)
-      n1 = i;
-    if (n2 == -1 && n.fig == f2)
-      n2 = i;
-    if (n1 >= 0 && n2 >= 0)
-      break;
-  }
+  if (!f1.is_valid() || !f2.is_valid())
+    return;
 
-  if (n1 >= 0 && n2 >= 0) {
-    Node &node1 = _figures[n1];
-    Node &node2 = _figures[n2];
-    node1.linked.push_back(n2);
-    node2.linked.push_back(n1);
+  std::map<std::string, std::size_t>::const_iterator n1 = _node_index.find(f1->id());
+  std::map<std::string, std::size_t>::const_iterator n2 = _node_index.find(f2->id());
+  if (n1 != _node_index.end() && n2 != _node_index.end() && n1->second != n2->second) {
+    _nodes[n1->second].linked.push_back(n2->second);
+    _nodes[n2->second].linked.push_back(n1->second);
   }
 }
 
 //------------------------------------------------------------------------------
-long Layouter::distance_to_node(const std::size_t i1, const std::size_t i2, bool *is_horiz) {
-  const Node &n1 = _figures[i1];
-  const Node &n2 = _figures[i2];
-  const long x11 = n1.x1;
-  const long y11 = n1.y1;
-  const long x12 = n1.x2;
-  const long y12 = n1.y2;
-
-  const long x21 = n2.x1;
-  const long y21 = n2.y1;
-  const long x22 = n2.x2;
-  const long y22 = n2.y2;
-
-  const long cx1 = x11 + (x12 - x11) / 2;
-  const long cy1 = y11 + (y12 - y11) / 2;
-  const long cx2 = x21 + (x22 - x21) / 2;
-  const long cy2 = y21 + (y22 - y21) / 2;
-  const long dcx = cx2 - cx1;
-  const double qr = atan2((double)dcx, (double)(cy2 - cy1));
-
-  double dx = 0;
-  double dy = 0;
-  double l1 = 0;
-  double l2 = 0;
-  if (qr > M_PI_2) {
-    dy = y11 - y22;
-    dx = x21 - x12;
-    l1 = dy ? ::fabs(dy / cos(qr)) : ::fabs(dx);
-    l2 = dx ? ::fabs(dx / sin(qr)) : ::fabs(dy);
-  } else if (0.0 < qr && qr <= M_PI_2) {
-    dy = y21 - y12;
-    dx = x21 - x12;
-    if (dy > dx)
-      l1 = l2 = dy ? ::fabs(dy / cos(qr)) : ::fabs(dx);
-    else
-      l1 = l2 = dx ? ::fabs(dx / sin(qr)) : ::fabs(dy);
-  } else if (qr < -M_PI_2) {
-    dy = y11 - y22;
-    dx = -(x22 - x11);
-    if (dy > dx)
-      l1 = l2 = dy ? ::fabs(dy / cos(qr)) : ::fabs(dx);
-    else
-      l1 = l2 = dx ? ::fabs(dx / sin(qr)) : ::fabs(dy);
-  } else {
-    dy = y21 - y12;
-    if (abs(dcx) > (x12 - x11) / 2)
-      dx = x11 - x22;
-    else
-      dx = dcx;
-    if (dy > dx)
-      l1 = l2 = dy ? ::fabs(dy / cos(qr)) : ::fabs(dx);
-    else
-      l1 = l2 = (dx && qr != 0.0) ? ::fabs(dx / sin(qr)) : ::fabs(dy);
+// Places all figures on a grid, starting with the most connected one and keeping connected figures close together.
+// The grid has the aspect ratio of the layer and is only made denser than the desired distance if the figures
+// wouldn't fit into the layer otherwise.
+void Layouter::prepare_layout() {
+  double max_size = 0;
+  for (std::size_t i = 0; i < _nodes.size(); ++i)
+    max_size = std::max(max_size, 2 * std::max(_nodes[i].hw, _nodes[i].hh));
+  _cell_size = max_size + _min_dist;
+
+  std::vector<std::size_t> order(_nodes.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [this](std::size_t n1, std::size_t n2) {
+    return _nodes[n1].linked.size() > _nodes[n2].linked.size();
+  });
+
+  std::vector<bool> placed(_nodes.size(), false);
+  std::vector<std::size_t> queue;
+  queue.reserve(_nodes.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    if (placed[order[i]])
+      continue;
+    placed[order[i]] = true;
+    queue.push_back(order[i]);
+    for (std::size_t next = queue.size() - 1; next < queue.size(); ++next) {
+      const Node &node = _nodes[queue[next]];
+      for (std::size_t j = 0; j < node.linked.size(); ++j) {
+        if (!placed[node.linked[j]]) {
+          placed[node.linked[j]] = true;
+          queue.push_back(node.linked[j]);
+        }
+      }
+    }
   }
 
-  // printf("qr %f (cos(qr) = %f, sin(rq) = %f), l1 %li, l2 %li, dy %li, dx %li\n", qr, cos(qr), sin(qr), l1, l2, dy,
-  // dx);
-
-  const double aqr = ::fabs(qr);
-  if (is_horiz)
-    *is_horiz = PI_38 < aqr && aqr < PI_58;
-  return l1 < l2 ? (long)l1 : (long)l2;
+  // The usable area is the one apply_displacements() keeps the figures in.
+  const double width = std::max(_w - 20, 1.0);
+  const double height = std::max(_h - 20, 1.0);
+  const std::size_t columns = std::min(
+    _nodes.size(), std::max((std::size_t)1, (std::size_t)ceil(sqrt(_nodes.size() * width / height))));
+  const std::size_t rows = (_nodes.size() + columns - 1) / columns;
+  const double step_x = std::min(_cell_size, width / columns);
+  const double step_y = std::min(_cell_size, height / rows);
+  for (std::size_t i = 0; i < queue.size(); ++i) {
+    Node &node = _nodes[queue[i]];
+    node.x = (i % columns + 0.5) * step_x;
+    node.y = (i / columns + 0.5) * step_y;
+  }
 }
 
 //------------------------------------------------------------------------------
-inline double line_len2(long x1, long y1, long x2, long y2) {
-  return sqrt(pow((double)(x2 - x1), 2) + pow((double)(y2 - y1), 2));
+void Layouter::build_grid() {
+  _grid_columns = std::max(1, (int)ceil(_w / _cell_size));
+  _grid_rows = std::max(1, (int)ceil(_h / _cell_size));
+  _grid.assign(_grid_columns * _grid_rows, std::vector<std::size_t>());
+
+  _center_x = 0;
+  _center_y = 0;
+  for (std::size_t i = 0; i < _nodes.size(); ++i) {
+    const Node &node = _nodes[i];
+    int column = std::min(std::max((int)(node.x / _cell_size), 0), _grid_columns - 1);
+    int row = std::min(std::max((int)(node.y / _cell_size), 0), _grid_rows - 1);
+    _grid[row * _grid_columns + column].push_back(i);
+
+    _center_x += node.x;
+    _center_y += node.y;
+  }
+  if (!_nodes.empty()) {
+    _center_x /= _nodes.size();
+    _center_y /= _nodes.size();
+  }
 }
 
 //------------------------------------------------------------------------------
-double Layouter::calc_node_pair(const std::size_t i1, const std::size_t i2) {
-  const Node *n1 = &(_figures[i1]);
-  const Node *n2 = &(_figures[i2]);
-  const bool is_linked = n1->is_linked_to(i2) || n2->is_linked_to(i1);
-
-  long S1 = n1->w * n1->h;
-  long S2 = n2->w * n2->h;
-  if (S1 > S2) {
-    std::swap(n1, n2);
-    std::swap(S1, S2);
-  }
-
-  const long x11 = n1->x1;
-  const long y11 = n1->y1;
-  const long x12 = n1->x2;
-  const long y12 = n1->y2;
-
-  const long x21 = n2->x1;
-  const long y21 = n2->y1;
-  const long x22 = n2->x2;
-  const long y22 = n2->y2;
-
-  const long cx1 = x11 + (x12 - x11) / 2;
-  const long cy1 = y11 + (y12 - y11) / 2;
-  const long cx2 = x21 + (x22 - x21) / 2;
-  const long cy2 = y21 + (y22 - y21) / 2;
-
-  // Detect if nodes overlap
-  const bool is_overlap = ((x12 >= x21) && (x22 >= x11) && (y12 >= y21) && (y22 >= y11));
-
-  static const double overlap_quot = 1000.0;
-
-  double e = 0.0;
-  double distance = 0;
-  if (is_overlap) {
-    distance = line_len2(cx1, cy1, cx2, cy2);
-
-    // calc area of overlap
-    const long sx1 = x11 > x21 ? x11 : x21;
-    const long sy1 = y11 > y21 ? y11 : y21;
-    const long sx2 = x12 < x22 ? x12 : x22;
-    const long sy2 = y12 < y22 ? y12 : y22;
-    const long dsx = sx2 - sx1;
-    const long dsy = sy2 - sy1;
-
-    const long Sov = dsx * dsy;
-
-    if (distance == 0.0)
-      distance = 0.0000001;
+// Computes the displacement of the nodes in [first, last) from the current positions, which are not modified here.
+void Layouter::calc_displacements(std::size_t first, std::size_t last, double temperature, bool overlaps_only) {
+  for (std::size_t i = first; i < last; ++i) {
+    Node &node = _nodes[i];
+    double fx = 0;
+    double fy = 0;
+    bool has_neighbours = false;
+
+    // Repulsion from all figures closer than the desired distance. These can only be in the surrounding cells.
+    int column = std::min(std::max((int)(node.x / _cell_size), 0), _grid_columns - 1);
+    int row = std::min(std::max((int)(node.y / _cell_size), 0), _grid_rows - 1);
+    for (int r = std::max(row - 1, 0); r <= std::min(row + 1, _grid_rows - 1); ++r) {
+      for (int c = std::max(column - 1, 0); c <= std::min(column + 1, _grid_columns - 1); ++c) {
+        const std::vector<std::size_t> &cell = _grid[r * _grid_columns + c];
+        for (std::size_t k = 0; k < cell.size(); ++k) {
+          std::size_t j = cell[k];
+          if (j == i)
+            continue;
+
+          const Node &other = _nodes[j];
+          double dx = node.x - other.x;
+          double dy = node.y - other.y;
+          const double gap_x = ::fabs(dx) - (node.hw + other.hw);
+          const double gap_y = ::fabs(dy) - (node.hh + other.hh);
+          const double gap = std::max(gap_x, gap_y);
+          if (gap >= _min_dist || (overlaps_only && gap >= 0))
+            continue;
+
+          has_neighbours = true;
+          if (dx == 0 && dy == 0)
+            dx = i < j ? -1 : 1;
+
+          if (gap < 0) {
+            // Overlapping figures are moved apart along the axis where that takes the least distance.
+            const double distance = overlaps_only ? (1 - gap) / 2 : _min_dist - gap;
+            if (gap_x > gap_y)
+              fx += (dx < 0 ? -1 : 1) * distance;
+            else
+              fy += (dy < 0 ? -1 : 1) * distance;
+          } else {
+            const double length = sqrt(dx * dx + dy * dy);
+            fx += dx / length * (_min_dist - gap) / 2;
+            fy += dy / length * (_min_dist - gap) / 2;
+          }
+        }
+      }
+    }
 
-    e = _min_dist * 1 / distance * 100 + Sov;
-    e *= overlap_quot;
-  } else {
-    bool is_horiz = false;
-    distance = distance_to_node(i1, i2, &is_horiz);
-
-    if (distance <= _min_dist) {
-      if (distance != 0) {
-        if (is_linked)
-          e += _min_dist + overlap_quot * 1 / distance;
-        else
-          e += _min_dist + overlap_quot * _min_dist / distance;
-      } else {
-        e += overlap_quot;
+    if (!overlaps_only) {
+      // Attraction between connected figures which are farther apart than the desired distance. The sum is limited,
+      // so that figures with many connections don't get pulled onto their neighbours.
+      double ax = 0;
+      double ay = 0;
+      for (std::size_t k = 0; k < node.linked.size(); ++k) {
+        const Node &other = _nodes[node.linked[k]];
+        const double dx = other.x - node.x;
+        const double dy = other.y - node.y;
+        const double gap = std::max(::fabs(dx) - (node.hw + other.hw), ::fabs(dy) - (node.hh + other.hh));
+        if (gap > _min_dist) {
+          const double length = sqrt(dx * dx + dy * dy);
+          ax += dx / length * (gap - _min_dist) / 4;
+          ay += dy / length * (gap - _min_dist) / 4;
+        }
+      }
+      const double pull = sqrt(ax * ax + ay * ay);
+      if (pull > _min_dist / 4) {
+        ax = ax / pull * _min_dist / 4;
+        ay = ay / pull * _min_dist / 4;
+      }
+      fx += ax;
+      fy += ay;
+
+      // Figures without anything close by drift towards the center, so that the diagram stays compact.
+      // Figures which already touch others are left alone, otherwise the pressure would push them into each other.
+      if (!has_neighbours) {
+        const double dx = _center_x - node.x;
+        const double dy = _center_y - node.y;
+        const double length = sqrt(dx * dx + dy * dy);
+        if (length > _cell_size) {
+          fx += dx / length * _min_dist / 4;
+          fy += dy / length * _min_dist / 4;
+        }
       }
-    } else {
-      e += distance;
-      if (is_linked)
-        e += distance * distance;
     }
-  }
 
-  return e;
+    const double length = sqrt(fx * fx + fy * fy);
+    if (length > temperature) {
+      fx = fx / length * temperature;
+      fy = fy / length * temperature;
+    }
+    node.dx = fx;
+    node.dy = fy;
+  }
 }
 
 //------------------------------------------------------------------------------
-double Layouter::calc_energy() {
-  double e = 0.0;
-
-  std::size_t size = _figures.size();
-  for (std::size_t i = 0; i < size; ++i) {
-    const Node &node = _figures[i];
-    if ((node.x1 < 0) || (node.y1 < 0) || (node.x2 + 20 > _w) || (node.y2 + 20 > _h))
-      e += 1000000000000.0;
-
-    for (std::size_t j = i + 1; j < size; ++j) {
-      if (j >= size)
-        break;
-      e += calc_node_pair(i, j);
-    }
+// Moves all nodes by their displacement, keeping them inside the layer. Returns the largest distance moved.
+double Layouter::apply_displacements() {
+  double max_move = 0;
+  for (std::size_t i = 0; i < _nodes.size(); ++i) {
+    Node &node = _nodes[i];
+    const double x = std::max(node.hw, std::min(node.x + node.dx, _w - 20 - node.hw));
+    const double y = std::max(node.hh, std::min(node.y + node.dy, _h - 20 - node.hh));
+    max_move = std::max(max_move, std::max(::fabs(x - node.x), ::fabs(y - node.y)));
+    node.x = x;
+    node.y = y;
   }
-
-  return e;
+  return max_move;
 }
 
 //------------------------------------------------------------------------------
-double Layouter::calc_node_energy(const std::size_t node_i, const Node &node) {
-  double e = 0.0;
-
-  if ((node.x1 < 0) || (node.y1 < 0) || (node.x2 + 20 > _w) || (node.y2 + 20 > _h))
-    e += 1000000000000.0;
-
-  for (std::size_t i = 0; i < _figures.size(); ++i) {
-    if (node_i != i)
-      e += calc_node_pair(node_i, i);
+bool Layouter::has_displacements() {
+  for (std::size_t i = 0; i < _nodes.size(); ++i) {
+    if (_nodes[i].dx != 0 || _nodes[i].dy != 0)
+      return true;
   }
-
-  return e;
+  return false;
 }
 
 //------------------------------------------------------------------------------
-bool Layouter::shuffle() {
-  bool found_smaller_energy = false;
-  const int step = (rand() % 5) + 1;
-
-  for (std::size_t i = 0; i < _figures.size(); ++i) {
-    Node &n = _figures[i];
-    const int wstep = _cell_w * step;
-    const int hstep = _cell_w * step;
-    double node_energy = calc_node_energy(i, n);
-
-    const int wsteps[] = {wstep, -wstep, 0, 0};
-    const int hsteps[] = {0, 0, hstep, -hstep};
-    for (int ns = sizeof(wsteps) / sizeof(int) - 1; ns >= 0; --ns) {
-      n.move_by(wsteps[ns], hsteps[ns]);
-      const double energy = calc_node_energy(i, n);
-      if (energy < node_energy) {
-        node_energy = energy;
-        found_smaller_energy = true;
-      } else
-        n.move_by(-wsteps[ns], -hsteps[ns]);
+// Writes the current positions to the figures. Intermediate positions are not recorded for undo, the final ones are
+// recorded as a change from the original positions.
+void Layouter::update_figures(bool final) {
+  if (_undo_manager)
+    _undo_manager->disable();
+  if (final) {
+    for (std::size_t i = 0; i < _nodes.size(); ++i) {
+      _nodes[i].fig->left(_nodes[i].left);
+      _nodes[i].fig->top(_nodes[i].top);
     }
+    if (_undo_manager)
+      _undo_manager->enable();
   }
 
-  if (found_smaller_energy)
-    _min_energy = calc_energy();
+  for (std::size_t i = 0; i < _nodes.size(); ++i) {
+    Node &node = _nodes[i];
+    node.fig->left((long)(node.x - node.hw));
+    node.fig->top((long)(node.y - node.hh));
+  }
 
-  return found_smaller_energy;
+  if (_undo_manager && !final)
+    _undo_manager->enable();
 }
 
 //------------------------------------------------------------------------------
-bool Layouter::compare_node_links(const Node &n1, const Node &n2) {
-  return n1.linked.size() > n2.linked.size();
-}
+int Layouter::do_layout(double time_budget) {
+  if (_nodes.empty())
+    return 0;
 
-//------------------------------------------------------------------------------
-void Layouter::prepare_layout_stages() {
-  double total_w = 0;
-  double total_h = 0;
-  std::sort(_figures.begin(), _figures.end(), compare_node_links);
-
-  // reset layout
-  for (size_t i = 0; i < _figures.size(); ++i) {
-    Node &n = _figures[i];
-    // place all tables in some initial position
-    n.move((long)_w / 4, (long)_h / 4);
-
-    // Calculate total dimensions and find max cell size.
-    total_w += n.w;
-    total_h += n.h;
-    if (_cell_w < n.w)
-      _cell_w = (int)n.w;
-    if (_cell_h < n.h)
-      _cell_h = (int)n.h;
-  }
-  _cell_w = (int)(1.1 * _cell_w);
-}
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const std::chrono::steady_clock::duration budget =
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time_budget));
+  const std::chrono::milliseconds update_interval(500);
+  std::chrono::steady_clock::time_point last_update = start;
+
+  const unsigned thread_count = _nodes.size() < 256 ? 1 : std::max(1U, std::thread::hardware_concurrency());
+  auto step = [this, thread_count](double temperature, bool overlaps_only) {
+    build_grid();
+    const std::size_t chunk = (_nodes.size() + thread_count - 1) / thread_count;
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < thread_count && t * chunk < _nodes.size(); ++t)
+      threads.push_back(std::thread(&Layouter::calc_displacements, this, t * chunk,
+                                    std::min((t + 1) * chunk, _nodes.size()), temperature, overlaps_only));
+    calc_displacements(0, std::min(chunk, _nodes.size()), temperature, overlaps_only);
+    for (std::size_t t = 0; t < threads.size(); ++t)
+      threads[t].join();
+  };
 
-//------------------------------------------------------------------------------
-int Layouter::do_layout() {
-  prepare_layout_stages();
-
-  _min_energy = calc_energy();
-  int de0_count = 10; // de=0 count
-  double de = 1;      // energy delta
-  double prev_energy = 0;
-  while (de0_count > 0) {
-    shuffle();
-    de = prev_energy - _min_energy;
-    prev_energy = _min_energy;
-    if (de == 0)
-      --de0_count;
+  prepare_layout();
+
+  // Cool down until nothing moves anymore or the time is up. Progress is measured by how far nodes move in a step,
+  // which is cheap to get, instead of computing the energy of the whole layout.
+  double temperature = _cell_size;
+  int steps = 0;
+  int quiet_steps = 0;
+  while (quiet_steps < 10 && std::chrono::steady_clock::now() - start < budget) {
+    step(temperature, false);
+    double max_move = apply_displacements();
+    temperature = std::max(temperature * 0.97, 0.5);
+    ++steps;
+
+    if (max_move < 1)
+      ++quiet_steps;
     else
-      de0_count = 10;
+      quiet_steps = 0;
+
+    if (std::chrono::steady_clock::now() - last_update > update_interval) {
+      last_update = std::chrono::steady_clock::now();
+      update_figures(false);
+      grt::GRT::get()->send_progress(
+        (float)std::min(1.0, std::chrono::duration<double>(last_update - start).count() / time_budget),
+        _("Arranging figures..."));
+    }
   }
 
-  // update actual figures with new coords
-  for (std::size_t i = 0; i < _figures.size(); ++i) {
-    Node &n = _figures[i];
-    model_FigureRef &f = n.fig;
-
-    f->left(n.x1);
-    f->top(n.y1);
+  // Whatever overlaps remain gets resolved, even if the budget is used up.
+  for (int i = 0; i < 100; ++i) {
+    step(_cell_size, true);
+    if (!has_displacements())
+      break;
+    apply_displacements();
   }
+
+  logDebug("Layout of %i figures took %i steps, %.2fs\n", (int)_nodes.size(), steps,
+           std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+  update_figures(true);
   return 0;
 }
 
 //------------------------------------------------------------------------------
-int WbModelImpl::do_autolayout(const model_LayerRef &layer, ListRef<model_Object> &selection) {
-  Layouter layout(layer);
+int WbModelImpl::do_autolayout(const model_LayerRef &layer, ListRef<model_Object> &selection, double time_budget) {
+  Layouter layout(layer, _undo_man);
   if (selection.count() > 0) {
     for (std::size_t i = 0; i < selection->count(); ++i) {
       const model_ObjectRef figure = selection[i];
@@ -695,7 +694,7 @@ int WbModelImpl::do_autolayout(const model_LayerRef &layer, ListRef<model_Object
     layout.connect(conn->startFigure(), conn->endFigure());
   }
 
-  return layout.do_layout();
+  return layout.do_layout(time_budget);
 }
 
 static bool calculate_view_size(const app_PageSettingsRef &page, double &width, double &height) {
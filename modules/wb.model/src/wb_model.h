@@ -86,7 +86,7 @@ private:
   grt::ListRef<GrtObject> _selected_objects;
   bool _use_objects_from_catalog;
 
-  int do_autolayout(const model_LayerRef &layer, grt::ListRef<model_Object> &selection);
+  int do_autolayout(const model_LayerRef &layer, grt::ListRef<model_Object> &selection, double time_budget);
   int do_autoplace_any_list(const model_DiagramRef &view, grt::ListRef<GrtObject> &obj_list);
   int autoplace_relations(const model_DiagramRef &view, const grt::ListRef<db_Table> &tables);
   void handle_fklist_change(const model_DiagramRef &view, const db_TableRef &table, const db_ForeignKeyRef &fk,
@@ -23,6 +23,9 @@
 
 #include "DbSearchPanel.h"
 #include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include "grtui/grt_wizard_form.h"
 #include "grtui/connection_page.h"
 #include "grt/grt_string_list_model.h"
@@ -85,7 +88,16 @@ public:
   };
 
 private:
-  sql::ConnectionWrapper _db_conn;
+  // A table to search, with the column patterns that apply to it and its estimated size.
+  struct TableEntry {
+    std::string schema;
+    std::string table;
+    std::vector<std::string> column_patterns;
+    long long size;
+  };
+
+  // The first connection also enumerates the tables, all of them search tables in parallel.
+  std::vector<sql::ConnectionWrapper> _connections;
   grt::StringListRef _filter_list;
   std::string _search_keyword;
   std::string _state;
@@ -104,18 +116,26 @@ private:
   int _matched_rows;
   std::string _cast_to;
   int _search_data_type;
-  base::Mutex _search_result_mutex;
+  std::exception_ptr _error;
+  base::Mutex _search_result_mutex; // Also guards the counters and the state shared by the search threads.
   base::Mutex _pause_mutex;
 
 protected:
-  typedef std::function<void(const std::string&, const std::string&, const std::list<std::string>&,
+  typedef std::function<void(sql::Connection*, const std::string&, const std::string&, const std::list<std::string>&,
                              const std::list<std::string>&, const std::string&, const bool match_PK)>
     select_func_t;
   void run(select_func_t select_func);
-  void select_data(const std::string& schema_name, const std::string& table_name,
+  std::vector<TableEntry> fetch_tables();
+  void search_tables(sql::Connection* connection, const std::vector<TableEntry>& tables, std::atomic<size_t>& next,
+                     select_func_t select_func);
+  void search_table(sql::Connection* connection, const TableEntry& entry, const size_t table_count,
+                    select_func_t select_func);
+  std::string build_limit_clause();
+  bool limit_reached();
+  void select_data(sql::Connection* connection, const std::string& schema_name, const std::string& table_name,
                    const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
                    const std::string& limit_clause, const bool match_PK);
-  void count_data(const std::string& schema_name, const std::string& table_name,
+  void count_data(sql::Connection* connection, const std::string& schema_name, const std::string& table_name,
                   const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
                   const std::string& limit_clause, const bool match_PK);
 
@@ -127,10 +147,10 @@ public:
           _search_result_mutex = g_mutex_new();
       };
     */
-  DBSearch(sql::ConnectionWrapper connection, const std::string& search_keyword, const grt::StringListRef& filter_list,
-           const SearchMode search_mode, const int limit_total, const int limt_per_table, const bool invert,
-           const int search_data_type, const std::string cast_to)
-    : _db_conn(connection),
+  DBSearch(const std::vector<sql::ConnectionWrapper>& connections, const std::string& search_keyword,
+           const grt::StringListRef& filter_list, const SearchMode search_mode, const int limit_total,
+           const int limt_per_table, const bool invert, const int search_data_type, const std::string cast_to)
+    : _connections(connections),
       _filter_list(filter_list),
       _search_keyword(search_keyword),
       _state("Starting"),
@@ -182,6 +202,7 @@ public:
   float get_progress() const {
     return _progress;
   }
+  // Must be called with the search result mutex locked.
   std::string get_state() const {
     return _state;
   }
@@ -302,43 +323,43 @@ std::string DBSearch::build_select_query(const std::string& schema, const std::s
   return result;
 }
 
-void DBSearch::count_data(const std::string& schema_name, const std::string& table_name,
+void DBSearch::count_data(sql::Connection* connection, const std::string& schema_name, const std::string& table_name,
                           const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
                           const std::string& limit_clause, const bool match_PK) {
   std::string query = build_count_query(schema_name, table_name, select_columns, limit_clause, match_PK);
   if (query.empty())
     return;
 
-  std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
+  std::unique_ptr<sql::Statement> stmt(connection->createStatement());
   std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
-  if (_limit_counter > 0)
-    _limit_counter -= (int)rs->rowsCount();
   SearchResultEntry result;
   result.schema = schema_name;
   result.table = table_name;
   result.keys = pk_columns;
   result.query = query;
+  int matched_rows = 0;
   while (rs->next()) {
     std::vector<std::pair<std::string, std::string> > data;
     data.reserve(select_columns.size());
     data.push_back(std::pair<std::string, std::string>("COUNT", rs->getString(1)));
-    _matched_rows += rs->getInt(1);
+    matched_rows += rs->getInt(1);
     result.data.push_back(data);
   }
   base::MutexLock lock(_search_result_mutex);
+  if (_limit_counter > 0)
+    _limit_counter -= (int)rs->rowsCount();
+  _matched_rows += matched_rows;
   _search_result.push_back(result);
 };
 
-void DBSearch::select_data(const std::string& schema_name, const std::string& table_name,
+void DBSearch::select_data(sql::Connection* connection, const std::string& schema_name, const std::string& table_name,
                            const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
                            const std::string& limit_clause, const bool match_PK) {
   std::string query = build_select_query(schema_name, table_name, select_columns, limit_clause, match_PK);
   if (query.empty())
     return;
-  std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
+  std::unique_ptr<sql::Statement> stmt(connection->createStatement());
   std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
-  if (_limit_counter > 0)
-    _limit_counter -= (int)rs->rowsCount();
   SearchResultEntry result;
   result.schema = schema_name;
   result.table = table_name;
@@ -353,21 +374,30 @@ void DBSearch::select_data(const std::string& schema_name, const std::string& ta
     if (!data.empty())
       result.data.push_back(data);
   }
+
+  base::MutexLock lock(_search_result_mutex);
+  // Other threads may have used up the total limit while this query ran (each query is limited by what was left when
+  // it started), so cut the result down to what is left now.
+  if (_limit_total > 0) {
+    if (_limit_counter <= 0)
+      result.data.clear();
+    else if ((int)result.data.size() > _limit_counter)
+      result.data.resize(_limit_counter);
+    _limit_counter -= (int)result.data.size();
+  }
   _matched_rows += (int)result.data.size();
-  if (!result.data.empty()) {
-    base::MutexLock lock(_search_result_mutex);
+  if (!result.data.empty())
     _search_result.push_back(result);
-  }
 };
 
 void DBSearch::search() {
   run(std::bind(&DBSearch::select_data, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
-                std::placeholders::_4, std::placeholders::_5, std::placeholders::_6));
+                std::placeholders::_4, std::placeholders::_5, std::placeholders::_6, std::placeholders::_7));
 };
 
 void DBSearch::count() {
   run(std::bind(&DBSearch::count_data, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
-                std::placeholders::_4, std::placeholders::_5, std::placeholders::_6));
+                std::placeholders::_4, std::placeholders::_5, std::placeholders::_6, std::placeholders::_7));
 };
 
 void DBSearch::run(select_func_t select_func) {
@@ -389,179 +419,256 @@ void DBSearch::run(select_func_t select_func) {
   _state = "Fetch schema list";
   _searched_tables = 0;
   _matched_rows = 0;
-  std::map<std::string, std::vector<std::string> > schemas;
-  std::map<std::string, std::vector<std::string> > schemas_tables;
+  _error = nullptr;
+
+  std::vector<TableEntry> tables = fetch_tables();
+  if (_stop) {
+    _working = false;
+    return;
+  }
+
+  // Every connection takes the next table from the list, smallest first, until all are searched or the search is
+  // stopped. The results are appended as each table finishes, so the panel shows them while the search goes on.
   {
-    std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
-    for (size_t count = _filter_list.count(), i = 0; i < count; i++) {
-      wait_if_paused();
-      if (_stop) {
-        _working = false;
-        return;
+    base::MutexLock lock(_search_result_mutex);
+    _state = base::strfmt("Searching %i tables", (int)tables.size());
+  }
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < _connections.size() && i < tables.size(); ++i)
+    threads.push_back(std::thread(&DBSearch::search_tables, this, _connections[i].get(), std::cref(tables),
+                                  std::ref(next), select_func));
+  search_tables(_connections.front().get(), tables, next, select_func);
+  for (auto& thread : threads)
+    thread.join();
+
+  if (_error) {
+    _working = false;
+    std::rethrow_exception(_error);
+  }
+
+  if (_stop) {
+    _working = false;
+    return;
+  }
+
+  {
+    base::MutexLock lock(_search_result_mutex);
+    if (_searched_tables == 0)
+      _state = "No tables were searched";
+    else
+      _state = base::strfmt("Search completed in %i tables", _searched_tables);
+  }
+  _progress = 1;
+  _working = false;
+}
+
+/**
+ * Collects the tables matching the filter list, together with the column patterns to search in each of them.
+ * The result is ordered by the estimated table size, so that small tables come back first.
+ */
+std::vector<DBSearch::TableEntry> DBSearch::fetch_tables() {
+  std::vector<TableEntry> tables;
+  std::map<std::string, std::vector<std::string> > schemas;
+  std::unique_ptr<sql::Statement> stmt(_connections.front()->createStatement());
+  for (size_t count = _filter_list.count(), i = 0; i < count; i++) {
+    wait_if_paused();
+    if (_stop)
+      return tables;
+    std::string schema_pattern = _filter_list.get(i);
+    size_t dotpos = schema_pattern.find('.');
+    std::string table_column;
+    if (dotpos != std::string::npos)
+      table_column = schema_pattern.substr(dotpos + 1);
+    schema_pattern = schema_pattern.substr(0, dotpos);
+    if (schema_pattern.empty() || schema_pattern.find('%') != std::string::npos) {
+      schema_pattern = "%";
+      std::unique_ptr<sql::ResultSet> rs(
+        stmt->executeQuery(std::string(base::sqlstring("SHOW DATABASES LIKE ?", 0) << schema_pattern)));
+      while (rs->next()) {
+        std::string schema = rs->getString(1);
+        schemas[schema].push_back(table_column);
       }
-      std::string schema_pattern = _filter_list.get(i);
-      size_t dotpos = schema_pattern.find('.');
-      std::string table_column;
+    } else
+      schemas[schema_pattern].push_back(table_column);
+  }
+
+  std::map<std::string, size_t> table_index;
+  for (std::map<std::string, std::vector<std::string> >::const_iterator It = schemas.begin(); It != schemas.end();
+       ++It) {
+    std::string schema_name = It->first;
+    {
+      base::MutexLock lock(_search_result_mutex);
+      _state = std::string("Populate tables in ") + schema_name;
+    }
+    std::vector<std::string> patterns = It->second;
+    for (std::vector<std::string>::const_iterator It_tables = patterns.begin(); It_tables != patterns.end();
+         ++It_tables) {
+      wait_if_paused();
+      if (_stop)
+        return tables;
+      std::string table_pattern = *It_tables;
+      size_t dotpos = table_pattern.find('.');
+      std::string column_pattern;
       if (dotpos != std::string::npos)
-        table_column = schema_pattern.substr(dotpos + 1);
-      schema_pattern = schema_pattern.substr(0, dotpos);
-      if (schema_pattern.empty() || schema_pattern.find('%') != std::string::npos) {
-        schema_pattern = "%";
-        std::unique_ptr<sql::ResultSet> rs(
-          stmt->executeQuery(std::string(base::sqlstring("SHOW DATABASES LIKE ?", 0) << schema_pattern)));
-        while (rs->next()) {
-          std::string schema = rs->getString(1);
-          schemas[schema].push_back(table_column);
-        }
-      } else
-        schemas[schema_pattern].push_back(table_column);
+        column_pattern = table_pattern.substr(dotpos + 1);
+      else
+        column_pattern = '%';
+      table_pattern = table_pattern.substr(0, dotpos);
+      if (table_pattern.empty())
+        table_pattern = "%";
+
+      // DATA_LENGTH is only an estimate for InnoDB, but good enough to get the small tables done first.
+      std::string query = base::sqlstring(
+        "SELECT TABLE_NAME, IFNULL(DATA_LENGTH, 0) FROM INFORMATION_SCHEMA.TABLES WHERE TABLE_SCHEMA = ?", 0)
+                          << schema_name;
+      if (table_pattern == "%")
+        query.append(" AND TABLE_TYPE = 'BASE TABLE'");
+      else
+        query.append(base::sqlstring(" AND TABLE_NAME LIKE ?", 0) << table_pattern);
+
+      std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
+      while (rs->next()) {
+        std::string table = rs->getString(1);
+        std::string key = schema_name + '.' + table;
+        auto index = table_index.find(key);
+        if (index == table_index.end()) {
+          table_index[key] = tables.size();
+          tables.push_back({schema_name, table, {column_pattern}, (long long)rs->getInt64(2)});
+        } else
+          tables[index->second].column_patterns.push_back(column_pattern);
+      }
     }
   }
+
+  std::stable_sort(tables.begin(), tables.end(),
+                   [](const TableEntry& a, const TableEntry& b) { return a.size < b.size; });
+  return tables;
+}
+
+/**
+ * Searches tables from the given list on one connection, picking the next unsearched one each time.
+ * Runs in parallel for each connection. The first error stops the search and is rethrown by run().
+ */
+void DBSearch::search_tables(sql::Connection* connection, const std::vector<TableEntry>& tables,
+                             std::atomic<size_t>& next, select_func_t select_func) {
+  try {
+    while (true) {
+      wait_if_paused();
+      if (_stop || limit_reached())
+        break;
+
+      size_t index = next++;
+      if (index >= tables.size())
+        break;
+      search_table(connection, tables[index], tables.size(), select_func);
+    }
+  } catch (...) {
+    base::MutexLock lock(_search_result_mutex);
+    if (!_error)
+      _error = std::current_exception();
+    _stop = true;
+  }
+}
+
+void DBSearch::search_table(sql::Connection* connection, const TableEntry& entry, const size_t table_count,
+                            select_func_t select_func) {
+  // Pick columns
+  const std::string& schema_name = entry.schema;
+  const std::string& table_name = entry.table;
   {
-    std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
-    for (std::map<std::string, std::vector<std::string> >::const_iterator It = schemas.begin(); It != schemas.end();
-         ++It) {
-      std::string schema_name = It->first;
-      _state = std::string("Populate tables in ") + schema_name;
-      std::vector<std::string> tables = It->second;
-      for (std::vector<std::string>::const_iterator It_tables = tables.begin(); It_tables != tables.end();
-           ++It_tables) {
-        wait_if_paused();
-        if (_stop) {
-          _working = false;
-          return;
-        }
-        std::string table_pattern = *It_tables;
-        size_t dotpos = table_pattern.find('.');
-        std::string column_pattern;
-        if (dotpos != std::string::npos)
-          column_pattern = table_pattern.substr(dotpos + 1);
-        else
-          column_pattern = '%';
-        table_pattern = table_pattern.substr(0, dotpos);
-        if (table_pattern.empty())
-          table_pattern = "%";
-
-        std::string query;
-        if (table_pattern == "%") {
-          query.append(base::sqlstring("SHOW FULL TABLES FROM ! WHERE Table_type = 'BASE TABLE'", 0) << schema_name);
-        } else {
-          query.append(base::sqlstring("SHOW TABLES FROM ! LIKE ?", 0) << schema_name << table_pattern);
+    base::MutexLock lock(_search_result_mutex);
+    _state = std::string("SELECT data from ") + schema_name + "." + table_name;
+  }
+  std::string like_clause;
+  static const std::string like_pattern = "Field LIKE ? OR ";
+  for (std::vector<std::string>::const_iterator It_cols = entry.column_patterns.begin();
+       It_cols != entry.column_patterns.end(); ++It_cols)
+    like_clause.append(std::string(base::sqlstring(like_pattern.c_str(), base::UseAnsiQuotes) << *It_cols));
+  like_clause.append("FALSE");
+
+  std::list<std::string> pk_columns;
+  bool match_PK = false;
+  std::list<std::string> select_columns;
+  try {
+    std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+    std::unique_ptr<sql::ResultSet> rs(
+      stmt->executeQuery(std::string(base::sqlstring("SHOW COLUMNS FROM !.! WHERE ", base::QuoteOnlyIfNeeded)
+                                     << schema_name << table_name)
+                           .append(like_clause)));
+    while (rs->next()) {
+      std::string column = rs->getString(1);
+      std::string column_type = rs->getString(2);
+      if ((_search_data_type == search_all_types) ||
+          ((_search_data_type & numeric_type) && is_numeric_type(column_type)) ||
+          ((_search_data_type & datetime_type) && is_datetime_type(column_type)) ||
+          ((_search_data_type & text_type) && is_string_type(column_type))) {
+        if (rs->getString(4) == "PRI") {
+          select_columns.push_front(column);
+          pk_columns.push_back(column);
+          match_PK = true; // PK should be searched, not just displayed
         }
-        std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
-        while (rs->next()) {
-          std::string table = rs->getString(1);
-          schemas_tables[schema_name + '.' + table].push_back(column_pattern);
+        select_columns.push_back(column);
+      } else {
+        if (rs->getString(4) == "PRI") {
+          select_columns.push_front(column);
+          pk_columns.push_back(column);
         }
       }
     }
+  } catch (std::exception& exc) {
+    logWarning("Could not get columns list from %s.%s: %s\n", schema_name.c_str(), table_name.c_str(), exc.what());
   }
-  int cntr = 0;
-  for (std::map<std::string, std::vector<std::string> >::const_iterator It = schemas_tables.begin();
-       It != schemas_tables.end(); ++It) {
-    // Pick columns
-    std::string table_name = It->first;
-    size_t dotpos = table_name.find('.');
-    std::string schema_name = table_name.substr(0, dotpos);
-    _state = std::string("SELECT data from ") + schema_name + "." + table_name;
-    table_name = table_name.substr(++dotpos);
-    std::vector<std::string> columns = It->second;
-    std::string like_clause;
-    static const std::string like_pattern = "Field LIKE ? OR ";
-    for (std::vector<std::string>::const_iterator It_cols = columns.begin(); It_cols != columns.end(); ++It_cols)
-      like_clause.append(std::string(base::sqlstring(like_pattern.c_str(), base::UseAnsiQuotes) << *It_cols));
-    like_clause.append("FALSE");
-
-    wait_if_paused();
-    if (_stop) {
-      _working = false;
-      return;
-    }
-
-    std::list<std::string> pk_columns;
-    bool match_PK = false;
-    std::list<std::string> select_columns;
+  // Add PK col if there is at least one column matching pattern and it it wasn't added during col patterns search
+  if (pk_columns.empty() && !select_columns.empty()) {
     try {
-      std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
-      std::unique_ptr<sql::ResultSet> rs(
-        stmt->executeQuery(std::string(base::sqlstring("SHOW COLUMNS FROM !.! WHERE ", base::QuoteOnlyIfNeeded)
-                                       << schema_name << table_name)
-                             .append(like_clause)));
+      std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+      std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(
+        std::string(base::sqlstring("SHOW COLUMNS FROM !.! WHERE `Key` = 'PRI'", base::QuoteOnlyIfNeeded)
+                    << schema_name << table_name)));
       while (rs->next()) {
-        std::string column = rs->getString(1);
-        std::string column_type = rs->getString(2);
-        if ((_search_data_type == search_all_types) ||
-            ((_search_data_type & numeric_type) && is_numeric_type(column_type)) ||
-            ((_search_data_type & datetime_type) && is_datetime_type(column_type)) ||
-            ((_search_data_type & text_type) && is_string_type(column_type))) {
-          if (rs->getString(4) == "PRI") {
-            select_columns.push_front(column);
-            pk_columns.push_back(column);
-            match_PK = true; // PK should be searched, not just displayed
-          }
-          select_columns.push_back(column);
-        } else {
-          if (rs->getString(4) == "PRI") {
-            select_columns.push_front(column);
-            pk_columns.push_back(column);
-          }
-        }
+        select_columns.push_back(rs->getString(1));
+        pk_columns.push_back(rs->getString(1));
       }
+      // set PK col to be the first, or push empty string to indicate that there is no PK at all
+      if (pk_columns.empty())
+        select_columns.push_front("");
     } catch (std::exception& exc) {
       logWarning("Could not get columns list from %s.%s: %s\n", schema_name.c_str(), table_name.c_str(), exc.what());
     }
-    // Add PK col if there is at least one column matching pattern and it it wasn't added during col patterns search
-    if (pk_columns.empty() && !select_columns.empty()) {
-      try {
-        std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
-        std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(
-          std::string(base::sqlstring("SHOW COLUMNS FROM !.! WHERE `Key` = 'PRI'", base::QuoteOnlyIfNeeded)
-                      << schema_name << table_name)));
-        while (rs->next()) {
-          select_columns.push_back(rs->getString(1));
-          pk_columns.push_back(rs->getString(1));
-        }
-        // set PK col to be the first, or push empty string to indicate that there is no PK at all
-        if (pk_columns.empty())
-          select_columns.push_front("");
-      } catch (std::exception& exc) {
-        logWarning("Could not get columns list from %s.%s: %s\n", schema_name.c_str(), table_name.c_str(), exc.what());
-      }
-    }
+  }
 
-    { // Build select from columns fetched on previous step and use it to collect data
-      wait_if_paused();
-      if (_stop) {
-        _working = false;
-        return;
-      }
-      ++cntr;
-      std::string limit_clause("");
-      if (_limit_counter > 0) {
-        size_t limit = std::min(_limit_counter, _limt_per_table);
-        std::stringstream sout;
-        sout << "LIMIT " << limit;
-        limit_clause = sout.str();
-      } else if (_limt_per_table) {
-        std::stringstream sout;
-        sout << "LIMIT " << _limt_per_table;
-        limit_clause = sout.str();
-      }
+  // Build select from columns fetched on previous step and use it to collect data
+  wait_if_paused();
+  if (_stop)
+    return;
 
-      _progress = (cntr * 1.f) / (schemas_tables.size());
-      select_func(schema_name, table_name, pk_columns, select_columns, limit_clause, match_PK);
-      _searched_tables++;
+  select_func(connection, schema_name, table_name, pk_columns, select_columns, build_limit_clause(), match_PK);
 
-      if ((_limit_total > 0) && (_limit_counter <= 0))
-        break;
-    }
+  base::MutexLock lock(_search_result_mutex);
+  _searched_tables++;
+  _progress = (_searched_tables * 1.f) / table_count;
+}
+
+std::string DBSearch::build_limit_clause() {
+  base::MutexLock lock(_search_result_mutex);
+  std::string limit_clause("");
+  if (_limit_counter > 0) {
+    size_t limit = _limt_per_table > 0 ? std::min(_limit_counter, _limt_per_table) : _limit_counter;
+    std::stringstream sout;
+    sout << "LIMIT " << limit;
+    limit_clause = sout.str();
+  } else if (_limt_per_table) {
+    std::stringstream sout;
+    sout << "LIMIT " << _limt_per_table;
+    limit_clause = sout.str();
   }
-  if (_searched_tables == 0)
-    _state = "No tables were searched";
-  else
-    _state = base::strfmt("Search completed in %i tables", _searched_tables);
-  _progress = 1;
-  _working = false;
+  return limit_clause;
+}
+
+bool DBSearch::limit_reached() {
+  base::MutexLock lock(_search_result_mutex);
+  return (_limit_total > 0) && (_limit_counter <= 0);
 }
 
 DBSearchPanel::DBSearchPanel()
@@ -769,8 +876,8 @@ void DBSearchPanel::prepare_menu() {
   }
 }
 
+// Adds the tables which got results since the last call, so matches show up while the search is running.
 void DBSearchPanel::load_model(mforms::TreeNodeRef tnode) {
-  _key_columns.clear();
   for (size_t c = _searcher->search_results().size(), i = tnode->count(); i < c; i++) {
     const DBSearch::column_data_t& rows = _searcher->search_results()[i].data;
     mforms::TreeNodeRef table_node = tnode->add_child();
@@ -802,7 +909,7 @@ void DBSearchPanel::load_model(mforms::TreeNodeRef tnode) {
   }
 };
 
-void DBSearchPanel::search(sql::ConnectionWrapper connection, const std::string& search_keyword,
+void DBSearchPanel::search(const std::vector<sql::ConnectionWrapper>& connections, const std::string& search_keyword,
                            const grt::StringListRef& filter_list, const SearchMode search_mode, const int limit_total,
                            const int limt_per_table, const bool invert, const int search_data_type,
                            const std::string cast_to, std::function<void(grt::ValueRef)> finished_callback,
@@ -813,13 +920,14 @@ void DBSearchPanel::search(sql::ConnectionWrapper connection, const std::string&
   _progress_box.show(true);
 
   _results_tree.clear();
+  _key_columns.clear();
 
   stop_search_if_working();
   _search_finished = false;
   if (_update_timer)
     bec::GRTManager::get()->cancel_timer(_update_timer);
-  _searcher = std::shared_ptr<DBSearch>(new DBSearch(connection, search_keyword, filter_list, search_mode, limit_total,
-                                                     limt_per_table, invert, search_data_type, cast_to));
+  _searcher = std::shared_ptr<DBSearch>(new DBSearch(connections, search_keyword, filter_list, search_mode,
+                                                     limit_total, limt_per_table, invert, search_data_type, cast_to));
   load_model(_results_tree.root_node());
   std::function<void()> fsearch = (std::bind(&DBSearch::search, _searcher.get()));
   // fsearch = (std::bind(&DBSearch::count, _searcher.get()));//COUNT test
@@ -828,7 +936,7 @@ void DBSearchPanel::search(sql::ConnectionWrapper connection, const std::string&
                                            finished_callback);
   while (_searcher->is_starting())
     ;
-  _update_timer = bec::GRTManager::get()->run_every(std::bind(&DBSearchPanel::update, this), 1);
+  _update_timer = bec::GRTManager::get()->run_every(std::bind(&DBSearchPanel::update, this), 0.5);
 }
 
 bool DBSearchPanel::update() {
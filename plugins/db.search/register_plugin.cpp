@@ -42,6 +42,8 @@
 #include <boost/assign/list_of.hpp>
 #include <boost/lambda/bind.hpp>
 
+DEFAULT_LOG_DOMAIN("db.search");
+
 class DBSearchView : public mforms::AppView, public grt::GRTObserver {
 private:
   db_query_EditorRef _editor;
@@ -159,13 +161,24 @@ private:
     bool invert = _filter_panel.exclude();
     sql::DriverManager *dm = sql::DriverManager::getDriverManager();
     mforms::App::get()->set_status_text("Opening new connection...");
-    sql::ConnectionWrapper wrapper;
+    std::vector<sql::ConnectionWrapper> connections;
     try {
-      wrapper = dm->getConnection(_editor->connection());
+      connections.push_back(dm->getConnection(_editor->connection()));
     } catch (grt::user_cancelled &ucancel) {
       mforms::App::get()->set_status_text(ucancel.what());
       return;
     }
+
+    // Tables are searched in parallel over a few more connections, the search works with whatever could be opened.
+    int connection_count = (int)bec::GRTManager::get()->get_app_option_int("db.search:SearchConnections", 4);
+    for (int i = 1; i < connection_count; ++i) {
+      try {
+        connections.push_back(dm->getConnection(_editor->connection()));
+      } catch (std::exception &exc) {
+        logWarning("Could not open additional search connection: %s\n", exc.what());
+        break;
+      }
+    }
     mforms::App::get()->set_status_text("Searching...");
 
     bec::GRTManager::get()->set_app_option("db.search:SearchType", grt::IntegerRef(search_type));
@@ -177,7 +190,7 @@ private:
     _search_panel.show(true);
 
     _search_panel.search(
-      wrapper, search_keyword, filters, SearchMode(search_type), limit_total, limit_table, invert,
+      connections, search_keyword, filters, SearchMode(search_type), limit_total, limit_table, invert,
       _filter_panel.search_all_types() ? search_all_types : text_type, _filter_panel.search_all_types() ? "CHAR" : "",
       std::bind(&DBSearchView::finished_search, this), std::bind(&DBSearchView::failed_search, this));
   }
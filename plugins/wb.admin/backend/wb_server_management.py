@@ -2108,6 +2108,30 @@ class SFTPInputFile(object):
             log_error("Exception executing readline: %s\n%s\n" % (e, traceback.format_exc()))
             return "";
 
+    def __iter__(self):
+        line = self.readline()
+        while line:
+            yield line
+            line = self.readline()
+
+    def tail_bytes(self, count):
+        """Returns the last count bytes of the file, leaving the position at its end."""
+        try:
+            return self._f.tailBytes(count)
+        except SystemError as e:
+            import traceback
+            log_error("Exception executing tail_bytes: %s\n%s\n" % (e, traceback.format_exc()))
+            return "";
+
+    def tail_lines(self, count):
+        """Returns the last count lines of the file, leaving the position at its end."""
+        try:
+            return self._f.tailLines(count)
+        except SystemError as e:
+            import traceback
+            log_error("Exception executing tail_lines: %s\n%s\n" % (e, traceback.format_exc()))
+            return "";
+
 
 import multiprocessing
 class SudoTailInputFile(object):
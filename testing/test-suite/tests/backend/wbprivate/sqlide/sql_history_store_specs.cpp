@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <fstream>
+#include <glib/gstdio.h>
+
+#include "base/file_utilities.h"
+#include "sqlide/sqlide_generics.h"
+#include "sqlide/sql_history_store.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::string dir;
+};
+
+$describe("SQL history store") {
+  $beforeAll([this]() {
+    data->dir = base::makePath(casmine::CasmineContext::get()->tmpDataDir(), "sql_history_store");
+    base::remove_recursive(data->dir);
+    g_mkdir_with_parents(data->dir.c_str(), 0700);
+  });
+
+  $afterAll([this]() {
+    base::remove_recursive(data->dir);
+  });
+
+  $it("Imports the legacy history files only once", [this]() {
+    {
+      std::ofstream file(base::makePath(data->dir, "2020-01-02"));
+      file << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n";
+      file << "<ENTRY timestamp='10:00:00'>select 1</ENTRY>\n";
+      file << "<ENTRY timestamp='~'>select &lt;2&gt;</ENTRY>\n";
+      file << "<ENTRY timestamp='10:05:00'>~</ENTRY>\n";
+    }
+
+    SqlHistoryStore store(base::makePath(data->dir, "history.db"));
+    $expect(store.import_legacy_files(data->dir)).toBe(3U);
+    $expect(store.import_legacy_files(data->dir)).toBe(0U, "Second import must not add anything");
+
+    $expect(store.days("")).toEqual(std::vector<std::string>({ "2020-01-02" }));
+    std::vector<SqlHistoryStore::Entry> entries = store.fetch("2020-01-02", "", 0, 10);
+    $expect(entries).toHaveSize(3);
+    $expect(entries[0].time).toBe("10:05:00");
+    $expect(entries[0].statement).toBe("select <2>");
+    $expect(entries[2].statement).toBe("select 1");
+    $expect(entries[2].duration < 0).toBeTrue();
+  });
+
+  $it("Appends, pages and searches entries", [this]() {
+    SqlHistoryStore store(base::makePath(data->dir, "history.db"));
+
+    std::tm timestamp = local_timestamp();
+    std::string today = format_time(timestamp, "%Y-%m-%d");
+    std::list<std::string> statements;
+    for (int i = 0; i < 25; ++i)
+      statements.push_back("select * from customers where id = " + std::to_string(i));
+    statements.push_back("  update orders set total = 0  ");
+
+    std::int64_t id = store.append(timestamp, "sakila", statements);
+    $expect(id).toBeGreaterThan(0);
+    store.set_duration(id, 0.25);
+
+    $expect(store.days("")).toHaveSize(2);
+    $expect(store.days("")[0]).toBe(today);
+    $expect(store.count(today, "")).toBe(26U);
+
+    std::vector<SqlHistoryStore::Entry> page = store.fetch(today, "", 0, 10);
+    $expect(page).toHaveSize(10);
+    $expect(page[0].statement).toBe("update orders set total = 0");
+    $expect(page[0].schema).toBe("sakila");
+    $expect(page[0].duration).toBe(0.25);
+    $expect(store.fetch(today, "", 20, 10)).toHaveSize(6);
+
+    $expect(store.count(today, "orders")).toBe(1U);
+    $expect(store.count(today, "custom")).toBe(25U, "Words are matched as prefix");
+    $expect(store.count(today, "\"customers\" AND")).toBe(0U, "Operators are taken literally");
+    $expect(store.days("orders")).toEqual(std::vector<std::string>({ today }));
+
+    store.delete_day(today);
+    $expect(store.count(today, "")).toBe(0U);
+    $expect(store.count(today, "orders")).toBe(0U);
+    $expect(store.days("")).toHaveSize(1);
+  });
+}
+
+}
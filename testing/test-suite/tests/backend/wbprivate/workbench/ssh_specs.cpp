@@ -26,8 +26,10 @@
 #include "base/string_utilities.h"
 
 #include "SSHCommon.h"
+#include "SSHSessionPool.h"
 #include "SSHTunnelManager.h"
 #include "workbench/SSHSessionWrapper.h"
+#include "workbench/SSHFileWrapper.h"
 #include "SSHSftp.h"
 #include "cdbc/src/driver_manager.h"
 #include "grtpp_util.h"
@@ -182,6 +184,106 @@ $xdescribe("SSH testing") {
     $expect(sftp.pwd()).toBe(currentDir, "Invalid current directory information");
   });
 
+  $it("Tests pipelined sftp transfers", [this]() {
+    auto config = data->connectionConfig;
+    config.strictHostKeyCheck = false;
+    auto credentials = data->connectionCredentials;
+    credentials.auth = ssh::SSHAuthtype::PASSWORD;
+
+    auto session = ssh::SSHSession::createSession();
+    auto retVal = session->connect(config, credentials);
+    $expect(std::get<0>(retVal) == ssh::SSHReturnType::CONNECTED).toBe(true, "Connection failed");
+
+    // Odd sizes, so the last request is a short one.
+    std::string content;
+    for (size_t i = 0; i < 3 * 1024 * 1024 + 17; ++i)
+      content += (char)('a' + i % 23);
+
+    auto upload = base::makeTmpFile("pipelined_upload");
+    auto uploadPath = upload.getPath();
+    upload.dispose();
+    base::setTextFileContent(uploadPath, content);
+
+    ssh::SSHSftp sftp(session, 10 * 1024 * 1024);
+    sftp.setTransferOptions(8, 12345);
+    std::string testFile = "ssh_test_" + casmine::randomString();
+    sftp.put(uploadPath, testFile);
+    $expect(sftp.lastTransferStats().bytes).toBe((uint64_t)content.size());
+    base::remove(uploadPath);
+
+    for (size_t requests : { 1, 4, 32 }) {
+      sftp.setTransferOptions(requests, 32768);
+      $expect(sftp.getContent(testFile) == content).toBe(true, "Content mismatch with " + std::to_string(requests) +
+                                                          " requests");
+      $expect(sftp.lastTransferStats().bytes).toBe((uint64_t)content.size());
+      $expect(sftp.lastTransferStats().bytesPerSecond()).toBeGreaterThan(0.0);
+    }
+
+    auto download = base::makeTmpFile("pipelined_download");
+    auto downloadPath = download.getPath();
+    download.dispose();
+    sftp.get(testFile, downloadPath);
+    $expect(base::getTextFileContent(downloadPath) == content).toBe(true, "Downloaded file mismatch");
+    base::remove(downloadPath);
+
+    sftp.setMaxFileLimit(1024 * 1024);
+    try {
+      sftp.getContent(testFile);
+      $fail("Max file limit was not enforced");
+    } catch (ssh::SSHSftpException &) {
+      // pass
+    }
+
+    // The session must still be usable after an aborted pipelined read.
+    $expect(sftp.fileExists(testFile)).toBe(true, "Session unusable after aborted transfer");
+    sftp.unlink(testFile);
+    session->disconnect();
+  });
+
+  $it("Reads remote files by line and from the end", [this]() {
+    auto config = data->connectionConfig;
+    config.strictHostKeyCheck = false;
+    auto credentials = data->connectionCredentials;
+    credentials.auth = ssh::SSHAuthtype::PASSWORD;
+
+    auto session = ssh::SSHSession::createSession();
+    auto retVal = session->connect(config, credentials);
+    $expect(std::get<0>(retVal) == ssh::SSHReturnType::CONNECTED).toBe(true, "Connection failed");
+
+    // Enough lines to need several read-ahead blocks.
+    std::vector<std::string> lines;
+    std::string content;
+    for (size_t i = 0; i < 5000; ++i) {
+      lines.push_back("line " + std::to_string(i) + std::string(i % 37, '.') + "\n");
+      content += lines.back();
+    }
+
+    auto sftp = std::make_shared<ssh::SSHSftp>(session, 10 * 1024 * 1024);
+    std::string testFile = "ssh_test_" + casmine::randomString();
+    sftp->setContent(testFile, content);
+
+    {
+      ssh::SSHFileWrapper file(session, sftp, testFile, 10 * 1024 * 1024);
+      for (auto &line : lines)
+        $expect(*file.readline()).toBe(line);
+      $expect(*file.readline()).toBe("");
+      $expect(*file.tell()).toBe((ssize_t)content.size());
+
+      file.seek(lines[0].size());
+      $expect(*file.read(lines[1].size())).toBe(lines[1]);
+      $expect(*file.readline()).toBe(lines[2]);
+
+      $expect(*file.tailLines(3)).toBe(lines[4997] + lines[4998] + lines[4999]);
+      $expect(*file.tell()).toBe((ssize_t)content.size());
+      $expect(*file.tailLines(10000)).toBe(content);
+      $expect(*file.tailBytes(10)).toBe(content.substr(content.size() - 10));
+      $expect(*file.read(10)).toBe("");
+    }
+
+    sftp->unlink(testFile);
+    session->disconnect();
+  });
+
   $it("Tests tunnel connection", [this]() {
     auto config = data->connectionConfig;
     config.remotehost = "127.0.0.1";
@@ -251,9 +353,57 @@ $xdescribe("SSH testing") {
       $fail(std::string("Unable to make tunnel connection. ").append(exc.what()));
     }
 
+    auto stats = manager->getTunnelStats(session->getConfig());
+    $expect(stats.connections >= 4).toBe(true, "Tunnel didn't count the client connections");
+    $expect(stats.channelsOpened >= 4).toBe(true, "Tunnel didn't count the opened channels");
+    $expect(stats.bytesToServer > 0 && stats.bytesToClient > 0).toBe(true, "Tunnel didn't count transferred bytes");
+
     manager->setStop();
     manager->pokeWakeupSocket();
   });
+
+  $it("Shares sessions through the session pool", [this]() {
+    auto config = data->connectionConfig;
+    config.strictHostKeyCheck = false;
+    auto credentials = data->connectionCredentials;
+    credentials.auth = ssh::SSHAuthtype::PASSWORD;
+
+    auto pool = ssh::SSHSessionPool::get();
+    pool->setIdleTimeout(60);
+
+    std::shared_ptr<ssh::SSHSession> first;
+    auto retVal = pool->acquire(config, credentials, ssh::SSHSessionPool::Use::TUNNEL, first);
+    $expect(std::get<0>(retVal) == ssh::SSHReturnType::CONNECTED).toBe(true, "connection established");
+
+    // A different tunnel target over the same host and account must reuse the session.
+    config.remoteport = config.remoteport + 1;
+    std::shared_ptr<ssh::SSHSession> second;
+    retVal = pool->acquire(config, credentials, ssh::SSHSessionPool::Use::TUNNEL, second);
+    $expect(std::get<0>(retVal) == ssh::SSHReturnType::CONNECTED).toBe(true, "connection established");
+    $expect(first == second).toBe(true, "Session wasn't reused");
+    $expect(pool->isShared(first)).toBe(true, "Session isn't marked as shared");
+
+    // Both users can run commands over the shared session.
+    auto ret = first->execCmd("echo one");
+    $expect(std::get<0>(ret)).toBe("one\n");
+    ret = second->execCmd("echo two");
+    $expect(std::get<0>(ret)).toBe("two\n");
+
+    // SFTP and remote commands get a session of their own, so they don't stall the tunnels.
+    std::shared_ptr<ssh::SSHSession> commands;
+    retVal = pool->acquire(config, credentials, ssh::SSHSessionPool::Use::COMMANDS, commands);
+    $expect(std::get<0>(retVal) == ssh::SSHReturnType::CONNECTED).toBe(true, "connection established");
+    $expect(commands != first).toBe(true, "Command session is shared with tunnels");
+    pool->release(commands);
+
+    pool->release(second);
+    $expect(pool->isShared(first)).toBe(false, "Session still marked as shared");
+    pool->release(first);
+    $expect(first->isConnected()).toBe(true, "Idle session was closed before the timeout");
+
+    pool->closeIdleSessions(true);
+    $expect(first->isConnected()).toBe(false, "Idle session wasn't closed");
+  });
 }
 
 }
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "sqlide/query_trace.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$describe("Query trace") {
+  $it("Records spans and splits off server time", []() {
+    QueryTrace trace(1, "select 1");
+    $expect(trace.empty()).toBeTrue();
+
+    trace.add_span(QueryTrace::Parse, 100, 150);
+    trace.add_span(QueryTrace::Send, 150, 1150);
+    trace.add_mark(QueryTrace::FirstRow, 1200);
+    trace.add_span(QueryTrace::Fetch, 1150, 1300);
+
+    $expect(trace.start_time()).toBe(100);
+    $expect(trace.end_time()).toBe(1300);
+
+    trace.split_server_time(600);
+    $expect(trace.spans).toHaveSize(5);
+    $expect(trace.spans[1].duration).toBe(400);
+    $expect(static_cast<int>(trace.spans.back().phase)).toBe(static_cast<int>(QueryTrace::ServerExecution));
+    $expect(trace.spans.back().start).toBe(550);
+    $expect(trace.spans.back().duration).toBe(600);
+
+    // Server time can never be larger than what the client waited.
+    QueryTrace other(2, "select 2");
+    other.add_span(QueryTrace::Send, 0, 100);
+    other.split_server_time(500);
+    $expect(other.spans[0].duration).toBe(0);
+    $expect(other.spans[1].duration).toBe(100);
+  });
+
+  $it("Keeps only the most recent traces", []() {
+    QueryTraceLog log(3);
+    for (int i = 0; i < 5; ++i) {
+      QueryTrace trace(log.next_id(), "select " + std::to_string(i));
+      trace.add_span(QueryTrace::Parse, i * 10, i * 10 + 5);
+      log.add(trace);
+    }
+
+    std::vector<QueryTrace> traces = log.traces();
+    $expect(traces).toHaveSize(3);
+    $expect(traces.front().id).toBe(3U);
+    $expect(traces.back().statement).toBe("select 4");
+
+    log.clear();
+    $expect(log.traces()).toHaveSize(0);
+  });
+
+  $it("Exports Chrome trace JSON", []() {
+    QueryTrace trace(7, "select \"a\"\nfrom t");
+    trace.add_span(QueryTrace::Parse, 10, 25);
+    trace.add_mark(QueryTrace::FirstRow, 30);
+
+    std::string json = QueryTraceLog::to_chrome_trace({ trace });
+    $expect(json).toStartWith("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    $expect(json).toContain(
+      "\"name\": \"Parse\", \"cat\": \"sql\", \"ph\": \"X\", \"pid\": 1, \"tid\": 7, \"ts\": 10, \"dur\": 15");
+    $expect(json).toContain("\"name\": \"First Row\", \"cat\": \"sql\", \"ph\": \"i\"");
+    $expect(json).toContain("select \\\"a\\\"\\nfrom t");
+  });
+}
+
+}
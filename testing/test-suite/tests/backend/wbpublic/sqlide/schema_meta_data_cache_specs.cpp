@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "base/file_utilities.h"
+#include "sqlide/schema_meta_data_cache.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::string cacheDir = casmine::CasmineContext::get()->outputDir();
+};
+
+$describe("Schema meta data cache") {
+  $beforeAll([this]() {
+    base::remove(base::makePath(data->cacheDir, "meta_test.schema_meta"));
+  });
+
+  $it("Stores and returns schema content", [this]() {
+    SchemaMetaDataCache cache("meta_test", data->cacheDir);
+    $expect(cache.get_schemas().empty()).toBeTrue();
+
+    SchemaMetaDataCache::ObjectList objects;
+    objects.push_back({ "actor", SchemaMetaDataCache::Table, "2019-01-01 10:00:00", { "actor_id", "first_name" } });
+    objects.push_back({ "actor_info", SchemaMetaDataCache::View, "abcdef", { "actor_id" } });
+    objects.push_back({ "film_in_stock", SchemaMetaDataCache::Procedure, "", {} });
+    cache.store_schema_objects("sakila", objects);
+
+    $expect(cache.get_schemas()).toEqual(std::vector<std::string>({ "sakila" }));
+
+    SchemaMetaDataCache::ObjectList stored = cache.get_schema_objects("sakila");
+    $expect(stored).toHaveSize(3);
+    $expect(stored.front().name).toBe("actor");
+    $expect(stored.front().stamp).toBe("2019-01-01 10:00:00");
+    $expect(stored.front().columns).toEqual(std::vector<std::string>({ "actor_id", "first_name" }));
+    $expect(static_cast<int>(stored.back().type)).toBe(static_cast<int>(SchemaMetaDataCache::Procedure));
+    $expect(stored.back().columns.empty()).toBeTrue();
+  });
+
+  $it("Survives reopening and drops removed schemas", [this]() {
+    SchemaMetaDataCache cache("meta_test", data->cacheDir);
+    $expect(cache.get_schema_objects("sakila")).toHaveSize(3);
+
+    cache.store_schema_objects("world", { { "city", SchemaMetaDataCache::Table, "", { "ID" } } });
+    cache.update_schema_list({ "world" });
+
+    $expect(cache.get_schemas()).toEqual(std::vector<std::string>({ "world" }));
+    $expect(cache.get_schema_objects("sakila").empty()).toBeTrue();
+    $expect(cache.get_schema_objects("world")).toHaveSize(1);
+  });
+}
+
+}
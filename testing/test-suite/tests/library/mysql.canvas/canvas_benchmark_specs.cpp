@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+// Headless performance benchmark for the canvas library. Builds a synthetic physical diagram through the
+// wbcanvas bridges, renders it with the offscreen image canvas view and reports the timings as JSON.
+//
+// The benchmark is opt-in, since it takes a while and its numbers are only meaningful when compared between builds
+// on the same machine. Enable it in the test configuration file, e.g.:
+//
+//   "canvasBenchmark": { "output": "/tmp/canvas.json", "tables": 500, "connections": 600, "layers": 4 }
+//
+// and run it with `wbtests-bin --only canvas_benchmark_specs`. Use "-" as output to print the results to stdout.
+
+#include "base/file_utilities.h"
+#include "base/string_utilities.h"
+
+#include "mdc_canvas_view.h"
+#include "mdc_line.h"
+
+#include "wbcanvas/model_connection_impl.h"
+#include "wbcanvas/model_diagram_impl.h"
+
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace {
+
+$ModuleEnvironment() {};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const double GridWidth = 250;
+static const double GridHeight = 200;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Runs the given function the given number of times and returns the median run time in milliseconds.
+ */
+static double measure(int iterations, const std::function<void()> &func) {
+  std::vector<double> times;
+  for (int i = 0; i < std::max(iterations, 1); ++i) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  std::sort(times.begin(), times.end());
+  return times[times.size() / 2];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+  std::string outputDir = casmine::CasmineContext::get()->outputDir();
+
+  std::string output;
+  int tableCount = 0;
+  int connectionCount = 0;
+  int layerCount = 0;
+  int iterations = 0;
+
+  workbench_physical_DiagramRef diagram;
+  mdc::CanvasView *view = nullptr;
+
+  // Results in milliseconds, in the order the measurements were taken.
+  std::vector<std::pair<std::string, double>> results;
+
+  void checkEnabled() {
+    if (!tester)
+      $pending("set canvasBenchmark/output in the test configuration to run the canvas benchmark");
+  }
+
+  void addResult(const std::string &name, double value) {
+    results.push_back({ name, value });
+    if (casmine::CasmineContext::get()->getConfigurationBoolValue("verbose"))
+      std::cout << "    " << name << ": " << value << " ms" << std::endl;
+  }
+
+  std::vector<mdc::Line *> lines() {
+    std::vector<mdc::Line *> result;
+    for (size_t i = 0; i < diagram->connections().count(); ++i) {
+      mdc::Line *line = dynamic_cast<mdc::Line *>(diagram->connections()[i]->get_data()->get_canvas_item());
+      if (line != nullptr)
+        result.push_back(line);
+    }
+    return result;
+  }
+
+  void createDiagram() {
+    db_SchemaRef schema = tester->getSchema();
+    std::mt19937 random(4711);
+
+    int columns = std::max(1, (int)std::ceil(std::sqrt((double)tableCount)));
+    int rows = (tableCount + columns - 1) / columns;
+    diagram->width(columns * GridWidth + 100);
+    diagram->height(rows * GridHeight + 100);
+
+    // Layers are vertical stripes over the table grid, so that tables placed afterwards end up inside them.
+    if (layerCount > 0) {
+      double stripe = std::ceil((double)columns / layerCount) * GridWidth;
+      for (int i = 0; i < layerCount; ++i)
+        diagram->placeNewLayer(20 + i * stripe, 20, stripe - 10, rows * GridHeight + 40,
+                               "layer" + std::to_string(i));
+    }
+
+    std::vector<db_mysql_TableRef> tables;
+    for (int i = 0; i < tableCount; ++i) {
+      db_mysql_TableRef table(grt::Initialized);
+      table->owner(schema);
+      table->name("table" + std::to_string(i));
+
+      for (int j = 0; j < 5; ++j) {
+        db_mysql_ColumnRef column(grt::Initialized);
+        column->owner(table);
+        column->name(j == 0 ? "id" : "column" + std::to_string(j));
+        column->setParseType(j == 0 ? "INT" : "VARCHAR(45)", tester->getCatalog()->simpleDatatypes());
+        table->columns().insert(column);
+        if (j == 0)
+          table->addPrimaryKeyColumn(column);
+      }
+      schema->tables().insert(table);
+      tables.push_back(table);
+    }
+
+    // Foreign keys mostly point to tables close by, with a few long range references, like in real models.
+    if (tableCount > 1) {
+      for (int i = 0; i < connectionCount; ++i) {
+        size_t source = i % tables.size();
+        size_t target;
+        if (random() % 4 == 0)
+          target = random() % tables.size();
+        else
+          target = (source + 1 + random() % (columns + 1)) % tables.size();
+        if (target == source)
+          target = (source + 1) % tables.size();
+
+        db_mysql_TableRef table = tables[source];
+        db_mysql_ColumnRef column(grt::Initialized);
+        column->owner(table);
+        column->name("fk" + std::to_string(i));
+        column->setParseType("INT", tester->getCatalog()->simpleDatatypes());
+        table->columns().insert(column);
+
+        db_mysql_ForeignKeyRef fk(grt::Initialized);
+        fk->owner(table);
+        fk->name("fk" + std::to_string(i));
+        fk->columns().insert(column);
+        fk->referencedColumns().insert(tables[target]->columns()[0]);
+        fk->referencedTable(tables[target]);
+        table->foreignKeys().insert(fk);
+      }
+    }
+
+    // Placing a table creates the connections to all tables which are already on the diagram.
+    for (int i = 0; i < tableCount; ++i)
+      diagram->placeTable(tables[i], 40 + (i % columns) * GridWidth, 60 + (i / columns) * GridHeight);
+  }
+
+  void writeResults() {
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+
+    writer.StartObject();
+    writer.Key("parameters");
+    writer.StartObject();
+    writer.Key("tables");
+    writer.Int(tableCount);
+    writer.Key("connections");
+    writer.Int((int)diagram->connections().count());
+    writer.Key("layers");
+    writer.Int(layerCount);
+    writer.Key("iterations");
+    writer.Int(iterations);
+    writer.EndObject();
+
+    writer.Key("results");
+    writer.StartObject();
+    for (auto &result : results) {
+      writer.Key(result.first.c_str());
+      writer.Double(result.second);
+    }
+    writer.EndObject();
+    writer.EndObject();
+
+    if (output == "-")
+      std::cout << buffer.GetString() << std::endl;
+    else
+      base::setTextFileContent(output, buffer.GetString());
+  }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+$describe("Canvas benchmark") {
+  $beforeAll([this]() {
+    casmine::CasmineContext *context = casmine::CasmineContext::get();
+    data->output = context->getConfigurationStringValue("canvasBenchmark/output");
+    if (data->output.empty())
+      return;
+
+    data->tableCount = context->getConfigurationIntValue("canvasBenchmark/tables", 200);
+    data->connectionCount = context->getConfigurationIntValue("canvasBenchmark/connections", 250);
+    data->layerCount = context->getConfigurationIntValue("canvasBenchmark/layers", 2);
+    data->iterations = context->getConfigurationIntValue("canvasBenchmark/iterations", 5);
+
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+    data->tester->wb->new_document();
+    data->tester->addView();
+
+    data->diagram = data->tester->getPview();
+    data->view = data->diagram->get_data()->get_canvas_view();
+
+    auto start = std::chrono::steady_clock::now();
+    grt::GRT::get()->get_undo_manager()->disable();
+    data->createDiagram();
+    grt::GRT::get()->get_undo_manager()->enable();
+    data->tester->syncView();
+    data->addResult("create diagram",
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+  });
+
+  $afterAll([this]() {
+    if (!data->tester)
+      return;
+
+    data->writeResults();
+
+    data->diagram = workbench_physical_DiagramRef();
+    data->tester->closeDocument();
+    data->tester->wb->close_document_finish();
+    data->tester.reset();
+  });
+
+  $it("Full repaint", [this]() {
+    data->checkEnabled();
+
+    data->addResult("full repaint", measure(data->iterations, [this]() {
+      data->view->invalidate_tiles();
+      data->view->repaint();
+    }));
+    data->addResult("cached repaint", measure(data->iterations, [this]() { data->view->repaint(); }));
+  });
+
+  $it("Incremental repaint after moving a figure", [this]() {
+    data->checkEnabled();
+    $expect(data->diagram->figures().count()).toBeGreaterThan(0U);
+
+    model_FigureRef figure(data->diagram->figures()[0]);
+    double offset = 20;
+    data->view->repaint();
+    data->addResult("move figure and repaint", measure(data->iterations, [&]() {
+      figure->left(*figure->left() + offset);
+      offset = -offset;
+      data->tester->syncView();
+      data->view->repaint();
+    }));
+  });
+
+  $it("Hit testing", [this]() {
+    data->checkEnabled();
+
+    base::Rect bounds = data->view->get_content_bounds();
+    std::mt19937 random(4711);
+    std::uniform_real_distribution<double> x(bounds.left(), bounds.right());
+    std::uniform_real_distribution<double> y(bounds.top(), bounds.bottom());
+    std::vector<base::Point> points;
+    for (int i = 0; i < 10000; ++i)
+      points.push_back(base::Point(x(random), y(random)));
+
+    data->addResult("hit test 10000 points", measure(data->iterations, [&]() {
+      for (auto &point : points)
+        data->view->get_leaf_item_at(point);
+    }));
+  });
+
+  $it("Line hop updates", [this]() {
+    data->checkEnabled();
+
+    std::vector<mdc::Line *> lines = data->lines();
+    data->view->set_draws_line_hops(true);
+    data->addResult("line hop update", measure(data->iterations, [&]() {
+      for (auto line : lines)
+        data->view->update_line_crossings(line);
+      data->view->flush_line_crossings();
+    }));
+  });
+
+  $it("PNG export", [this]() {
+    data->checkEnabled();
+
+    std::string path = data->outputDir + "/canvas_benchmark.png";
+    data->addResult("png export", measure(data->iterations, [&]() { data->view->export_png(path); }));
+    $expect(base::file_exists(path)).toBeTrue();
+  });
+
+  $it("Autolayout", [this]() {
+    data->checkEnabled();
+
+    grt::Module *module = grt::GRT::get()->get_module("WbModel");
+    $expect(module).Not.toBeNull();
+
+    // Autolayout moves everything, so it runs only once and last.
+    grt::BaseListRef args(true);
+    args.ginsert(data->diagram);
+    data->addResult("autolayout", measure(1, [&]() {
+      module->call_function("autolayout", args);
+      data->tester->syncView();
+    }));
+    data->addResult("repaint after autolayout", measure(1, [this]() {
+      data->view->invalidate_tiles();
+      data->view->repaint();
+    }));
+  });
+}
+
+}
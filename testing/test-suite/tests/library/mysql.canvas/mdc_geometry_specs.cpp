@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "mdc_algorithms.h"
+#include "mdc_damage_region.h"
+#include "mdc_rtree.h"
+#include "mdc_tile_cache.h"
+
+#include "casmine.h"
+
+using namespace mdc;
+using namespace base;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$describe("Canvas geometry") {
+  $it("Merges overlapping damage", []() {
+    DamageRegion region;
+    $expect(region.empty()).toBeTrue();
+
+    region.add(Rect(0, 0, 100, 100));
+    region.add(Rect(10, 10, 20, 20)); // Contained.
+    $expect(region.rects()).toHaveSize(1);
+
+    region.add(Rect(50, 0, 100, 100)); // Overlaps a lot, merging wastes no space.
+    $expect(region.rects()).toHaveSize(1);
+    $expect(region.bounds().width()).toBe(150.0);
+
+    region.add(Rect(500, 500, 10, 10)); // Far away, kept separate.
+    $expect(region.rects()).toHaveSize(2);
+    $expect(region.intersects(Rect(505, 505, 1, 1))).toBeTrue();
+    $expect(region.intersects(Rect(300, 300, 10, 10))).toBeFalse();
+
+    region.add(Rect()); // Empty rects are ignored.
+    $expect(region.rects()).toHaveSize(2);
+
+    region.clear();
+    $expect(region.empty()).toBeTrue();
+  });
+
+  $it("Limits the number of damage rects", []() {
+    DamageRegion region(4);
+    for (int i = 0; i < 10; ++i)
+      region.add(Rect(i * 100, 0, 10, 10));
+    $expect(region.rects()).toHaveSize(4);
+    $expect(region.bounds().left()).toBe(0.0);
+    $expect(region.bounds().right()).toBe(910.0);
+  });
+
+  $it("Handles full repaints", []() {
+    DamageRegion region;
+    region.add(Rect(0, 0, 10, 10));
+    region.add_all();
+    $expect(region.is_all()).toBeTrue();
+    $expect(region.rects()).toHaveSize(0);
+    $expect(region.intersects(Rect(1000, 1000, 1, 1))).toBeTrue();
+
+    region.add(Rect(0, 0, 10, 10)); // Nothing to add, everything is damaged already.
+    $expect(region.rects()).toHaveSize(0);
+  });
+
+  $it("Checks coverage by the damage rects, not their bounds", []() {
+    DamageRegion region;
+    $expect(region.contains(Rect(0, 0, 1, 1))).toBeFalse();
+
+    region.add(Rect(0, 0, 10, 10));
+    region.add(Rect(500, 500, 10, 10));
+    $expect(region.rects()).toHaveSize(2);
+    $expect(region.contains(Rect(2, 2, 5, 5))).toBeTrue();
+    $expect(region.contains(Rect(502, 502, 5, 5))).toBeTrue();
+    $expect(region.contains(region.bounds())).toBeFalse(); // The gap between both isn't damaged.
+
+    $expect(region.contains(Rect(-1, -1, 12, 12))).toBeFalse();
+    $expect(region.contains(Rect(-1, -1, 12, 12), 2)).toBeTrue();
+
+    region.add_all();
+    $expect(region.contains(Rect(200, 200, 10, 10))).toBeTrue();
+  });
+
+  $it("Finds items by area in an R-tree", []() {
+    RTree<int> tree;
+    for (int i = 0; i < 1000; ++i)
+      tree.insert(i, Rect((i % 50) * 100, (i / 50) * 100, 80, 60));
+    $expect(tree.size()).toBe(1000U);
+
+    std::vector<int> found = tree.query(Rect(105, 105, 10, 10));
+    $expect(found).toHaveSize(1);
+    $expect(found[0]).toBe(51);
+
+    // Borders count as intersection, like bounds_intersect() does.
+    found = tree.query(Rect(180, 160, 20, 40));
+    $expect(found).toHaveSize(4);
+
+    $expect(tree.query(Rect(85, 65, 10, 30))).toHaveSize(0);
+    $expect(tree.query(Rect(0, 0, 4900, 90))).toHaveSize(50);
+    $expect(tree.bounds() == Rect(0, 0, 4980, 1960)).toBeTrue();
+  });
+
+  $it("Keeps an R-tree up to date when values move or are removed", []() {
+    RTree<int> tree;
+    for (int i = 0; i < 500; ++i)
+      tree.insert(i, Rect(i * 10, 0, 5, 5));
+
+    // Inserting again moves the value.
+    tree.insert(7, Rect(10000, 10000, 5, 5));
+    $expect(tree.size()).toBe(500U);
+    $expect(tree.query(Rect(70, 0, 5, 5))).toHaveSize(0);
+    $expect(tree.query(Rect(10001, 10001, 1, 1))).toHaveSize(1);
+
+    for (int i = 0; i < 500; i += 2)
+      $expect(tree.remove(i)).toBeTrue();
+    $expect(tree.remove(0)).toBeFalse();
+    $expect(tree.size()).toBe(250U);
+    $expect(tree.query(Rect(0, 0, 5000, 5))).toHaveSize(249);
+    $expect(tree.contains(7)).toBeTrue();
+
+    tree.clear();
+    $expect(tree.empty()).toBeTrue();
+    $expect(tree.query(Rect(0, 0, 20000, 20000))).toHaveSize(0);
+  });
+
+  $it("Finds crossings of orthogonal segments", []() {
+    std::vector<HVSegment> segments;
+    segments.push_back(HVSegment(Point(0, 50), Point(100, 50), 0, true));  // Horizontal.
+    segments.push_back(HVSegment(Point(50, 0), Point(50, 100), 1, false)); // Crosses the first one.
+    segments.push_back(HVSegment(Point(100, 0), Point(100, 50), 2, false)); // Touches its end.
+    segments.push_back(HVSegment(Point(20, 0), Point(20, 100), 0, false));  // Same owner.
+    segments.push_back(HVSegment(Point(70, 60), Point(70, 100), 3, false)); // Too short.
+    segments.push_back(HVSegment(Point(0, 80), Point(100, 80), 4, false));  // Only unchanged crossings.
+    segments.push_back(HVSegment(Point(0, 0), Point(30, 30), 5, true));     // Diagonal, ignored.
+
+    std::vector<HVCrossing> crossings = find_hv_crossings(segments);
+    $expect(crossings).toHaveSize(2);
+    $expect(crossings[0].horizontal).toBe(0U);
+    $expect(crossings[0].vertical).toBe(1U);
+    $expect(crossings[0].point == Point(50, 50)).toBeTrue();
+    $expect(crossings[1].vertical).toBe(2U);
+    $expect(crossings[1].point == Point(100, 50)).toBeTrue();
+
+    segments[5].changed = true;
+    $expect(find_hv_crossings(segments)).toHaveSize(5);
+  });
+
+  $it("Keeps rendered tiles within its memory limit", []() {
+    int tracked = 0;
+    size_t tile_memory = TileCache::TileSize * TileCache::TileSize * 4;
+    TileCache cache(3 * tile_memory, [&tracked](int amount) { tracked += amount; });
+
+    for (int x = 0; x < 3; ++x)
+      cache.add(1.0, x, 0, cairo_image_surface_create(CAIRO_FORMAT_ARGB32, TileCache::TileSize, TileCache::TileSize));
+    $expect(cache.count()).toBe(3U);
+    $expect((size_t)tracked).toBe(cache.get_memory());
+
+    // Using the first tile makes the second one the least recently used.
+    $expect(cache.get(1.0, 0, 0) != nullptr).toBeTrue();
+    cache.add(2.0, 0, 0, cairo_image_surface_create(CAIRO_FORMAT_ARGB32, TileCache::TileSize, TileCache::TileSize));
+    $expect(cache.count()).toBe(3U);
+    $expect(cache.get(1.0, 1, 0) == nullptr).toBeTrue();
+    $expect(cache.get(1.0, 0, 0) != nullptr).toBeTrue();
+
+    // Invalidation hits tiles of all zoom levels covering the area.
+    cache.invalidate(Rect(10, 10, 20, 20));
+    $expect(cache.count()).toBe(1U);
+    $expect(cache.get(1.0, 2, 0) != nullptr).toBeTrue();
+
+    cache.set_max_memory(0);
+    $expect(cache.count()).toBe(0U);
+    $expect(tracked).toBe(0);
+  });
+}
+
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "mdc_common.h"
+
+#include "casmine.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace mdc;
+using namespace base;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  cairo_scaled_font_t *font = nullptr;
+  FontSpec spec = FontSpec("Helvetica", SNormal, WNormal, 12);
+};
+
+$describe("Text layout cache") {
+  $beforeAll([this]() {
+    cairo_font_face_t *face = cairo_toy_font_face_create("Helvetica", CAIRO_FONT_SLANT_NORMAL,
+                                                         CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_matrix_t font_matrix;
+    cairo_matrix_t ctm;
+    cairo_matrix_init_scale(&font_matrix, 12, 12);
+    cairo_matrix_init_identity(&ctm);
+    cairo_font_options_t *options = cairo_font_options_create();
+    data->font = cairo_scaled_font_create(face, &font_matrix, &ctm, options);
+    cairo_font_options_destroy(options);
+    cairo_font_face_destroy(face);
+  });
+
+  $afterAll([this]() {
+    cairo_scaled_font_destroy(data->font);
+  });
+
+  $it("Counts hits and misses", [this]() {
+    TextLayoutCache cache(10);
+
+    TextLayoutCache::LayoutRef first = cache.lookup(data->font, data->spec, "customer");
+    $expect(cache.misses()).toBe(1U);
+    $expect(cache.hits()).toBe(0U);
+    $expect(first->glyphs).toHaveSize(8);
+
+    TextLayoutCache::LayoutRef second = cache.lookup(data->font, data->spec, "customer");
+    $expect(cache.hits()).toBe(1U);
+    $expect(second.get() == first.get()).toBeTrue("a hit must return the cached layout");
+
+    cache.lookup(data->font, FontSpec("Helvetica", SNormal, WBold, 12), "customer");
+    $expect(cache.misses()).toBe(2U);
+    $expect(cache.count()).toBe(2U);
+  });
+
+  $it("Evicts the least recently used entries", [this]() {
+    TextLayoutCache cache(2);
+    std::string fitted;
+
+    cache.add_fitted(data->spec, "first", 20, "f…");
+    cache.add_fitted(data->spec, "second", 20, "s…");
+    $expect(cache.lookup_fitted(data->spec, "first", 20, fitted)).toBeTrue();
+    $expect(fitted).toBe("f…");
+
+    // "second" is now the least recently used entry.
+    cache.add_fitted(data->spec, "third", 20, "t…");
+    $expect(cache.count()).toBe(2U);
+    $expect(cache.lookup_fitted(data->spec, "second", 20, fitted)).toBeFalse();
+    $expect(cache.lookup_fitted(data->spec, "first", 20, fitted)).toBeTrue();
+    $expect(cache.lookup_fitted(data->spec, "third", 20, fitted)).toBeTrue();
+    $expect(cache.lookup_fitted(data->spec, "first", 30, fitted)).toBeFalse();
+
+    cache.set_max_entries(1);
+    $expect(cache.count()).toBe(1U);
+    $expect(cache.lookup_fitted(data->spec, "third", 20, fitted)).toBeTrue();
+  });
+
+  $it("Keeps returned layouts valid after eviction", [this]() {
+    TextLayoutCache cache(1);
+
+    TextLayoutCache::LayoutRef layout = cache.lookup(data->font, data->spec, "orders");
+    double advance = layout->extents.x_advance;
+    cache.lookup(data->font, data->spec, "order_items");
+    cache.clear();
+
+    $expect(layout->glyphs).toHaveSize(6);
+    $expect(layout->extents.x_advance).toBe(advance);
+  });
+
+  $it("Can be used from several threads", [this]() {
+    TextLayoutCache cache(50);
+    std::atomic<int> mismatches(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([this, &cache, &mismatches]() {
+        for (int i = 0; i < 1000; ++i) {
+          std::string text = "column_" + std::to_string(i % 100);
+          TextLayoutCache::LayoutRef layout = cache.lookup(data->font, data->spec, text);
+          if (layout->glyphs.size() != text.size())
+            ++mismatches;
+        }
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+
+    $expect(mismatches.load()).toBe(0);
+    $expect(cache.count()).toBe(50U);
+    $expect(cache.hits() + cache.misses()).toBe(4000U);
+  });
+}
+
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2023, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+  workbench_physical_DiagramRef diagram;
+
+  std::vector<db_mysql_TableRef> createTables(size_t count) {
+    db_SchemaRef schema = tester->getSchema();
+    std::vector<db_mysql_TableRef> tables;
+    for (size_t i = 0; i < count; ++i) {
+      db_mysql_TableRef table(grt::Initialized);
+      table->owner(schema);
+      table->name("layout_table" + std::to_string(schema->tables().count()));
+
+      db_mysql_ColumnRef column(grt::Initialized);
+      column->owner(table);
+      column->name("id");
+      column->setParseType("INT", tester->getCatalog()->simpleDatatypes());
+      table->columns().insert(column);
+      table->addPrimaryKeyColumn(column);
+
+      schema->tables().insert(table);
+      tables.push_back(table);
+    }
+    return tables;
+  }
+
+  void autolayout() {
+    grt::Module *module = grt::GRT::get()->get_module("WbModel");
+    $expect(module).Not.toBeNull();
+
+    grt::BaseListRef args(true);
+    args.ginsert(diagram);
+    module->call_function("autolayout", args);
+    tester->syncView();
+  }
+
+  // Checks that all figures of the layer lie completely inside of it and don't overlap each other.
+  void expectSpreadInside(const model_LayerRef &layer) {
+    grt::ListRef<model_Figure> figures = layer->figures();
+    for (size_t i = 0; i < figures.count(); ++i) {
+      model_FigureRef figure = figures[i];
+      $expect(*figure->left()).toBeGreaterThanOrEqual(0.0, *figure->name());
+      $expect(*figure->top()).toBeGreaterThanOrEqual(0.0, *figure->name());
+      $expect(*figure->left() + *figure->width()).toBeLessThanOrEqual(*layer->width(), *figure->name());
+      $expect(*figure->top() + *figure->height()).toBeLessThanOrEqual(*layer->height(), *figure->name());
+
+      for (size_t j = i + 1; j < figures.count(); ++j) {
+        model_FigureRef other = figures[j];
+        bool separate = *figure->left() + *figure->width() <= *other->left() ||
+                        *other->left() + *other->width() <= *figure->left() ||
+                        *figure->top() + *figure->height() <= *other->top() ||
+                        *other->top() + *other->height() <= *figure->top();
+        $expect(separate).toBeTrue(*figure->name() + " overlaps " + *other->name());
+      }
+    }
+  }
+};
+
+$describe("Model autolayout") {
+  $beforeAll([this]() {
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+    data->tester->wb->new_document();
+    data->tester->addView();
+    data->diagram = data->tester->getPview();
+  });
+
+  $afterAll([this]() {
+    data->diagram = workbench_physical_DiagramRef();
+    data->tester->closeDocument();
+    data->tester->wb->close_document_finish();
+    data->tester.reset();
+  });
+
+  $it("Spreads stacked figures over a wide, low diagram", [this]() {
+    // A square start grid would not fit into the height of this diagram and figures would pile up at its bottom.
+    data->diagram->setPageCounts(8, 1);
+    data->tester->syncView();
+
+    std::vector<db_mysql_TableRef> tables = data->createTables(40);
+    for (auto &table : tables)
+      data->diagram->placeTable(table, 50, 50);
+    data->tester->syncView();
+
+    data->autolayout();
+    data->expectSpreadInside(data->diagram->rootLayer());
+  });
+
+  $it("Keeps figures inside their layer", [this]() {
+    data->diagram->setPageCounts(8, 3);
+    data->tester->syncView();
+
+    model_LayerRef layer = data->diagram->placeNewLayer(100, 800, 1200, 700, "autolayout layer");
+    std::vector<db_mysql_TableRef> tables = data->createTables(12);
+    for (auto &table : tables)
+      data->diagram->placeTable(table, 150, 850);
+    data->tester->syncView();
+    $expect(layer->figures().count()).toEqual(12U);
+
+    data->autolayout();
+    data->expectSpreadInside(layer);
+    data->expectSpreadInside(data->diagram->rootLayer());
+  });
+
+  $it("Can be undone in one step", [this]() {
+    grt::ListRef<model_Figure> figures = data->diagram->rootLayer()->figures();
+    $expect(figures.count()).toBeGreaterThan(0U);
+
+    // Move everything onto one spot, so that autolayout has to move all figures.
+    for (size_t i = 0; i < figures.count(); ++i) {
+      figures[i]->left(10);
+      figures[i]->top(10);
+    }
+    data->tester->syncView();
+
+    data->autolayout();
+    $expect(*figures[1]->left() != 10 || *figures[1]->top() != 10).toBeTrue();
+
+    grt::GRT::get()->get_undo_manager()->undo();
+    data->tester->syncView();
+    for (size_t i = 0; i < figures.count(); ++i) {
+      $expect(*figures[i]->left()).toEqual(10.0);
+      $expect(*figures[i]->top()).toEqual(10.0);
+    }
+  });
+}
+
+}